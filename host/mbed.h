@@ -0,0 +1,53 @@
+#ifndef HOST_MBED_H
+#define HOST_MBED_H
+
+// 主机构建 (PlatformIO native 环境) 用的 mbed.h 替身
+// DSP 核心 (lib/dsp_core) 不依赖 mbed; 这里只提供自测程序 main_test.cpp 用到的板级接口
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#define LED1 0
+
+// LED: 主机上只保存状态
+class DigitalOut {
+private:
+    int value;
+
+public:
+    explicit DigitalOut(int pin) : value(0) {}
+
+    DigitalOut& operator=(int state) {
+        value = state;
+        return *this;
+    }
+
+    operator int() const {
+        return value;
+    }
+};
+
+// 计时器: 主机上用单调时钟
+class Timer {
+private:
+    std::chrono::steady_clock::time_point startTime;
+
+public:
+    Timer() : startTime(std::chrono::steady_clock::now()) {}
+
+    void start() {
+        startTime = std::chrono::steady_clock::now();
+    }
+
+    std::chrono::microseconds elapsed_time() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+    }
+};
+
+// 板上的等待只为串口输出留出时间，主机上不需要
+inline void thread_sleep_for(uint32_t millisec) {
+}
+
+#endif
@@ -5,30 +5,72 @@
 #include "ble/BLE.h"
 #include "ble/Gap.h"
 #include "detector.h"
+#include "detection_frame.h"
+#include "publish_policy.h"
+#include "raw_stream.h"
+#include "event_log.h"
+#include "stage_timing.h"
 
 // 使用 16-bit UUID 整数定义
 const uint16_t PD_SERVICE_UUID = 0xA000;
-const uint16_t TREMOR_CHAR_UUID = 0xA001;
-const uint16_t DYSKINESIA_CHAR_UUID = 0xA002;
-const uint16_t FOG_CHAR_UUID = 0xA003;
+const uint16_t DETECTION_FRAME_CHAR_UUID = 0xA004;   // 批量检测帧 (格式见 detection_frame.h)
+const uint16_t RAW_STREAM_CHAR_UUID = 0xA005;        // 原始加速度流，订阅即开始 (格式见 raw_stream.h)
+const uint16_t EVENT_LOG_CHAR_UUID = 0xA006;         // 事件日志下载: 写入 u32 起始序号，通知直到空块 (格式见 event_log.h)
+const uint16_t DIAGNOSTICS_CHAR_UUID = 0xA007;       // 阶段计时统计，只读 (格式见 stage_timing.h，STAGE_TIMING_ENABLED 时存在)
 
-class BLEService : public ble::Gap::EventHandler {
+// ATT MTU 范围 (通知负载 = MTU - 3)
+const uint16_t ATT_MTU_DEFAULT = 23;
+const uint16_t ATT_MTU_MAX = 247;
+
+class BLEService : public ble::Gap::EventHandler, public ble::GattServer::EventHandler {
 private:
     BLE &_ble;
     events::EventQueue &_event_queue;
     Thread _event_thread;
     
-    bool _connected;
+    volatile bool _connected;
+    
+    // 检测结果由分析线程投递到 BLE 事件线程写入，排队数有上限
+    volatile int32_t _pendingUpdates;
+    uint32_t _droppedUpdates;
     
     // 特征值句柄
-    GattCharacteristic *_tremorChar;
-    GattCharacteristic *_dyskinesiaChar;
-    GattCharacteristic *_fogChar;
+    GattCharacteristic *_frameChar;
+    
+    // 检测帧: 发布策略筛选后入队，速率限制内到达的记录合并为一次通知 (不超过 MTU)
+    PublishPolicy _policy;
+    DetectionFrameQueue _frames;
+    LowPowerTimer _clock;           // 速率限制用的单调时钟，不阻止 Stop 模式
+    volatile bool _flushScheduled;
+    uint8_t _frameValue[ATT_MTU_MAX - 3];
+    uint16_t _attMtu;
+    uint32_t _notifications;
     
-    // 数据缓冲区
-    uint8_t _tremorValue[8];      // detected(1) + intensity(4)
-    uint8_t _dyskinesiaValue[8];  // detected(1) + intensity(4)
-    uint8_t _fogValue[8];         // detected(1) + state(1)
+    // 原始数据流: 采集线程压缩入队，BLE 线程发送; 协议栈缓冲区满时保留包等待 onDataSent
+    GattCharacteristic *_rawChar;
+    uint8_t _rawValue[rawstream::MAX_PACKET_SIZE];
+    RawStreamer *_rawStream;
+    volatile bool _rawFlushPending;
+    uint32_t _rawPacketsSent;
+    uint32_t _rawBackpressure;     // 协议栈拒绝写入 (链路跟不上) 的次数
+    
+    // 事件日志: 发布的记录入队，由低优先级写线程写入 flash (扇区擦除不阻塞 BLE 事件线程);
+    // 下载时连续通知直到协议栈缓冲区满，onDataSent 时继续; 写线程持有日志锁时稍后重试
+    GattCharacteristic *_logChar;
+    uint8_t _logValue[eventlog::MAX_CHUNK_SIZE];
+    EventLog *_eventLog;
+    EventLogQueue *_eventLogQueue;
+    Mutex *_eventLogLock;
+    bool _downloading;
+    bool _downloadRetryScheduled;
+    uint32_t _downloadCursor;       // 下一块的起始序号
+    uint32_t _logChunksSent;
+    
+#if STAGE_TIMING_ENABLED
+    // 诊断: 每次发布后刷新本地值 (不通知)，客户端按需读取
+    GattCharacteristic *_diagChar;
+    uint8_t _diagValue[timing::ENCODED_SIZE];
+#endif
     
     // 广播数据缓冲区
     uint8_t _adv_buffer[ble::LEGACY_ADVERTISING_MAX_SIZE];
@@ -36,19 +78,54 @@ private:
 
     void onInitComplete(BLE::InitializationCompleteCallbackContext *params);
     void scheduleBleEventsProcessing(BLE::OnEventsToProcessCallbackContext *context);
+    void processBleEvents();
     void startAdvertising();
+    void writeRecord(DetectionRecord record);
+    void publishRecord(const DetectionRecord &record);
+    void flushFrames();
+    void scheduleFlush(uint32_t delayMs);
+    void onFlushTimer();
+    void flushRawStream();
+    void flushDownload();
+    void onDownloadRetry();
+    static void onRawPacketReady(void *context);
+#if STAGE_TIMING_ENABLED
+    void refreshDiagnostics();
+#endif
 
     // Gap::EventHandler 回调重写
     virtual void onConnectionComplete(const ble::ConnectionCompleteEvent &event) override;
     virtual void onDisconnectionComplete(const ble::DisconnectionCompleteEvent &event) override;
     
+    // GattServer::EventHandler 回调重写
+    virtual void onAttMtuChange(ble::connection_handle_t connectionHandle, uint16_t attMtuSize) override;
+    virtual void onUpdatesEnabled(const GattUpdatesEnabledCallbackParams &params) override;
+    virtual void onUpdatesDisabled(const GattUpdatesDisabledCallbackParams &params) override;
+    virtual void onDataSent(const GattDataSentCallbackParams &params) override;
+    virtual void onDataWritten(const GattWriteCallbackParams &params) override;
+    
+    // Gap::EventHandler: 链路参数协商结果
+    virtual void onDataLengthChange(ble::connection_handle_t connectionHandle, uint16_t txSize, uint16_t rxSize) override;
+    virtual void onPhyUpdateComplete(ble_error_t status, ble::connection_handle_t connectionHandle,
+                                     ble::phy_t txPhy, ble::phy_t rxPhy) override;
+    
 public:
     BLEService();
     ~BLEService();
     
     void begin();
-    void updateData(DetectionResult result);
+    void attachRawStream(RawStreamer *streamer);   // 在 begin() 之前调用
+    // 在 begin() 之前调用，日志已挂载; 写线程从 queue 取出记录，持有 lock 时写入 log
+    void attachEventLog(EventLog *log, EventLogQueue *queue, Mutex *lock);
+    void updateData(DetectionResult result);  // 可在任意线程调用，实际写入在 BLE 事件线程
     bool isConnected();
+    uint32_t getDroppedUpdates();
+    uint32_t getNotifications();
+    uint32_t getSuppressedUpdates();   // 无变化未发布的结果数
+    uint32_t getDeferredNotifications();  // 因速率限制推迟的通知次数
+    uint32_t getRawPacketsSent();
+    uint32_t getRawBackpressure();
+    uint32_t getLogChunksSent();
 };
 
 #endif
@@ -0,0 +1,27 @@
+#ifndef BLOCK_DEVICE_FLASH_H
+#define BLOCK_DEVICE_FLASH_H
+
+#include "mbed.h"
+#include "BlockDevice.h"
+#include "flash_device.h"
+
+// FlashDevice 的板上实现: 包装 mbed BlockDevice (如 SlicingBlockDevice 划出的 QSPI 分区)
+// 编程和擦除期间持有深度睡眠锁 (QSPI 外设时钟在 Stop 模式下关闭)
+class BlockDeviceFlash : public FlashDevice {
+private:
+    mbed::BlockDevice& device;
+    bool initialized;
+
+public:
+    explicit BlockDeviceFlash(mbed::BlockDevice& blockDevice);
+    bool init();
+
+    virtual bool read(uint32_t addr, void* data, uint32_t size) override;
+    virtual bool program(uint32_t addr, const void* data, uint32_t size) override;
+    virtual bool erase(uint32_t addr, uint32_t size) override;
+    virtual uint32_t getProgramSize() override;
+    virtual uint32_t getEraseSize() override;
+    virtual uint32_t getSize() override;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef CAPTURE_LINK_H
+#define CAPTURE_LINK_H
+
+#include "mbed.h"
+#include "config.h"
+#include "detector.h"
+#include "detection_frame.h"
+#include "raw_stream.h"
+#include "uart_capture.h"
+
+// 有线采集链路 (格式见 uart_capture.h): 代替控制台串口 (UART_CAPTURE_ENABLED)，
+// 把每个原始样本、检测结果和控制台输出编码为 COBS 包，经发送环形缓冲区由异步串口发出。
+// 写入端从不等待串口: 编码在调用线程，临界区内只复制整包; 缓冲区满时丢弃整包并计数。
+// 发送完成中断接着发送缓冲区中的下一段，传输期间由 SerialBase 持有深度睡眠锁
+// 也是控制台 FileHandle: printf 和日志线程写入的字节作为 PACKET_CONSOLE 包发送
+class CaptureLink : private SerialBase, public FileHandle {
+private:
+    uint8_t txBuffer[CAPTURE_TX_BUFFER_SIZE];
+    volatile uint32_t txHead;           // 已写入的字节数 (生产者，临界区内)
+    volatile uint32_t txTail;           // 已发送的字节数 (发送完成中断)
+    volatile uint32_t txLength;         // 正在发送的字节数 (0 表示空闲)
+
+    // 采集线程私有: 当前样本包
+    RawStreamEncoder encoder;
+    uint8_t samplePayload[capture::MAX_PAYLOAD];
+    bool sampleOpen;
+    uint32_t samplePackets;
+
+    sessionfile::SessionInfo session;
+    bool sessionValid;
+
+    // 计数
+    uint32_t packetsSent;               // 写入发送缓冲区的包数
+    uint32_t packetsDropped;            // 缓冲区满而丢弃的包数
+    uint32_t bytesQueued;
+
+    bool enqueue(uint8_t type, const uint8_t* payload, int len);
+    void startTransmit();               // 临界区或发送完成中断中调用
+    void onTransmitDone(int event);
+
+public:
+    CaptureLink(PinName tx, PinName rx, int baud);
+
+    // 会话信息: 立即发送，之后每 SESSION_RESEND_PACKETS 个样本包重发一次
+    void setSession(const sessionfile::SessionInfo& info);
+
+    // 采集线程: 逐样本追加到当前样本包 (包满时发送)，flushSamples 发送未满的包
+    void pushSample(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex);
+    void flushSamples();
+
+    // 检测结果 (分析线程)
+    void sendDetection(const DetectionResult& result);
+
+    // FileHandle (控制台)
+    ssize_t write(const void* buffer, size_t size) override;
+    ssize_t read(void* buffer, size_t size) override;
+    off_t seek(off_t offset, int whence = SEEK_SET) override;
+    int close() override;
+    bool readable() const override;
+    int isatty() override;
+
+    uint32_t getPacketsSent();
+    uint32_t getPacketsDropped();
+    uint32_t getBytesQueued();
+};
+
+#endif
@@ -3,8 +3,70 @@
 
 // 采样配置
 #define SAMPLE_RATE 52              // 采样率 52Hz
-#define WINDOW_SIZE 128             // 2.46秒数据 (128样本, 必须是2的幂次方用于FFT)
-#define SAMPLE_PERIOD_MS 19         // 1000/52 ≈ 19ms
+#ifndef WINDOW_SIZE
+#define WINDOW_SIZE 128             // 2.46秒数据 (128样本, 必须是2的幂次方用于FFT); 基准测试构建可在命令行覆盖
+#endif
+#define FIFO_WATERMARK 26           // LSM6DSL FIFO 水位 (样本数)，约每 0.5 秒中断一次并突发读取
+#define HOP_SIZE 32                 // 滑动窗口步长 (样本数)，每 32 样本 (~0.6秒) 分析一次; 设为 WINDOW_SIZE 则无重叠
+#define WINDOW_QUEUE_SLOTS 3        // 采集与分析之间的窗口槽数 (分析占用一个，其余用于缓冲)
+
+#if (WINDOW_SIZE & (WINDOW_SIZE - 1)) != 0 || HOP_SIZE > WINDOW_SIZE
+#error "WINDOW_SIZE 必须是 2 的幂次方且不小于 HOP_SIZE"
+#endif
+
+// FFT 配置
+#define FFT_REAL_INPUT 1            // 1: 实数 FFT (N/2 点复数 FFT + 拆分), 0: N 点复数 FFT
+#define DSP_FIXED_POINT 0           // 1: Q15 定点流水线 (原始 LSB 输入, 块浮点 FFT), 0: 浮点流水线
+#define TRI_AXIAL_ANALYSIS 1        // 1: 三轴分别做频谱分析 (批处理 FFT)，取主轴峰值; 0: 只分析合成幅值 (需浮点流水线)
+#define DETECTOR_USE_BAND_TRACKER 0 // 1: 震颤/运动障碍使用逐样本滑动 DFT 频带估计, 0: 每个窗口做一次 FFT
+#define DETECTOR_WELCH_SEGMENTS 4   // Welch 平均: 最近 N 个窗口 (相邻窗口错开一个步长) 的功率谱取平均后找峰值; 1: 单窗口周期图
+#ifndef DETECTOR_VERBOSE
+#define DETECTOR_VERBOSE 1          // 1: 检测器逐窗口打印调试信息; 离线回放构建设为 0
+#endif
+
+// RTOS 线程 (栈大小按各线程的实际需要设定，字节)
+#define CAPTURE_THREAD_STACK_SIZE 1024      // 采集: 只做 FIFO 读取和窗口复制，不调用 printf
+#define ANALYSIS_THREAD_STACK_SIZE 3072     // 分析: 检测器 (FFT 缓冲区为成员); 日志只写令牌缓冲区，整数 printf 仅用于按需打印计时表
+#define LOG_THREAD_STACK_SIZE 768           // 日志: 低优先级，取出令牌编码为二进制帧写串口 (无格式化)
+#define BLE_THREAD_STACK_SIZE 4096          // BLE 事件: Cordio 主机栈回调
+#define RECORDER_THREAD_STACK_SIZE 1024     // 记录: 低优先级，只做 CRC 和 flash 编程/擦除
+#define EVENT_LOG_THREAD_STACK_SIZE 768     // 事件日志写入: 低优先级，flash 编程/擦除 (不阻塞 BLE 事件线程)
+#define BLE_RESULT_QUEUE_DEPTH 4            // 等待 BLE 线程写入的检测结果上限，满时丢弃
+#define BLE_PUBLISH_INTENSITY_DELTA 0.05f   // 强度变化超过此值 (m/s²) 才发布，标志翻转总是发布
+#define BLE_PUBLISH_HEARTBEAT_MS 10000      // 无变化时的最长发布间隔
+#define BLE_MIN_NOTIFY_INTERVAL_MS 1000     // 检测帧通知的最小间隔 (最大速率)，期间的记录排队 (只有强度变化的合并)，下次按 MTU 装满
+#define RAW_STREAM_PACKET_SLOTS 8           // 原始数据流: 等待 BLE 发送的压缩包数 (每包最多 244 字节)
+
+// 事件日志 (板载 QSPI NOR flash 开头的分区)
+#define EVENT_LOG_SIZE (256 * 1024)         // 64 个 4KB 扇区，每扇区 340 条记录，约 2.2 万条
+#define EVENT_LOG_QUEUE_SLOTS 16            // 等待写线程写入的记录数 (擦除扇区期间积压，发布速率约每秒 1 条)
+#define EVENT_LOG_RETRY_MS 20               // 写线程占用日志 (擦除扇区) 时，下载在 BLE 线程上延迟重试的间隔
+
+// 原始数据记录 (QSPI flash 中事件日志之后的全部空间，约 7.75 MB)
+#define RAW_RECORDER_ENABLED 0              // 1: 上电即开始一个新的记录会话，写满后停止
+#define RECORDER_BLOCK_SIZE 1024            // 记录块 (双缓冲各一块)，167 个样本约 3.2 秒; 须整除擦除扇区
+
+// 诊断: 流水线各阶段耗时 (串口命令 't' 打印、'z' 清零; BLE 诊断特征值)，发布版本设为 0 整体去除
+#ifndef STAGE_TIMING_ENABLED
+#define STAGE_TIMING_ENABLED 1
+#endif
+
+// 令牌化日志 (lib/tokenlog): 串口输出二进制帧，主机端用 logdecode 还原文本
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 0                         // 最低输出级别 (0 调试, 1 信息, 2 警告, 3 错误, 4 关闭)，更低的消息编译期去除
+#endif
+#define LOG_RING_ENTRIES 32                 // 等待输出的日志条目 (2 的幂次方，每条 40 字节)，满时丢弃并计数
+
+// 有线采集 (capture 环境): 控制台串口改为 COBS 二进制包，发送每个原始样本和检测结果，主机端 capture_rx 写入会话文件
+#ifndef UART_CAPTURE_ENABLED
+#define UART_CAPTURE_ENABLED 0
+#endif
+#define UART_CAPTURE_BAUD 921600            // ST-LINK 虚拟串口; 52Hz 约 250 字节/秒，远低于链路容量
+#define CAPTURE_TX_BUFFER_SIZE 4096         // 发送环形缓冲区 (2 的幂次方)，满时丢弃整包并计数
+
+#if (CAPTURE_TX_BUFFER_SIZE & (CAPTURE_TX_BUFFER_SIZE - 1)) != 0
+#error "CAPTURE_TX_BUFFER_SIZE 必须是 2 的幂次方"
+#endif
 
 // 频率范围定义
 #define TREMOR_FREQ_MIN 3.0f        // 震颤最低频率 3Hz
@@ -15,7 +77,7 @@
 // 检测阈值 (降低以提高灵敏度)
 #define TREMOR_THRESHOLD 0.05f      // 震颤幅值阈值 (降低)
 #define DYSKINESIA_THRESHOLD 0.05f  // 运动障碍幅值阈值 (降低)
-#define MOTION_THRESHOLD 0.30f      // 运动检测阈值 (降低以便检测停止)
+#define MOTION_THRESHOLD 0.30f      // 运动检测阈值: 步长内合成加速度标准差 (m/s²)
 #define FREEZE_TIME_MS 1500         // 冻结检测时间 1.5秒 (缩短)
 
 // HM-10 BLE 模块配置
@@ -25,11 +87,16 @@
 #define BLE_RX PA_3
 #define BLE_BAUD 9600
 
+// LSM6DSL 量程换算 (±2g, 灵敏度 0.061 mg/LSB)
+#define ACC_LSB_TO_MS2 (0.061f / 1000.0f * 9.81f)
+#define GRAVITY_LSB 16393           // 1g 对应的原始值 (1000 / 0.061)
+
 // LSM6DSL I2C地址（板载传感器）
 #define LSM6DSL_ADDR (0x6A << 1)    // mbed 使用 8-bit 地址
 
 // I2C 引脚（板载传感器）- 避免与mbed定义冲突
 #define SENSOR_I2C_SDA PB_11
 #define SENSOR_I2C_SCL PB_10
+#define SENSOR_INT1_PIN PD_11       // LSM6DSL INT1 (FIFO 水位中断)
 
 #endif
\ No newline at end of file
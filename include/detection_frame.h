@@ -0,0 +1,97 @@
+#ifndef DETECTION_FRAME_H
+#define DETECTION_FRAME_H
+
+#include <stdint.h>
+
+// BLE 检测帧格式 (版本 1)，不依赖 mbed，主机端可直接编译用于解码
+//
+// 一次通知 (小端):
+//   [0]     版本 (FRAME_VERSION)
+//   [1]     帧数 n
+//   [2..]   n 条记录，每条 RECORD_SIZE 字节:
+//           u16 序号 (窗口序号低 16 位，丢弃的窗口也计数，接收端据此发现缺口)
+//           u32 时间戳 (ms，窗口最后一个样本自开始采样起的时间)
+//           u8  标志: bit0 震颤, bit1 运动障碍, bit2 FOG, bit3-4 运动状态, bit5-6 主轴 (0=合成幅值, 1-3=X/Y/Z)
+//           u16 震颤强度, u16 运动障碍强度 (无符号定点，1/INTENSITY_SCALE m/s²，饱和)
+namespace frame {
+
+const uint8_t FRAME_VERSION = 1;
+const int HEADER_SIZE = 2;
+const int RECORD_SIZE = 11;
+const float INTENSITY_SCALE = 2048.0f;     // 量程 0 .. 32 m/s²，分辨率约 0.0005 m/s²
+
+const uint8_t FLAG_TREMOR = 0x01;
+const uint8_t FLAG_DYSKINESIA = 0x02;
+const uint8_t FLAG_FOG = 0x04;
+
+}  // namespace frame
+
+// 一条检测记录 (解码后的形式)
+struct DetectionRecord {
+    uint16_t sequence;
+    uint32_t timestampMs;
+    bool tremorDetected;
+    float tremorIntensity;
+    bool dyskinesiaDetected;
+    float dyskinesiaIntensity;
+    bool fogDetected;
+    uint8_t motionState;
+    int8_t dominantAxis;        // -1 表示合成幅值分析
+};
+
+namespace frame {
+
+uint16_t quantizeIntensity(float intensity);
+float dequantizeIntensity(uint16_t value);
+
+void encodeRecord(const DetectionRecord& record, uint8_t* out);
+void decodeRecord(const uint8_t* in, DetectionRecord* record);
+
+// 记录的状态字节 (标志、运动状态、主轴，即编码后的标志字节)
+uint8_t stateOf(const DetectionRecord& record);
+
+// 一次通知最多能容纳的记录数 (payloadLimit = ATT MTU - 3)
+int recordsPerPayload(int payloadLimit);
+
+// 编码 count 条记录为一次通知，返回字节数
+int encodeBatch(const DetectionRecord* records, int count, uint8_t* out);
+
+// 解码一次通知，返回记录数; 版本或长度不符时返回 -1
+int decodeBatch(const uint8_t* in, int len, DetectionRecord* records, int maxRecords);
+
+}  // namespace frame
+
+// 待发送的检测记录队列 (环形，保留最近 capacity 条)
+// 断开期间继续入队，重连后按 MTU 分批补发; 超出容量时丢弃最旧的未发送记录。
+// pushLatest 合并只有强度变化的记录: 状态 (标志、运动状态、主轴) 与前一条相同时替换队尾的同状态记录，
+// 状态翻转的记录保留原样，积压只随翻转次数增长
+class DetectionFrameQueue {
+public:
+    static const int CAPACITY = 32;
+
+private:
+    DetectionRecord records[CAPACITY];
+    int head;           // 最旧的未发送记录
+    int count;          // 未发送记录数
+    uint32_t dropped;   // 未发送即被覆盖的记录数
+    uint32_t merged;    // 被同状态的新记录替换的记录数
+    bool hasLast;
+    uint8_t lastState;  // 最后入队记录的状态
+    bool tailMergeable; // 队尾记录与它之前的记录状态相同 (不是翻转)，可以被替换
+
+public:
+    DetectionFrameQueue();
+    void push(const DetectionRecord& record);
+    void pushLatest(const DetectionRecord& record);
+    int getPending();
+    uint32_t getDropped();
+    uint32_t getMerged();
+
+    // 把最多 maxRecords 条 (且不超过 payloadLimit) 未发送记录编码为一次通知，返回字节数，
+    // 发送成功后调用 markSent(*records)
+    int encodePending(uint8_t* out, int payloadLimit, int maxRecords, int* records);
+    void markSent(int sent);
+    void clear();
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include "config.h"
+#include "detection_frame.h"
+#include "flash_device.h"
+#include <atomic>
+#include <stdint.h>
+
+// flash 上的循环事件日志，不依赖 mbed (通过 FlashDevice 访问存储)，主机端可用 HeapFlash 测试
+//
+// 存储布局: 每个擦除扇区 = 扇区头 + 定长条目，按序号轮流使用所有扇区 (天然磨损均衡)
+//   扇区头: u32 MAGIC, u32 扇区序号 (递增，扇区位置 = 序号 % 扇区数)
+//   条目:   11 字节检测记录 (同 detection_frame.h) + CRC8，补齐到编程单位; 全 0xFF 为空
+// 记录的全局序号 = 扇区序号 * 每扇区条目数 + 槽位，只增不减，下载端据此断点续传
+// 写满后擦除最旧的扇区继续写; 挂载时由扇区头和第一个空条目恢复写入位置，无需单独保存状态
+//
+// 批量下载块 (一次通知，小端):
+//   [0]     版本 (CHUNK_VERSION)
+//   [1]     记录数 n (0 表示已到日志末尾)
+//   [2..5]  u32 第一条记录的全局序号 (n 条记录序号连续; 小于请求的序号说明中间已被覆盖)
+//   [6..]   n 条记录，每条 frame::RECORD_SIZE 字节
+namespace eventlog {
+
+const uint32_t SECTOR_MAGIC = 0x47504C45;   // "ELPG"
+const int SECTOR_HEADER_SIZE = 8;
+const int ENTRY_DATA_SIZE = frame::RECORD_SIZE + 1;
+const int MAX_PROGRAM_SIZE = 16;            // 条目补齐后的上限 (QSPI NOR 为 1，片内 flash 为 8)
+const uint8_t CHUNK_VERSION = 1;
+const int CHUNK_HEADER_SIZE = 6;
+const int MAX_CHUNK_SIZE = 244;             // ATT MTU 247 - 3
+const int CHUNK_MAX_RECORDS = (MAX_CHUNK_SIZE - CHUNK_HEADER_SIZE) / frame::RECORD_SIZE;
+
+uint8_t crc8(const uint8_t* data, int len);
+
+// 一个下载块最多能容纳的记录数
+int recordsPerChunk(int payloadLimit);
+
+// 解码一个下载块，返回记录数; 格式错误返回 -1
+int decodeChunk(const uint8_t* in, int len, DetectionRecord* records, int maxRecords, uint32_t* firstIndex);
+
+}  // namespace eventlog
+
+class EventLog {
+private:
+    FlashDevice& flash;
+    bool mounted;
+
+    uint32_t sectorSize;
+    uint32_t sectorCount;
+    uint32_t headerSize;            // 扇区头补齐到编程单位
+    uint32_t entrySize;             // 条目补齐到编程单位
+    uint32_t entriesPerSector;
+
+    uint32_t headSeq;               // 正在写入的扇区序号
+    uint32_t headSlot;              // 下一个空槽位
+    uint32_t tailSeq;               // 最旧的有效扇区序号
+
+    uint32_t appended;
+    uint32_t erases;
+    uint32_t writeErrors;
+    uint32_t corruptEntries;        // 读取时 CRC 错误 (掉电时写了一半) 被跳过的条目
+
+    uint8_t readBuffer[eventlog::CHUNK_MAX_RECORDS * eventlog::MAX_PROGRAM_SIZE];
+
+    uint32_t sectorAddress(uint32_t seq);
+    bool readSectorSeq(uint32_t sector, uint32_t* seq);
+    bool openSector(uint32_t seq);
+    bool isErased(const uint8_t* entry);
+
+public:
+    explicit EventLog(FlashDevice& device);
+
+    // 挂载: 扫描扇区头恢复写入位置; 没有有效扇区时格式化
+    bool mount();
+    bool format();
+    bool isMounted();
+
+    bool append(const DetectionRecord& record);
+
+    // 从全局序号 index 开始编码一个下载块，返回字节数;
+    // *nextIndex 为下一块的起始序号 (发送成功后作为新的续传位置)
+    int encodeChunk(uint32_t index, uint8_t* out, int payloadLimit, uint32_t* nextIndex);
+
+    uint32_t getFirstIndex();       // 最旧的可读记录
+    uint32_t getNextIndex();        // 下一条追加记录的序号
+    uint32_t getCapacity();         // 最多保留的记录数 (不含正在擦除的扇区)
+    uint32_t getAppended();
+    uint32_t getErases();
+    uint32_t getWriteErrors();
+    uint32_t getCorruptEntries();
+};
+
+// 待写入事件日志的记录 (单生产者/单消费者，无锁): BLE 事件线程 push，低优先级写线程 pop 后 append，
+// 扇区擦除 (数十到数百 ms) 只阻塞写线程。队列满时丢弃新记录并计数，生产者从不等待
+class EventLogQueue {
+public:
+    typedef void (*RecordReadyCallback)(void* context);
+
+private:
+    DetectionRecord slots[EVENT_LOG_QUEUE_SLOTS];
+    std::atomic<uint32_t> head;         // 已写入的记录数 (只由生产者写)
+    std::atomic<uint32_t> tail;         // 已取出的记录数 (只由消费者写)
+    uint32_t dropped;                   // 队列满而丢弃的记录数 (只由生产者写)
+    RecordReadyCallback readyCallback;
+    void* readyContext;
+
+public:
+    EventLogQueue();
+    void reset();                       // 只能在生产者和消费者都停止时调用
+
+    // 生产者: 入队并调用就绪回调 (唤醒写线程)，队列满时返回 false
+    bool push(const DetectionRecord& record);
+    // 消费者: 取出最旧的记录，队列空时返回 false
+    bool pop(DetectionRecord* record);
+
+    void setReadyCallback(RecordReadyCallback callback, void* context);
+    int getPending();
+    uint32_t getDropped();
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef FLASH_DEVICE_H
+#define FLASH_DEVICE_H
+
+#include <stdint.h>
+
+// 块存储访问接口 (语义同 mbed BlockDevice: 先擦除再编程，擦除后为 0xFF)
+// 板上由 BlockDeviceFlash 包装 mbed BlockDevice (QSPI NOR 分区)，主机上由 HeapFlash 在内存中模拟
+class FlashDevice {
+public:
+    virtual ~FlashDevice() {}
+    virtual bool read(uint32_t addr, void* data, uint32_t size) = 0;
+    virtual bool program(uint32_t addr, const void* data, uint32_t size) = 0;  // 地址和长度按 getProgramSize 对齐
+    virtual bool erase(uint32_t addr, uint32_t size) = 0;                      // 地址和长度按 getEraseSize 对齐
+    virtual uint32_t getProgramSize() = 0;
+    virtual uint32_t getEraseSize() = 0;
+    virtual uint32_t getSize() = 0;
+};
+
+#endif
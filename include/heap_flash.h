@@ -0,0 +1,51 @@
+#ifndef HEAP_FLASH_H
+#define HEAP_FLASH_H
+
+#include "flash_device.h"
+#include <stdint.h>
+
+// 内存中的 NOR flash 模拟 (主机测试用)
+// 按 NOR 语义检查: 擦除置 0xFF，编程只能把 1 变 0，未对齐或越界的访问失败;
+// 记录每个扇区的擦除次数 (磨损均衡) 并可模拟编程中途掉电;
+// 可设置编程/擦除延迟 (按 NOR 页和扇区计)，操作本身立即完成，耗时累计到模拟时间供调用者推进时钟
+class HeapFlash : public FlashDevice {
+private:
+    uint8_t* data;
+    uint32_t size;
+    uint32_t eraseSize;
+    uint32_t programSize;
+    uint32_t* eraseCounts;
+
+    int32_t tornAfterBytes;     // >= 0: 下一次编程只写入这么多字节后失败 (模拟掉电)
+    uint32_t violations;        // 对未擦除位编程、未对齐等错误访问
+    uint32_t bytesRead;
+    uint32_t bytesProgrammed;
+
+    uint32_t pageSize;          // 编程延迟按页计 (NOR 页内一次编程)
+    uint32_t programPageUs;
+    uint32_t eraseSectorUs;
+    uint64_t elapsedUs;         // 累计的模拟操作时间
+
+    bool aligned(uint32_t addr, uint32_t len, uint32_t unit);
+
+public:
+    HeapFlash(uint32_t totalSize, uint32_t sectorSize, uint32_t programUnit);
+    ~HeapFlash();
+
+    void tearNextProgram(int32_t bytes);
+    void setLatency(uint32_t page, uint32_t programUs, uint32_t eraseUs);
+    uint64_t getElapsedUs();
+    uint32_t getEraseCount(uint32_t sector);
+    uint32_t getViolations();
+    uint32_t getBytesRead();
+    uint32_t getBytesProgrammed();
+
+    virtual bool read(uint32_t addr, void* buffer, uint32_t len) override;
+    virtual bool program(uint32_t addr, const void* buffer, uint32_t len) override;
+    virtual bool erase(uint32_t addr, uint32_t len) override;
+    virtual uint32_t getProgramSize() override;
+    virtual uint32_t getEraseSize() override;
+    virtual uint32_t getSize() override;
+};
+
+#endif
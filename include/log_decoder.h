@@ -0,0 +1,46 @@
+#ifndef LOG_DECODER_H
+#define LOG_DECODER_H
+
+#include "tokenlog.h"
+#include <cstdio>
+#include <stdint.h>
+
+// 令牌化日志的主机端解码 (帧格式见 tokenlog.h): 按消息表的格式字符串还原文本
+namespace logdecode {
+
+// 消息的格式字符串，未知编号返回 nullptr
+const char* formatOf(uint16_t id);
+
+// 按格式字符串格式化一条消息，返回文本长度 (超出 size 时截断);
+// 未知编号、参数个数不符或格式不支持 (%s 等) 返回 -1
+int formatRecord(char* out, int size, uint16_t id, const uint32_t* args, int count);
+
+// 串口字节流解码: 帧还原为一行文本，帧之外的字节 (启动信息等普通文本) 原样输出 (去掉 '\r' 等控制字符)，
+// 起始字节后长度非法时丢弃起始字节，从下一个字节重新同步; CRC 错误时丢弃整个坏帧，
+// 只从其中的下一个起始字节重新同步
+class StreamDecoder {
+private:
+    FILE* out;
+    uint8_t frame[tokenlog::MAX_FRAME_SIZE];
+    int length;                 // frame 中已收到的字节数 (0 表示不在帧内)
+    uint32_t frames;
+    uint32_t badFrames;
+
+    void feedByte(uint8_t byte);
+    void emitFrame();
+    void emitText(uint8_t byte);
+
+public:
+    explicit StreamDecoder(FILE* output);
+
+    void feed(const uint8_t* data, int len);
+    // 输入结束: 未完成的帧按普通文本输出
+    void finish();
+
+    uint32_t getFrames() { return frames; }
+    uint32_t getBadFrames() { return badFrames; }
+};
+
+}  // namespace logdecode
+
+#endif
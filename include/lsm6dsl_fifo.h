@@ -0,0 +1,71 @@
+#ifndef LSM6DSL_FIFO_H
+#define LSM6DSL_FIFO_H
+
+#include "config.h"
+#include "sensor_bus.h"
+#include <stdint.h>
+
+// LSM6DSL 寄存器
+namespace lsm6dsl {
+
+const uint8_t FIFO_CTRL1 = 0x06;        // FTH[7:0]
+const uint8_t FIFO_CTRL2 = 0x07;        // FTH[10:8]
+const uint8_t FIFO_CTRL3 = 0x08;        // DEC_FIFO_GYRO[5:3], DEC_FIFO_XL[2:0]
+const uint8_t FIFO_CTRL4 = 0x09;
+const uint8_t FIFO_CTRL5 = 0x0A;        // ODR_FIFO[6:3], FIFO_MODE[2:0]
+const uint8_t INT1_CTRL = 0x0D;
+const uint8_t WHO_AM_I = 0x0F;
+const uint8_t CTRL1_XL = 0x10;
+const uint8_t CTRL3_C = 0x12;
+const uint8_t OUTX_L_XL = 0x28;
+const uint8_t FIFO_STATUS1 = 0x3A;      // DIFF_FIFO[7:0]
+const uint8_t FIFO_STATUS2 = 0x3B;      // WaterM, OVER_RUN, FIFO_FULL, FIFO_EMPTY, DIFF_FIFO[10:8]
+const uint8_t FIFO_STATUS3 = 0x3C;      // FIFO_PATTERN[7:0]
+const uint8_t FIFO_STATUS4 = 0x3D;      // FIFO_PATTERN[9:8]
+const uint8_t FIFO_DATA_OUT_L = 0x3E;
+const uint8_t FIFO_DATA_OUT_H = 0x3F;
+
+const uint8_t WHO_AM_I_VALUE = 0x6A;
+
+const uint8_t CTRL1_XL_52HZ_2G = 0x30;  // ODR=52Hz (0011b), FS=±2g
+const uint8_t CTRL3_C_BDU_IF_INC = 0x44;
+const uint8_t FIFO_CTRL3_XL_NO_DEC = 0x01;
+const uint8_t FIFO_ODR_52HZ = 0x03 << 3;
+const uint8_t FIFO_MODE_BYPASS = 0x00;
+const uint8_t FIFO_MODE_CONTINUOUS = 0x06;
+const uint8_t INT1_FTH = 0x08;
+
+const uint8_t STATUS2_WATERMARK = 0x80;
+const uint8_t STATUS2_OVER_RUN = 0x40;
+const uint8_t STATUS2_EMPTY = 0x10;
+
+const int FIFO_WORDS = 2048;            // 4 KB FIFO，按 16 位字计
+const int WORDS_PER_SAMPLE = 3;         // 只有加速度计 x/y/z 入 FIFO
+
+}  // namespace lsm6dsl
+
+// LSM6DSL FIFO 驱动: 连续模式 + INT1 水位中断，一次突发读取一批样本
+// 只依赖 SensorBus，可以在主机上对寄存器级仿真运行
+class Lsm6dslFifo {
+private:
+    SensorBus& bus;
+    int watermark;              // 水位 (样本数)
+    uint32_t overruns;          // FIFO 溢出次数 (连续模式下旧数据被覆盖)
+    uint32_t transactions;      // 总线事务数
+
+public:
+    explicit Lsm6dslFifo(SensorBus& sensorBus);
+    bool configure(int watermarkSamples);
+    bool stop();
+    int readBatch(int16_t* xyz, int maxSamples);
+    
+    // 异步批量读取: prepareBatch 读取状态并对齐 (短事务，同步)，
+    // startBatchRead 发起非阻塞突发读取，完成后由调用者执行 finishBatch 转换字节序
+    int prepareBatch(int maxSamples);
+    bool startBatchRead(int16_t* xyz, int samples, BusCompletion done, void* context);
+    void finishBatch(int16_t* xyz, int samples);
+    uint32_t getOverruns();
+    uint32_t getTransactions();
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef LSM6DSL_SIM_H
+#define LSM6DSL_SIM_H
+
+#include "sensor_bus.h"
+#include "lsm6dsl_fifo.h"
+#include <stdint.h>
+
+// LSM6DSL 寄存器级仿真 (主机测试用)
+// 模拟 FIFO 连续模式、水位/溢出/空标志、pattern 计数、FIFO_DATA_OUT 地址回卷和 INT1 电平
+class Lsm6dslSim : public SensorBus {
+private:
+    uint8_t regs[128];
+    uint16_t fifo[lsm6dsl::FIFO_WORDS];
+    int fifoHead;           // 最旧字的位置
+    int fifoCount;          // 未读字数
+    int readPhase;          // 下一个读出的字在样本中的位置 (0=x, 1=y, 2=z)
+    bool highByteNext;      // FIFO_DATA_OUT 读到低字节后等待高字节
+    bool overrun;
+    uint32_t readTransactions;
+    uint32_t writeTransactions;
+
+    bool fifoEnabled();
+    int thresholdWords();
+    void pushWord(uint16_t word);
+    uint8_t readByte(uint8_t reg);
+
+public:
+    Lsm6dslSim();
+    void reset();
+
+    // 按 ODR 产生一个样本 (写入输出寄存器，FIFO 使能时同时入队)
+    void pushSample(int16_t x, int16_t y, int16_t z);
+
+    bool isInt1Asserted();
+    int getFifoSamples();
+    uint32_t getReadTransactions();
+    uint32_t getWriteTransactions();
+
+    virtual bool writeReg(uint8_t reg, uint8_t value) override;
+    virtual bool readRegs(uint8_t reg, uint8_t* data, int len) override;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdint.h>
+
+// 只读内存映射文件 (主机工具用，POSIX mmap)
+class MappedFile {
+private:
+    const uint8_t* data;
+    uint32_t size;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const char* path);
+    void close();
+
+    const uint8_t* getData();
+    uint32_t getSize();
+};
+
+#endif
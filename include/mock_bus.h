@@ -0,0 +1,44 @@
+#ifndef MOCK_BUS_H
+#define MOCK_BUS_H
+
+#include "sensor_bus.h"
+#include <stdint.h>
+
+// 带可配置延迟的模拟异步总线 (主机测试用)
+// 包装另一个 SensorBus (如 Lsm6dslSim)，异步读取在模拟时间经过 latencyUs 后才交付数据并回调，
+// 交付前目标缓冲区保持为填充值，用于验证调用者不会提前使用数据
+class MockAsyncBus : public SensorBus {
+private:
+    static const int MAX_TRANSFER = 512;
+
+    SensorBus& target;
+    uint32_t latencyUs;
+    uint32_t nowUs;
+
+    // 进行中的传输 (同一时刻只允许一个，与 I2C 外设一致)
+    bool busy;
+    uint32_t completeAtUs;
+    uint8_t pending[MAX_TRANSFER];
+    uint8_t* destination;
+    int pendingLen;
+    bool pendingSuccess;
+    BusCompletion pendingDone;
+    void* pendingContext;
+
+    uint32_t completedTransfers;
+    uint32_t busyUs;
+
+public:
+    explicit MockAsyncBus(SensorBus& targetBus, uint32_t latency = 0);
+    void setLatency(uint32_t latency);
+    void advance(uint32_t us);      // 推进模拟时间，到期的传输在此回调
+    bool isBusy();
+    uint32_t getCompletedTransfers();
+    uint32_t getBusyTime();
+
+    virtual bool writeReg(uint8_t reg, uint8_t value) override;
+    virtual bool readRegs(uint8_t reg, uint8_t* data, int len) override;
+    virtual bool readRegsAsync(uint8_t reg, uint8_t* data, int len, BusCompletion done, void* context) override;
+};
+
+#endif
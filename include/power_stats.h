@@ -0,0 +1,25 @@
+#ifndef POWER_STATS_H
+#define POWER_STATS_H
+
+#include <stdint.h>
+
+// 睡眠统计 (自启动起，时间由低功耗定时器计量，Stop 模式下继续计时)
+struct SleepStats {
+    uint32_t sleepEntries;          // Sleep 模式进入次数 (有外设持有深度睡眠锁时)
+    uint32_t deepSleepEntries;      // Stop 模式进入次数
+    uint64_t sleepTimeUs;
+    uint64_t deepSleepTimeUs;
+    uint64_t uptimeUs;
+};
+
+namespace power {
+
+// 读取睡眠计数 (可在任意线程调用)
+void getSleepStats(SleepStats* stats);
+
+// 深度睡眠驻留比例 (0-100)
+float deepSleepPercent(const SleepStats& stats);
+
+}  // namespace power
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef PUBLISH_POLICY_H
+#define PUBLISH_POLICY_H
+
+#include "config.h"
+#include "detection_frame.h"
+#include <stdint.h>
+
+// BLE 检测结果发布策略，不依赖 mbed，主机端可直接测试
+//
+// 每个窗口的结果先经过 offer(): 只有状态变化才发布，其余窗口被抑制 (接收端由序号缺口得知):
+//   - 检测标志 (震颤/运动障碍/FOG) 或运动状态翻转
+//   - 强度相对上次发布的值变化超过 intensityDelta (死区，避免噪声在阈值附近反复触发)
+//   - 距上次发布超过 heartbeatMs (心跳，证明连接和检测仍在运行)
+// 发布的记录再受最大通知速率限制: 两次通知间隔不小于 minIntervalMs，期间到达的记录在队列中等待
+// (只有强度变化的记录由 DetectionFrameQueue::pushLatest 合并)，下一次通知按 MTU 装满
+class PublishPolicy {
+private:
+    float intensityDelta;
+    uint32_t heartbeatMs;
+    uint32_t minIntervalMs;
+
+    bool hasPublished;
+    DetectionRecord lastPublished;
+
+    bool hasNotified;
+    uint32_t lastNotifyMs;
+
+    uint32_t published;
+    uint32_t suppressed;
+    uint32_t deferred;
+
+    bool flagsChanged(const DetectionRecord& record);
+    bool intensityChanged(const DetectionRecord& record);
+
+public:
+    PublishPolicy();
+    void configure(float delta, uint32_t heartbeat, uint32_t minInterval);
+
+    // 是否发布这条记录 (时间取记录的时间戳，即采样时钟)
+    bool offer(const DetectionRecord& record);
+
+    // 距允许下一次通知还需等待的 ms (0 表示现在可以发送)，nowMs 为本地单调时钟
+    uint32_t notifyDelay(uint32_t nowMs);
+    void notified(uint32_t nowMs);
+    // 因速率限制新安排了一次定时发送 (已安排时重复调用 notifyDelay 不计数)
+    void countDeferral();
+
+    // 下一条记录无条件发布 (新的订阅者需要当前状态)
+    void reset();
+
+    uint32_t getPublished();
+    uint32_t getSuppressed();
+    uint32_t getDeferred();     // 因速率限制推迟的通知次数 (countDeferral 的次数)
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef RAW_RECORDER_H
+#define RAW_RECORDER_H
+
+#include "config.h"
+#include "flash_device.h"
+#include "session_format.h"
+#include <atomic>
+#include <stdint.h>
+
+// QSPI 原始数据记录器 (块格式见 session_format.h): 采集线程逐样本写入当前 RAM 块，写满后交给低优先级写线程编程到 flash，
+// 同时开始填另一个块 (双缓冲)。采集端从不等待 flash: 写线程来不及时丢弃样本并计数
+class RawRecorder {
+public:
+    typedef void (*BlockReadyCallback)(void* context);
+    typedef uint32_t (*ClockFunction)();
+
+private:
+    FlashDevice& flash;
+    uint32_t blockCount;
+    uint32_t blocksPerSector;
+    uint32_t nextBlock;                 // 下一个写入的块号 (写线程)
+
+    uint8_t buffers[2][RECORDER_BLOCK_SIZE];
+    int fillIndex;                      // 采集线程正在填的缓冲区
+    int fillCount;
+    uint32_t fillFirstSample;
+    bool sealed;                        // 当前缓冲区已满但写线程还没取走另一个
+    int pendingIndex;                   // 等待写入的缓冲区 (pending 置位前写入)
+    std::atomic<bool> pending;          // 有满块等待写入
+    std::atomic<bool> recording;
+    std::atomic<bool> full;             // flash 已写满，停止记录
+
+    sessionfile::SessionInfo session;
+    ClockFunction clock;
+    BlockReadyCallback readyCallback;
+    void* readyContext;
+
+    // 生产者计数
+    uint32_t samplesRecorded;           // 已交给写线程的样本
+    uint32_t samplesDropped;
+    // 写线程计数
+    uint32_t blocksWritten;
+    uint32_t writeErrors;
+
+    bool isBlockErased(uint32_t block);
+    bool writeBlock(const uint8_t* data);
+    void beginBlock(uint32_t sampleIndex);
+    void sealBlock();
+    bool handOff();
+
+public:
+    explicit RawRecorder(FlashDevice& device);
+
+    // 找到已记录数据的末尾 (二分查找第一个空块)
+    bool mount();
+    bool eraseAll();
+
+    // 开始新会话 (同步写入会话块，在采集开始前调用)
+    bool startSession(uint8_t sensorId, uint32_t startSample, uint32_t startMs, uint32_t startEpoch);
+    // 停止记录，未满的当前块交给写线程 (在采集线程中或采集停止后调用)
+    void stop();
+
+    // 生产者 (采集线程)
+    void push(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex);
+
+    // 写线程: 有满块时写入 flash，返回是否写了一块
+    bool service();
+
+    void setClock(ClockFunction function);
+    void setReadyCallback(BlockReadyCallback callback, void* context);
+
+    bool isRecording();
+    bool hasPendingBlock();
+    bool isFull();
+    uint32_t getNextBlock();
+    uint32_t getBlockCount();
+    uint32_t getSessionId();
+    uint32_t getSamplesRecorded();
+    uint32_t getSamplesDropped();
+    uint32_t getBlocksWritten();
+    uint32_t getWriteErrors();
+};
+
+#endif
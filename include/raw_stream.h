@@ -0,0 +1,114 @@
+#ifndef RAW_STREAM_H
+#define RAW_STREAM_H
+
+#include "config.h"
+#include <atomic>
+#include <stdint.h>
+
+// 原始加速度流压缩格式 (版本 1)，不依赖 mbed，主机端可直接编译用于解码和基准测试
+//
+// 一个包 (一次 BLE 通知，小端):
+//   [0]     版本 (STREAM_VERSION)
+//   [1]     样本数 n
+//   [2..5]  u32 第一个样本的序号 (自开始采样起，接收端据此发现丢包)
+//   [6..]   n 个样本，每个样本 x/y/z 三个 varint: zigzag(原始 LSB - 同轴上一个样本)，
+//           包内第一个样本相对 0 编码，因此每个包可独立解码
+namespace rawstream {
+
+const uint8_t STREAM_VERSION = 1;
+const int HEADER_SIZE = 6;
+const int MAX_SAMPLE_BYTES = 9;         // 差值范围 ±65535，zigzag 后每轴最多 3 字节
+const int MAX_PACKET_SIZE = 244;        // ATT MTU 247 - 3
+const int MAX_SAMPLES_PER_PACKET = 255;
+
+inline uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// 解码一个包，返回样本数 (xyz 交错写入); 格式错误返回 -1
+int decodePacket(const uint8_t* in, int len, int16_t* xyz, int maxSamples, uint32_t* firstSample);
+
+}  // namespace rawstream
+
+// 单包编码器: 逐样本追加，O(1)，无除法和浮点
+class RawStreamEncoder {
+private:
+    uint8_t* out;
+    int capacity;
+    int length;
+    int count;
+    int16_t previous[3];
+
+    void putVarint(uint32_t value);
+
+public:
+    RawStreamEncoder();
+    void begin(uint8_t* buffer, int bufferCapacity, uint32_t firstSample);
+    void add(int16_t x, int16_t y, int16_t z);
+    bool isFull();      // 再追加一个样本可能放不下
+    int finish();       // 写入样本数，返回包长度
+    int getCount();
+};
+
+// 原始数据流: 采集线程逐样本压缩，完成的包经无锁单生产者/单消费者环形队列交给 BLE 线程
+// 采集端从不等待: 队列满 (链路跟不上) 时丢弃样本并计数
+class RawStreamer {
+public:
+    typedef void (*PacketReadyCallback)(void* context);
+
+private:
+    struct Packet {
+        uint16_t length;
+        uint8_t data[rawstream::MAX_PACKET_SIZE];
+    };
+
+    Packet packets[RAW_STREAM_PACKET_SLOTS];
+    std::atomic<uint32_t> head;         // 已完成的包数 (生产者写)
+    std::atomic<uint32_t> tail;         // 已发送的包数 (消费者写)
+
+    RawStreamEncoder encoder;
+    bool packetOpen;
+    std::atomic<bool> enabled;
+    std::atomic<int> payloadLimit;      // 当前 MTU 下的包长度上限
+
+    PacketReadyCallback readyCallback;
+    void* readyContext;
+
+    // 生产者计数
+    uint32_t samplesEncoded;
+    uint32_t samplesDropped;
+    uint32_t packetsProduced;
+    uint32_t bytesProduced;
+
+    bool openPacket(uint32_t sampleIndex);
+    void closePacket();
+
+public:
+    RawStreamer();
+    void reset();                       // 只能在生产者和消费者都停止时调用
+
+    // 生产者 (采集线程)
+    void push(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex);
+
+    // 消费者 (BLE 线程): 取最旧的完成包，发送成功后 pop
+    const uint8_t* peek(int* length);
+    void pop();
+
+    // 控制 (任意线程)
+    void setEnabled(bool enable);
+    bool isEnabled();
+    void setPayloadLimit(int limit);
+    void setReadyCallback(PacketReadyCallback callback, void* context);
+
+    uint32_t getSamplesEncoded();
+    uint32_t getSamplesDropped();
+    uint32_t getPacketsProduced();
+    uint32_t getBytesProduced();
+    int getPendingPackets();
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef REPLAY_ENGINE_H
+#define REPLAY_ENGINE_H
+
+#include "config.h"
+#include "detector.h"
+#include "window_builder.h"
+#include "window_queue.h"
+#include <chrono>
+#include <cstdio>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// 离线回放 (主机工具): 把记录的原始样本送入与板上相同的窗口组装 (WindowBuilder) 和检测器，
+// 不等待采样时钟，逐窗口输出 DetectionResult。检测器状态按时间顺序演进，
+// 因此一个会话只能顺序处理，并行发生在输入文件之间。
+// 输入文件边读边回放 (每个文件在一个工作线程中)，内存中只保留一个块的样本和各段的汇总
+namespace replay {
+
+// 内存中的一段连续记录 (x/y/z 交错的原始 LSB，样本序号连续)，用于合成数据
+struct Session {
+    std::string name;
+    uint32_t firstSample;           // 第一个样本的序号 (记录中的序号)
+    std::vector<int16_t> xyz;
+
+    uint32_t getSampleCount() const {
+        return (uint32_t)(xyz.size() / 3);
+    }
+};
+
+// 读取统计
+struct LoadStats {
+    uint32_t sessions;              // 记录中的会话数
+    uint32_t gaps;                  // 样本序号缺口 (在缺口处拆分成新的一段)
+    uint32_t badBlocks;             // 损坏的块 (CRC 错误等)
+};
+
+// 一段的回放结果
+struct Summary {
+    uint32_t samples;
+    uint32_t windows;
+    uint32_t tremorWindows;
+    uint32_t dyskinesiaWindows;
+    uint32_t fogWindows;
+    uint64_t elapsedUs;             // 本段的处理时间 (墙钟，文件输入时含读取和解码)
+    bool outputError;
+};
+
+void writeResultHeader(FILE* out);
+void writeResult(FILE* out, const DetectionResult& result);
+
+// 每个工作线程一个回放器 (窗口组装 + 检测器 + 窗口缓冲区)，依次处理分配到的段:
+// begin 开始一段 (从头开始，与板上重新开始采样相同)，逐样本 addSample，finish 返回汇总
+class SessionReplayer {
+private:
+    WindowBuilder builder;
+    Detector detector;
+    AnalysisWindow window;
+    uint32_t sampleTimeMs;          // 当前窗口最后一个样本的时间，代替板上的定时器用于 FOG 计时
+    FILE* output;
+    Summary current;
+    std::chrono::steady_clock::time_point started;
+
+    static uint32_t sampleClock(void* context);
+
+public:
+    SessionReplayer();
+    void setHopSize(int hop);
+    // out 为空时只统计，不输出逐窗口结果
+    void begin(FILE* out);
+    void addSample(int16_t x, int16_t y, int16_t z);
+    Summary finish();
+    // 回放内存中的一段
+    Summary run(const Session& session, FILE* out);
+};
+
+// 文件中的一段 (按样本序号缺口拆分; 段名为会话名，同一会话的后续段加 "#n" 后缀)
+struct SegmentSummary {
+    std::string name;
+    Summary summary;
+    bool openFailed;                // 无法创建该段的输出文件 (未回放)
+};
+
+// 边读边回放一个输入文件，每段的结果写入 <outDir>/<段名>.csv (outDir 为空时只统计);
+// 文件无法读取时返回 false
+// CSV: 每行 "x,y,z" 或 "序号,x,y,z" (原始 LSB)，无法解析的行 (表头等) 跳过
+bool replayCsv(const char* path, SessionReplayer* replayer, const char* outDir,
+               std::vector<SegmentSummary>* segments, LoadStats* stats);
+// 原始数据记录器的 flash 镜像 (session_format.h 的块格式)，逐块读取，每个会话按缺口拆成若干段
+bool replayRecorderImage(const char* path, SessionReplayer* replayer, const char* outDir,
+                         std::vector<SegmentSummary>* segments, LoadStats* stats);
+// 会话文件 (.pds): mmap 后按块从映射中直接读取样本 (FileView::readSamples)，不复制整个文件
+bool replaySessionFile(const char* path, SessionReplayer* replayer, const char* outDir,
+                       std::vector<SegmentSummary>* segments, LoadStats* stats);
+
+}  // namespace replay
+
+#endif
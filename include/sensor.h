@@ -3,25 +3,80 @@
 
 #include "mbed.h"
 #include "config.h"
+#include "fixed_fft.h"
+#include "sensor_bus.h"
+#include "lsm6dsl_fifo.h"
+#include "window_queue.h"
+#include "window_builder.h"
+#include "raw_stream.h"
+#include "raw_recorder.h"
+#include "capture_link.h"
+#include "stage_timing.h"
 
-class SensorManager {
+// 每次最多突发读取的样本数 (允许一次追上两个水位)
+#define FIFO_BATCH_MAX (2 * FIFO_WATERMARK)
+
+class SensorManager : public SensorBus {
 private:
     I2C* i2c;
-    Ticker sampler;
-    float dataBuffer[WINDOW_SIZE];
-    int bufferIndex;
-    volatile bool bufferFull;
-    volatile bool sampleReady;  // ISR 设置的标志
+    InterruptIn int1;        // LSM6DSL INT1: FIFO 水位中断
+    EventFlags dataFlags;
+    Lsm6dslFifo fifo;
+    
+    // 双缓冲批次 (x, y, z 交错): 一个供 update() 逐样本消费，另一个由异步 I2C 传输填充
+    int16_t fifoBatch[2][FIFO_BATCH_MAX * 3];
+    int activeBatch;     // 正在消费的批次
+    int batchCount;
+    int batchPos;
+    
+    // 异步传输状态 (完成回调在 I2C 中断中修改)
+    enum TransferState {
+        TRANSFER_IDLE,
+        TRANSFER_BUSY,
+        TRANSFER_DONE
+    };
+    volatile TransferState transferState;
+    volatile bool transferSuccess;
+    int transferCount;   // 进行中的传输包含的样本数
+#if STAGE_TIMING_ENABLED
+    uint32_t transferStartUs;           // 状态读取开始 (采集阶段计时)
+    volatile uint32_t transferEndUs;    // 传输完成中断中记录
+    uint32_t convertUs;                 // 当前批次的转换和窗口组装累计耗时
+#endif
+    
+    // readRegsAsync 的 I2C 上下文
+    char asyncRegAddr;
+    BusCompletion asyncDone;
+    void* asyncContext;
+    
+    // 窗口组装 (采集端私有): 镜像环形缓冲区 + 活动统计，与主机回放工具共用
+    WindowBuilder builder;
+    
+    // 就绪窗口: 窗口产出时从镜像缓冲区复制到空闲槽，分析端读取期间采样照常进行
+    WindowQueue windows;
+    
+    RawStreamer* rawStream;     // 原始数据流 (可选)，在采集路径中逐样本压缩
+    RawRecorder* rawRecorder;   // 原始数据记录 (可选)，写入 RAM 块，flash 编程在记录线程
+    CaptureLink* captureLink;   // 有线采集 (可选)，逐样本压缩，每批样本发送一个包
+    
+    static constexpr uint32_t FLAG_FIFO_WATERMARK = 0x01;
+    static constexpr uint32_t FLAG_TRANSFER_DONE = 0x02;
+    static constexpr uint32_t FLAG_WINDOW_READY = 0x04;     // 分析线程等待 (与采集线程的标志互不清除)
 
     // LSM6DSL 寄存器
     static constexpr uint8_t WHO_AM_I_REG = 0x0F;
     static constexpr uint8_t CTRL1_XL = 0x10;
-    static constexpr uint8_t OUTX_L_XL = 0x28;
     static constexpr uint8_t EXPECTED_WHO_AM_I = 0x6A;
     
-    bool writeReg(uint8_t reg, uint8_t value);
-    bool readRegs(uint8_t reg, uint8_t* data, int len);
-    void sampleISR();
+    void fifoISR();
+    void startTransfer();
+    void waitTransferIdle();
+    static void onTransferComplete(void* context, bool success);
+#if DEVICE_I2C_ASYNCH
+    void onI2CEvent(int event);
+#endif
+    void storeSample(int16_t ax_raw, int16_t ay_raw, int16_t az_raw);
+    void publishWindow();
     
 public:
     SensorManager();
@@ -29,11 +84,27 @@ public:
     bool begin();
     void startSampling();
     void stopSampling();
-    void update();  // 在主循环中调用，读取传感器数据
-    bool isBufferReady();
-    float* getDataBuffer();
-    void clearBuffer();
-    float getCurrentMagnitude();
+    virtual bool writeReg(uint8_t reg, uint8_t value) override;
+    virtual bool readRegs(uint8_t reg, uint8_t* data, int len) override;
+#if DEVICE_I2C_ASYNCH
+    virtual bool readRegsAsync(uint8_t reg, uint8_t* data, int len, BusCompletion done, void* context) override;
+#endif
+    void waitForData();  // 阻塞直到 FIFO 到达水位 (或仍有未处理的样本)
+    bool update();  // 在采集线程中调用，处理一个样本 (需要时从 FIFO 突发读取一批); 存入新样本时返回 true
+    float getLatestSample();
+    void setRawStream(RawStreamer* streamer);
+    void setRecorder(RawRecorder* recorder);
+    void setCaptureLink(CaptureLink* link);
+    void setHopSize(int hop);
+    int getHopSize();
+    
+    // 分析端: 取得最旧的就绪窗口 (没有时返回 nullptr)，处理完后 releaseWindow 归还槽
+    AnalysisWindow* acquireWindow();
+    AnalysisWindow* waitForWindow();    // 阻塞直到有就绪窗口 (分析线程)
+    void releaseWindow();
+    uint32_t getWindowOverruns();   // 分析来不及而丢弃的窗口数
+    uint32_t getFifoOverruns();
+    uint32_t getBusTransactions();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef SENSOR_BUS_H
+#define SENSOR_BUS_H
+
+#include <stdint.h>
+
+// 异步传输完成回调 (板上在 I2C 中断上下文中调用，只能设置标志)
+typedef void (*BusCompletion)(void* context, bool success);
+
+// 传感器寄存器访问接口
+// 板上由 I2C 实现 (SensorManager)，主机上由 Lsm6dslSim 寄存器级仿真实现
+class SensorBus {
+public:
+    virtual ~SensorBus() {}
+    virtual bool writeReg(uint8_t reg, uint8_t value) = 0;
+    virtual bool readRegs(uint8_t reg, uint8_t* data, int len) = 0;
+
+    // 非阻塞读取: 立即返回，传输结束后调用 done
+    // 默认实现退化为同步读取后立即回调
+    virtual bool readRegsAsync(uint8_t reg, uint8_t* data, int len, BusCompletion done, void* context) {
+        bool success = readRegs(reg, data, len);
+        done(context, success);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SESSION_FILE_H
+#define SESSION_FILE_H
+
+#include "session_format.h"
+#include <cstdio>
+#include <stdint.h>
+#include <vector>
+
+// 会话文件 (.pds，格式见 session_format.h) 的写入和只读视图
+namespace sessionfile {
+
+// 顺序写入会话文件: 逐样本追加 (与记录器相同的块编码)，或原样追加记录器的数据块
+// 样本序号出现缺口时结束当前块; close 写入索引和尾部
+class FileWriter {
+private:
+    FILE* file;
+    SessionInfo info;
+    uint8_t block[BLOCK_SIZE];
+    int fillCount;
+    uint32_t fillFirstSample;
+    uint32_t offset;                    // 下一个块在文件中的偏移
+    uint32_t sampleCount;
+    std::vector<uint32_t> index;        // 每块 {第一个样本序号, 偏移}
+    bool failed;
+
+    bool writeBlock(const uint8_t* data, uint32_t firstSample, int count);
+    bool flushBlock();
+
+public:
+    FileWriter();
+    // 写入会话块 (文件由调用者打开和关闭)
+    bool open(FILE* output, const SessionInfo& session);
+    bool append(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex);
+    // 追加一个已编码的数据块 (CRC 正确，样本序号不早于已写入的样本)
+    bool appendBlock(const uint8_t* data);
+    bool close();
+
+    uint32_t getSampleCount();
+    uint32_t getBlockCount();
+};
+
+// 内存中 (通常是 mmap) 的会话文件只读视图: open 只检查会话块、尾部和索引，
+// 按样本序号定位是对索引的二分查找，样本直接从块的列中读取，不解析整个文件
+class FileView {
+private:
+    const uint8_t* base;
+    SessionInfo info;
+    const uint8_t* index;
+    uint32_t blockCount;
+    uint32_t sampleCount;
+
+public:
+    FileView();
+    bool open(const uint8_t* data, uint32_t length);
+
+    const SessionInfo& getInfo();
+    uint32_t getBlockCount();
+    uint32_t getSampleCount();
+
+    // 第 k 个数据块
+    const uint8_t* getBlock(uint32_t k);
+    uint32_t getBlockFirstSample(uint32_t k);
+    int getBlockSamples(uint32_t k);
+    // 包含该样本的数据块，不在文件中 (缺口或越界) 时返回 -1
+    int32_t findBlock(uint32_t sampleIndex);
+
+    // 读取 [firstSample, firstSample + count) 按 x/y/z 交错写入 xyz，
+    // 遇到缺口时停止; 返回读到的样本数
+    int readSamples(uint32_t firstSample, int count, int16_t* xyz);
+    // 校验所有数据块的 CRC，返回损坏的块数
+    uint32_t verify();
+};
+
+// CSV 转换: 解析 "x,y,z" 或 "序号,x,y,z" (原始 LSB)，返回列数 (3 或 4)，不是样本行 (表头等) 返回 0
+int parseCsvSample(const char* line, uint32_t* sampleIndex, int16_t* xyz);
+
+}  // namespace sessionfile
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef SESSION_FORMAT_H
+#define SESSION_FORMAT_H
+
+#include "config.h"
+#include <stdint.h>
+
+// 原始加速度会话格式 (版本 1): 固定大小的块，板上记录器按块顺序写入 flash，主机会话文件使用同样的块
+// 未写入的块全为 0xFF; 所有整数均为小端
+//
+// 会话块 (每次开始记录一个):
+//   u32 SESSION_MAGIC, u8 版本, u8 传感器 ID (WHO_AM_I), u16 ODR (Hz), u16 量程 (g), u16 块大小 (0 表示 1024),
+//   u32 会话 ID (会话块的块号), u32 起始样本序号, u32 起始时间 (ms，上电起), u32 起始时间 (Unix 秒，RTC 未设置为 0)
+// 数据块:
+//   u32 DATA_MAGIC, u32 会话 ID, u32 第一个样本序号, u32 第一个样本的采集时间 (ms), u16 样本数 n, u16 CRC16 (样本数据)
+//   x[SAMPLES_PER_BLOCK], y[...], z[...] 三列 int16 原始 LSB，只有前 n 个有效，其余为 0xFF
+// 块内样本序号连续; 块之间的序号缺口表示记录端丢弃的样本
+//
+// 会话文件 (.pds) = 会话块 + 数据块 + 稀疏索引 + 尾部，可以 mmap 后直接按样本序号定位:
+//   索引: 每个数据块一项 {u32 第一个样本序号, u32 块在文件中的偏移}，按样本序号递增
+//   尾部 (文件最后 16 字节): u32 INDEX_MAGIC, u32 索引偏移, u32 数据块数, u32 样本总数
+namespace sessionfile {
+
+const uint32_t SESSION_MAGIC = 0x53524450;  // "PDRS"
+const uint32_t DATA_MAGIC = 0x44524450;     // "PDRD"
+const uint32_t INDEX_MAGIC = 0x49534450;    // "PDSI"
+const uint8_t FORMAT_VERSION = 1;
+const int BLOCK_SIZE = RECORDER_BLOCK_SIZE;
+const int SESSION_HEADER_SIZE = 32;
+const int DATA_HEADER_SIZE = 20;
+const int SAMPLES_PER_BLOCK = (BLOCK_SIZE - DATA_HEADER_SIZE) / 6;
+const int COLUMN_BYTES = SAMPLES_PER_BLOCK * 2;
+const int INDEX_ENTRY_SIZE = 8;
+const int TRAILER_SIZE = 16;
+
+struct SessionInfo {
+    uint32_t sessionId;
+    uint8_t sensorId;
+    uint16_t odrHz;
+    uint16_t fullScaleG;
+    uint32_t startSample;
+    uint32_t startMs;
+    uint32_t startEpoch;
+};
+
+struct BlockInfo {
+    uint32_t sessionId;
+    uint32_t firstSample;
+    uint32_t timestampMs;
+    int count;
+};
+
+inline void putU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)(value >> 8);
+}
+
+inline void putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+inline uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+inline uint32_t getU32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+uint16_t crc16(const uint8_t* data, int len);
+
+void encodeSessionHeader(const SessionInfo& info, uint8_t* block);
+
+// 数据块编码 (记录器和主机写文件共用): begin -> putSample x n -> seal -> finish
+// seal 只在采集端做 (常数时间之外只有填充)，CRC 留给 finish (记录器在写线程中计算)
+void beginDataBlock(uint8_t* block, uint32_t sessionId, uint32_t firstSample, uint32_t timestampMs);
+
+inline void putSample(uint8_t* block, int slot, int16_t x, int16_t y, int16_t z) {
+    uint8_t* column = &block[DATA_HEADER_SIZE + 2 * slot];
+    putU16(&column[0], (uint16_t)x);
+    putU16(&column[COLUMN_BYTES], (uint16_t)y);
+    putU16(&column[2 * COLUMN_BYTES], (uint16_t)z);
+}
+
+void sealDataBlock(uint8_t* block, int count);
+void finishDataBlock(uint8_t* block);
+
+// 解析一个块，返回 1 (会话块)、2 (数据块，CRC 正确)、0 (空块) 或 -1 (损坏)
+// 数据块的样本按 x/y/z 交错写入 xyz (至少 SAMPLES_PER_BLOCK * 3，为空时只解析块头)
+int decodeBlock(const uint8_t* block, SessionInfo* session, BlockInfo* info, int16_t* xyz);
+
+// 从数据块的列中直接读取样本 [start, start + count)，按 x/y/z 交错输出 (不检查 CRC)
+void readColumns(const uint8_t* block, int start, int count, int16_t* xyz);
+
+}  // namespace sessionfile
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef STAGE_TIMING_H
+#define STAGE_TIMING_H
+
+#include <stdint.h>
+
+// 流水线阶段计时: 每个阶段记录次数、最小/平均/最大耗时和 log2 直方图 (µs)
+// 记录端无锁: 每个阶段只由一个线程写入 (序列号保护)，读取端在任意线程取一致快照，
+// 写入端从不等待。由 config.h 的 STAGE_TIMING_ENABLED 在调用处整体去除
+//
+// BLE 诊断特征值 (小端):
+//   [0]     版本 (STATS_VERSION)
+//   [1]     阶段数 (NUM_STAGES，顺序同 Stage)
+//   [2]     直方图桶数 (HISTOGRAM_BUCKETS)
+//   [3]     保留 (0)
+//   [4..]   每个阶段 STAGE_RECORD_SIZE 字节:
+//           u32 次数, u32 最小, u32 平均, u32 最大 (µs), u16 × 桶数 各桶次数 (饱和)
+// 桶 0 为 < 8µs，桶 k 为 [2^(k+2), 2^(k+3)) µs，最后一个桶包含更长的耗时 (>= 131ms)
+#if defined(__arm__)
+#include "hal/ticker_api.h"
+#include "hal/us_ticker_api.h"
+#else
+#include <chrono>
+#endif
+
+namespace timing {
+
+enum Stage {
+    STAGE_CAPTURE,      // FIFO 状态读取 + 突发读取，直到传输完成中断 (I2C 停顿)
+    STAGE_CONVERT,      // 一批样本的字节序转换、压缩/记录和窗口组装
+    STAGE_FFT,          // 频谱计算 (FFT 或频带估计)
+    STAGE_DETECT,       // 检测判决 (含检测器调试日志写入)
+    STAGE_REPORT,       // 分析线程的逐窗口摘要日志 (写入令牌缓冲区)
+    STAGE_PUBLISH,      // BLE 线程: 发布策略、事件日志写入和 GATT 写入
+    NUM_STAGES
+};
+
+const uint8_t STATS_VERSION = 1;
+const int HISTOGRAM_BUCKETS = 16;
+const int HEADER_SIZE = 4;
+const int STAGE_RECORD_SIZE = 16 + 2 * HISTOGRAM_BUCKETS;
+const int ENCODED_SIZE = HEADER_SIZE + NUM_STAGES * STAGE_RECORD_SIZE;
+
+struct StageStats {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t histogram[HISTOGRAM_BUCKETS];
+};
+
+// 微秒时钟 (32 位，差值按无符号运算)
+// 板上为 us ticker: Stop 模式下停止，计时区间内须持有深度睡眠锁或不阻塞
+inline uint32_t now() {
+#if defined(__arm__)
+    return ticker_read(get_us_ticker_data());
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// 记录一次耗时 (每个阶段只能由同一个线程调用)
+void record(Stage stage, uint32_t us);
+
+// 一致快照 (任意线程); 写入频繁打断时返回 false
+bool getStats(Stage stage, StageStats* stats);
+
+// 清零所有阶段 (任意线程): 各阶段在下一次记录时由写入端清零，之前的读取返回空统计
+void reset();
+
+const char* stageName(Stage stage);
+int bucketOf(uint32_t us);
+uint32_t bucketLowerUs(int bucket);
+uint32_t meanUs(const StageStats& stats);
+
+// 编码全部阶段为 BLE 诊断特征值，返回字节数 (ENCODED_SIZE)
+int encodeStats(uint8_t* out);
+
+// 解码诊断特征值 (主机端)，返回阶段数; 格式错误返回 -1
+// 平均值写入 totalUs (= 平均 * 次数)，直方图为饱和后的值
+int decodeStats(const uint8_t* in, int len, StageStats* stats, int maxStages);
+
+}  // namespace timing
+
+#endif
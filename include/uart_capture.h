@@ -0,0 +1,77 @@
+#ifndef UART_CAPTURE_H
+#define UART_CAPTURE_H
+
+#include "session_format.h"
+#include <stdint.h>
+
+// 有线采集链路格式 (版本 1)，不依赖 mbed，主机端接收工具直接编译
+//
+// 每个包 COBS 编码后以 0x00 结尾，接收端在任意位置开始都能在下一个 0x00 处同步。解码后 (小端):
+//   [0]        包类型
+//   [1..n-3]   负载
+//   [n-2..n-1] CRC16 (CCITT-FALSE，同 session_format.h，覆盖类型和负载)
+//
+// 包类型:
+//   PACKET_SESSION    会话信息: u8 版本, u8 传感器 ID, u16 ODR (Hz), u16 量程 (g), u32 会话 ID,
+//                     u32 起始样本序号, u32 起始时间 (ms), u32 起始时间 (Unix 秒)，
+//                     启动时和之后每 SESSION_RESEND_PACKETS 个样本包发送一次 (接收端可以随时接入)
+//   PACKET_SAMPLES    原始样本: 一个原始数据流包 (raw_stream.h 格式，含第一个样本序号，可独立解码)
+//   PACKET_DETECTION  一条检测记录 (detection_frame.h 的 11 字节记录)
+//   PACKET_CONSOLE    控制台字节 (启动文本和令牌化日志帧，主机端经 log_decoder.h 还原)
+// 发送端缓冲区满时丢弃整包并计数; 接收端由样本序号和检测记录序号发现缺口
+namespace capture {
+
+const uint8_t LINK_VERSION = 1;
+
+const uint8_t PACKET_SESSION = 1;
+const uint8_t PACKET_SAMPLES = 2;
+const uint8_t PACKET_DETECTION = 3;
+const uint8_t PACKET_CONSOLE = 4;
+
+const int MAX_PAYLOAD = 248;
+const int MAX_PACKET_SIZE = MAX_PAYLOAD + 3;                            // 类型 + 负载 + CRC
+const int MAX_ENCODED_SIZE = MAX_PACKET_SIZE + MAX_PACKET_SIZE / 254 + 2; // COBS 开销 + 结尾 0x00
+const int SESSION_PAYLOAD_SIZE = 22;
+const int SESSION_RESEND_PACKETS = 64;
+
+// COBS 编码 (不含结尾的 0x00)，返回字节数 (最多 len + len / 254 + 1)
+int cobsEncode(const uint8_t* in, int len, uint8_t* out);
+
+// COBS 解码 (输入不含 0x00)，返回字节数; 格式错误返回 -1
+int cobsDecode(const uint8_t* in, int len, uint8_t* out);
+
+// 编码一个完整的包 (含结尾 0x00)，返回字节数 (不超过 MAX_ENCODED_SIZE); 负载过长返回 -1
+int encodePacket(uint8_t type, const uint8_t* payload, int len, uint8_t* out);
+
+// 会话信息负载 (SESSION_PAYLOAD_SIZE 字节)
+int encodeSession(const sessionfile::SessionInfo& info, uint8_t* out);
+bool decodeSession(const uint8_t* in, int len, sessionfile::SessionInfo* info);
+
+// 接收端: 逐字节送入串口数据，收到一个 CRC 正确的包时返回 true，
+// 之后直接读取类型和负载 (到下一次 feed 为止有效)
+class PacketReceiver {
+private:
+    uint8_t encoded[MAX_ENCODED_SIZE];
+    uint8_t packet[MAX_ENCODED_SIZE];     // 解码结果不超过编码长度
+    int length;
+    int packetLength;
+    bool overflow;              // 当前包超长，丢弃到下一个 0x00
+
+    uint32_t packets;
+    uint32_t badPackets;        // COBS/CRC 错误或超长
+
+public:
+    PacketReceiver();
+    bool feed(uint8_t byte);
+
+    uint8_t getType() { return packet[0]; }
+    const uint8_t* getPayload() { return packet + 1; }
+    int getPayloadLength() { return packetLength - 3; }
+
+    uint32_t getPackets() { return packets; }
+    uint32_t getBadPackets() { return badPackets; }
+};
+
+}  // namespace capture
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+// 工作窃取线程池 (主机回放工具用)
+// 每个工作线程有自己的任务双端队列: 自己从尾部取，空闲时从其他线程的头部窃取，
+// 长短不一的任务 (会话长度差异很大) 因此能自动均衡到所有核心
+// 任务在 run 之前提交，运行期间不再增加新任务
+class WorkStealingPool {
+public:
+    typedef std::function<void(int worker)> Task;
+
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    int nextQueue;                      // 提交时轮流分配
+    std::atomic<uint32_t> steals;
+    std::vector<uint32_t> tasksRun;     // 每个工作线程执行的任务数 (只由该线程写)
+
+    bool popLocal(int worker, Task* task);
+    bool steal(int worker, Task* task);
+    void workerLoop(int worker);
+
+public:
+    explicit WorkStealingPool(int workers);
+
+    void submit(Task task);
+    // 运行全部任务，返回时所有任务都已完成 (调用线程作为 0 号工作线程)
+    void run();
+
+    int getWorkerCount();
+    uint32_t getSteals();
+    uint32_t getTasksRun(int worker);
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "activity_stats.h"
+
+void WelfordAccumulator::reset() {
+    count = 0;
+    mean = 0;
+    m2 = 0;
+    smaSum = 0;
+}
+
+void WelfordAccumulator::add(float magnitude, float smaTerm) {
+    count++;
+    float delta = magnitude - mean;
+    mean += delta / count;
+    m2 += delta * (magnitude - mean);
+    smaSum += smaTerm;
+}
+
+void WelfordAccumulator::remove(float magnitude, float smaTerm) {
+    if (count <= 1) {
+        reset();
+        return;
+    }
+    // add 的逆运算
+    count--;
+    float delta = magnitude - mean;
+    mean -= delta / count;
+    m2 -= delta * (magnitude - mean);
+    if (m2 < 0) {
+        m2 = 0;
+    }
+    smaSum -= smaTerm;
+}
+
+ActivityStats WelfordAccumulator::stats() const {
+    ActivityStats result;
+    result.count = count;
+    result.mean = mean;
+    result.variance = (count > 0) ? m2 / count : 0.0f;
+    result.sma = (count > 0) ? smaSum / count : 0.0f;
+    return result;
+}
+
+ActivityTracker::ActivityTracker() {
+    reset();
+}
+
+void ActivityTracker::reset() {
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        magnitudeHistory[i] = 0;
+        smaHistory[i] = 0;
+    }
+    position = 0;
+    window.reset();
+    fresh.reset();
+    hop.reset();
+    lastHop = hop.stats();
+}
+
+void ActivityTracker::update(float magnitude, float smaTerm) {
+    if (window.count >= WINDOW_SIZE) {
+        window.remove(magnitudeHistory[position], smaHistory[position]);
+    }
+    window.add(magnitude, smaTerm);
+
+    magnitudeHistory[position] = magnitude;
+    smaHistory[position] = smaTerm;
+    position++;
+    if (position >= WINDOW_SIZE) {
+        position = 0;
+    }
+
+    // fresh 从样本 0 开始，每满 WINDOW_SIZE 个样本恰好覆盖当前窗口
+    fresh.add(magnitude, smaTerm);
+    if (fresh.count >= WINDOW_SIZE) {
+        window = fresh;
+        fresh.reset();
+    }
+
+    hop.add(magnitude, smaTerm);
+}
+
+void ActivityTracker::closeHop() {
+    lastHop = hop.stats();
+    hop.reset();
+}
+
+ActivitySnapshot ActivityTracker::getSnapshot() {
+    ActivitySnapshot snapshot;
+    snapshot.window = window.stats();
+    snapshot.hop = lastHop;
+    return snapshot;
+}
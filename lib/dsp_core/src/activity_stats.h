@@ -0,0 +1,53 @@
+#ifndef ACTIVITY_STATS_H
+#define ACTIVITY_STATS_H
+
+#include "config.h"
+
+// 一段样本的活动统计 (m/s²)
+struct ActivityStats {
+    int count;
+    float mean;         // 合成加速度均值
+    float variance;     // 合成加速度方差 (总体方差)
+    float sma;          // 信号幅值面积: 每样本 |ax| + |ay| + |az - g| 的均值
+};
+
+// 每次分析时的活动统计: 整个窗口，以及上次分析以来新增的样本 (一个步长)
+struct ActivitySnapshot {
+    ActivityStats window;
+    ActivityStats hop;
+};
+
+// Welford 在线均值/方差，支持移除样本 (用于滑动窗口)
+struct WelfordAccumulator {
+    int count;
+    float mean;
+    float m2;           // 与均值之差的平方和
+    float smaSum;
+
+    void reset();
+    void add(float magnitude, float smaTerm);
+    void remove(float magnitude, float smaTerm);
+    ActivityStats stats() const;
+};
+
+// 活动统计跟踪器: 随每个已读取的样本 O(1) 更新，不需要额外的总线读取
+class ActivityTracker {
+private:
+    float magnitudeHistory[WINDOW_SIZE];    // 最近 WINDOW_SIZE 个样本 (移除时使用)
+    float smaHistory[WINDOW_SIZE];
+    int position;                           // 下一个写入位置，也是窗口中最旧的样本
+
+    WelfordAccumulator window;              // 滑动窗口 (逐样本加入/移除)
+    WelfordAccumulator fresh;               // 每 WINDOW_SIZE 个样本替换 window，限制移除带来的舍入误差累积
+    WelfordAccumulator hop;                 // 当前步长
+    ActivityStats lastHop;                  // 最近一个完成的步长
+
+public:
+    ActivityTracker();
+    void update(float magnitude, float smaTerm);
+    void closeHop();                        // 窗口就绪时调用，结束当前步长
+    ActivitySnapshot getSnapshot();
+    void reset();
+};
+
+#endif
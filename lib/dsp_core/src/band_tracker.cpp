@@ -0,0 +1,119 @@
+#include "band_tracker.h"
+#include "dsp_tables.h"
+#include <cmath>
+
+BandTracker::BandTracker() {
+    reset();
+}
+
+void BandTracker::reset() {
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        history[i] = 0;
+    }
+    for (int b = 0; b < NUM_BINS; b++) {
+        sumReal[b] = 0;
+        sumImag[b] = 0;
+        freshReal[b] = 0;
+        freshImag[b] = 0;
+    }
+    position = 0;
+    sampleCount = 0;
+}
+
+void BandTracker::update(float sample) {
+    float delta = sample - history[position];
+    history[position] = sample;
+
+    // S_k += (x[n] - x[n-N]) * W^(k*n)，相位参考固定，无乘法递推
+    for (int b = 0; b < NUM_BINS; b++) {
+        int k = FIRST_BIN + b;
+        float wReal, wImag;
+        dsp::twiddleAt((k * position) % WINDOW_SIZE, &wReal, &wImag);
+
+        sumReal[b] += delta * wReal;
+        sumImag[b] += delta * wImag;
+        freshReal[b] += sample * wReal;
+        freshImag[b] += sample * wImag;
+    }
+
+    if (sampleCount < WINDOW_SIZE) {
+        sampleCount++;
+    }
+
+    position++;
+    if (position >= WINDOW_SIZE) {
+        position = 0;
+
+        // 块累加值恰好是最近 WINDOW_SIZE 个样本的 DFT，用它替换增量结果
+        for (int b = 0; b < NUM_BINS; b++) {
+            sumReal[b] = freshReal[b];
+            sumImag[b] = freshImag[b];
+            freshReal[b] = 0;
+            freshImag[b] = 0;
+        }
+    }
+}
+
+bool BandTracker::isReady() {
+    return sampleCount >= WINDOW_SIZE;
+}
+
+float BandTracker::windowedMagnitude(int index) {
+    // 汉宁窗的频域卷积: Xw[k] = 0.5 X[k] - 0.25 X[k-1] - 0.25 X[k+1]
+    // X[k] = W^(-k*n0) S_k，n0 为窗口起点，公共相位不影响幅值
+    float wReal, wImag;
+    dsp::twiddleAt(position, &wReal, &wImag);
+
+    // W^(n0) * S_(k-1)
+    float lowReal = wReal * sumReal[index - 1] - wImag * sumImag[index - 1];
+    float lowImag = wReal * sumImag[index - 1] + wImag * sumReal[index - 1];
+
+    // W^(-n0) * S_(k+1)
+    float highReal = wReal * sumReal[index + 1] + wImag * sumImag[index + 1];
+    float highImag = wReal * sumImag[index + 1] - wImag * sumReal[index + 1];
+
+    float xReal = 0.5f * sumReal[index] - 0.25f * (lowReal + highReal);
+    float xImag = 0.5f * sumImag[index] - 0.25f * (lowImag + highImag);
+
+    return sqrtf(xReal * xReal + xImag * xImag) / (WINDOW_SIZE / 2.0f);
+}
+
+float BandTracker::getMagnitude(int bin) {
+    if (bin < MIN_BIN || bin > MAX_BIN) {
+        return 0.0f;
+    }
+    return windowedMagnitude(bin - FIRST_BIN);
+}
+
+FrequencyPeak BandTracker::findPeak() {
+    return findPeakInBins(MIN_BIN, MAX_BIN);
+}
+
+FrequencyPeak BandTracker::findPeakInRange(float minFreq, float maxFreq) {
+    int minBin = (int)(minFreq * WINDOW_SIZE / SAMPLE_RATE);
+    int maxBin = (int)(maxFreq * WINDOW_SIZE / SAMPLE_RATE);
+
+    if (minBin < MIN_BIN) {
+        minBin = MIN_BIN;
+    }
+    if (maxBin > MAX_BIN) {
+        maxBin = MAX_BIN;
+    }
+    return findPeakInBins(minBin, maxBin);
+}
+
+FrequencyPeak BandTracker::findPeakInBins(int minBin, int maxBin) {
+    FrequencyPeak peak;
+    peak.magnitude = 0;
+    peak.frequency = 0;
+
+    for (int i = minBin; i <= maxBin; i++) {
+        float magnitude = windowedMagnitude(i - FIRST_BIN);
+        if (magnitude > peak.magnitude) {
+            peak.magnitude = magnitude;
+            peak.frequency = (float)i * SAMPLE_RATE / WINDOW_SIZE;
+        }
+    }
+
+    return peak;
+}
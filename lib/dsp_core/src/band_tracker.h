@@ -0,0 +1,46 @@
+#ifndef BAND_TRACKER_H
+#define BAND_TRACKER_H
+
+#include "config.h"
+#include "fft_processor.h"
+
+// 滑动 DFT 频带跟踪器
+// 跟踪与 FFTProcessor::findPeak 相同的 1-10Hz 频点 (外加汉宁窗需要的左右各一个)，
+// 主峰在频带外 (步态等) 时与 FFT 路径一样不判为震颤/运动障碍;
+// 每个样本 O(频点数) 更新，与 FFTProcessor 使用相同的频点划分和幅值归一化
+class BandTracker {
+public:
+    static constexpr int MIN_BIN = (int)(1.0f * WINDOW_SIZE / SAMPLE_RATE);
+    static constexpr int MAX_BIN = (int)(10.0f * WINDOW_SIZE / SAMPLE_RATE) - 1;
+    static constexpr int FIRST_BIN = MIN_BIN - 1;
+    static constexpr int NUM_BINS = MAX_BIN - MIN_BIN + 3;
+
+private:
+    float history[WINDOW_SIZE];   // 最近 WINDOW_SIZE 个样本
+    int position;                 // 下一个写入位置，也是窗口中最旧的样本
+    int sampleCount;
+
+    // 当前窗口的 DFT (以 position = 0 为相位参考)
+    float sumReal[NUM_BINS];
+    float sumImag[NUM_BINS];
+
+    // 按块重新累加的 DFT: 每 WINDOW_SIZE 个样本替换一次 sum，
+    // 防止增量更新的舍入误差无限累积
+    float freshReal[NUM_BINS];
+    float freshImag[NUM_BINS];
+
+    float windowedMagnitude(int index);
+    FrequencyPeak findPeakInBins(int minBin, int maxBin);
+
+public:
+    BandTracker();
+    void update(float sample);
+    bool isReady();
+    float getMagnitude(int bin);
+    // 跟踪范围内的主峰 (与 FFTProcessor::findPeak 相同)
+    FrequencyPeak findPeak();
+    FrequencyPeak findPeakInRange(float minFreq, float maxFreq);
+    void reset();
+};
+
+#endif
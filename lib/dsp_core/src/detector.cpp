@@ -0,0 +1,364 @@
+#include "detector.h"
+#include <cmath>
+
+// 逐窗口调试输出 (令牌化，经注入的日志输出)，回放等批处理场景下编译为空;
+// 级别低于 LOG_LEVEL 的消息连参数也不计算
+#if DETECTOR_VERBOSE
+#define DETECTOR_LOG(id, ...) \
+    do { if (tokenlog::isEnabled(tokenlog::id)) { log<tokenlog::id>(__VA_ARGS__); } } while (0)
+#else
+#define DETECTOR_LOG(id, ...) ((void)0)
+#endif
+
+// 阶段计时标记，发布版本编译为空
+#if STAGE_TIMING_ENABLED
+#define DETECTOR_MARK_SPECTRUM() markSpectrumDone()
+#else
+#define DETECTOR_MARK_SPECTRUM() ((void)0)
+#endif
+
+Detector::Detector() {
+    lastTremorIntensity = 0;
+    lastDyskinesiaIntensity = 0;
+    currentState = MOTION_IDLE;
+    lastMotionTime = 0;
+    walkingStartTime = 0;
+    bandNextSample = 0;
+    
+    clock = nullptr;
+    clockContext = nullptr;
+    logSink = nullptr;
+    logContext = nullptr;
+    spectrumMark = nullptr;
+    markContext = nullptr;
+}
+
+void Detector::setClock(DspClock source, void* context) {
+    clock = source;
+    clockContext = context;
+}
+
+void Detector::setLogSink(DspLogSink sink, void* context) {
+    logSink = sink;
+    logContext = context;
+}
+
+void Detector::setSpectrumMark(DspMark mark, void* context) {
+    spectrumMark = mark;
+    markContext = context;
+}
+
+uint32_t Detector::now() {
+    if (clock == nullptr) {
+        return 0;
+    }
+    return clock(clockContext);
+}
+
+void Detector::markSpectrumDone() {
+    if (spectrumMark != nullptr) {
+        spectrumMark(markContext);
+    }
+}
+
+static void clearAxisPeaks(DetectionResult* result) {
+    for (int a = 0; a < NUM_AXES; a++) {
+        result->axisPeaks[a].frequency = 0;
+        result->axisPeaks[a].magnitude = 0;
+    }
+    result->dominantAxis = -1;
+    result->sequence = 0;
+    result->timestampMs = 0;
+}
+
+DetectionResult Detector::analyze(sample_t* data, const ActivitySnapshot& activity) {
+    DetectionResult result;
+    clearAxisPeaks(&result);
+    
+    // FFT 分析
+    FrequencyPeak peak = fftProcessor.process(data);
+#if DETECTOR_WELCH
+    // 本窗口的频谱加入 Welch 平均，峰值取自平均谱
+    welch.beginSegment();
+    for (int k = 0; k < WelchPsd::NUM_BINS; k++) {
+        float magnitude = fftProcessor.getMagnitude(k);
+        welch.setPower(0, k, magnitude * magnitude);
+    }
+    welch.endSegment();
+    peak = welch.findPeakInRange(0, 1.0f, AXIS_MAX_FREQ);
+#endif
+    DETECTOR_MARK_SPECTRUM();
+    
+    DETECTOR_LOG(DETECTOR_PEAK, peak.frequency, peak.magnitude);
+    
+    // 检测震颤
+    result.tremorDetected = detectTremor(peak, &result.tremorIntensity);
+    if (result.tremorDetected) {
+        DETECTOR_LOG(DETECTOR_TREMOR);
+    }
+    
+    // 检测运动障碍
+    result.dyskinesiaDetected = detectDyskinesia(peak, &result.dyskinesiaIntensity);
+    if (result.dyskinesiaDetected) {
+        DETECTOR_LOG(DETECTOR_DYSKINESIA);
+    }
+    
+    // 更新运动状态
+    updateMotionState(activity);
+    
+    // 检测冻结步态
+    result.fogDetected = detectFOG();
+    result.motionState = currentState;
+    
+    return result;
+}
+
+#if TRI_AXIAL_ANALYSIS
+DetectionResult Detector::analyzeAxes(const float* x, const float* y, const float* z, const ActivitySnapshot& activity) {
+    DetectionResult result;
+    result.sequence = 0;
+    result.timestampMs = 0;
+    
+    // 三轴批处理 FFT
+#if DETECTOR_WELCH
+    // 各轴频谱加入 Welch 平均，各轴峰值取自平均谱
+    fftProcessor.computeAxes(x, y, z);
+    welch.beginSegment();
+    for (int a = 0; a < NUM_AXES; a++) {
+        welch.setPowers(a, fftProcessor.getAxisPowers(a), FFTProcessor::POWER_SCALE);
+    }
+    welch.endSegment();
+    for (int a = 0; a < NUM_AXES; a++) {
+        result.axisPeaks[a] = welch.findPeakInRange(a, 1.0f, AXIS_MAX_FREQ);
+    }
+#else
+    fftProcessor.processAxes(x, y, z, result.axisPeaks);
+#endif
+    DETECTOR_MARK_SPECTRUM();
+    
+    // 主轴: 峰值幅值最大的轴 (静止性震颤通常沿单一方向)
+    result.dominantAxis = 0;
+    for (int a = 1; a < NUM_AXES; a++) {
+        if (result.axisPeaks[a].magnitude > result.axisPeaks[result.dominantAxis].magnitude) {
+            result.dominantAxis = a;
+        }
+    }
+    FrequencyPeak peak = result.axisPeaks[result.dominantAxis];
+    
+    DETECTOR_LOG(DETECTOR_AXIS_PEAK, peak.frequency, peak.magnitude, "XYZ"[result.dominantAxis]);
+    
+    // 检测震颤
+    result.tremorDetected = detectTremor(peak, &result.tremorIntensity);
+    if (result.tremorDetected) {
+        DETECTOR_LOG(DETECTOR_TREMOR);
+    }
+    
+    // 检测运动障碍
+    result.dyskinesiaDetected = detectDyskinesia(peak, &result.dyskinesiaIntensity);
+    if (result.dyskinesiaDetected) {
+        DETECTOR_LOG(DETECTOR_DYSKINESIA);
+    }
+    
+    // 更新运动状态
+    updateMotionState(activity);
+    
+    // 检测冻结步态
+    result.fogDetected = detectFOG();
+    result.motionState = currentState;
+    
+    return result;
+}
+#endif
+
+bool Detector::updateBands(float sample) {
+    // 每个样本 O(频点数) 更新频带估计; analyzeWindow 在分析时把窗口中的新样本 (每个步长 HOP_SIZE 个) 成批送入
+    bandTracker.update(sample);
+    return bandTracker.isReady();
+}
+
+DetectionResult Detector::analyzeBands(const ActivitySnapshot& activity) {
+    DetectionResult result;
+    clearAxisPeaks(&result);
+    
+    // 每个窗口判定一次 (平滑系数按窗口调定，与 FFT 路径相同); 跟踪器未满一个窗口时不判定。
+    // 与 FFT 路径一样取 1-10Hz 的主峰再分类，频带外的强分量 (步态) 不会让频带内的谐波被判为震颤
+    FrequencyPeak peak;
+    peak.frequency = 0;
+    peak.magnitude = 0;
+    if (bandTracker.isReady()) {
+        peak = bandTracker.findPeak();
+    }
+    result.tremorDetected = detectTremor(peak, &result.tremorIntensity);
+    result.dyskinesiaDetected = detectDyskinesia(peak, &result.dyskinesiaIntensity);
+    
+    if (result.tremorDetected) {
+        DETECTOR_LOG(DETECTOR_TREMOR);
+    }
+    if (result.dyskinesiaDetected) {
+        DETECTOR_LOG(DETECTOR_DYSKINESIA);
+    }
+    
+    // 更新运动状态
+    updateMotionState(activity);
+    
+    // 检测冻结步态
+    result.fogDetected = detectFOG();
+    result.motionState = currentState;
+    
+    return result;
+}
+
+DetectionResult Detector::analyzeWindow(const AnalysisWindow& window) {
+    DetectionResult result;
+#if DETECTOR_USE_BAND_TRACKER
+    // 重叠窗口: 只把上次之后的新样本送入逐样本频带估计 (丢弃的窗口超过一个窗口长度时从本窗口开头继续)
+    uint32_t start = window.firstSample;
+    if (bandNextSample > start) {
+        start = bandNextSample;
+    }
+    for (uint32_t n = start; n < window.firstSample + WINDOW_SIZE; n++) {
+#if DSP_FIXED_POINT
+        updateBands(window.samples[n - window.firstSample] * ACC_LSB_TO_MS2);
+#else
+        updateBands(window.samples[n - window.firstSample]);
+#endif
+    }
+    bandNextSample = window.firstSample + WINDOW_SIZE;
+    DETECTOR_MARK_SPECTRUM();
+    result = analyzeBands(window.activity);
+#elif TRI_AXIAL_ANALYSIS
+    result = analyzeAxes(window.axes[0], window.axes[1], window.axes[2], window.activity);
+#else
+    // FFT 只读取窗口数据，去掉 const 不会修改调用者的缓冲区
+    result = analyze((sample_t*)window.samples, window.activity);
+#endif
+    
+    result.sequence = window.sequence;
+    result.timestampMs = (uint32_t)((uint64_t)(window.firstSample + WINDOW_SIZE - 1) * 1000 / SAMPLE_RATE);
+    return result;
+}
+
+bool Detector::detectTremor(FrequencyPeak peak, float* intensity) {
+#if DETECTOR_WELCH
+    // 平均谱的方差已经足够低，峰值直接作为强度，不再逐窗口平滑和衰减
+    lastTremorIntensity = 0;
+    if (peak.frequency >= TREMOR_FREQ_MIN && peak.frequency <= TREMOR_FREQ_MAX) {
+        lastTremorIntensity = peak.magnitude;
+    }
+    *intensity = lastTremorIntensity;
+    return lastTremorIntensity > TREMOR_THRESHOLD;
+#else
+    if (peak.frequency >= TREMOR_FREQ_MIN && peak.frequency <= TREMOR_FREQ_MAX) {
+        *intensity = peak.magnitude;
+        lastTremorIntensity = 0.7f * peak.magnitude + 0.3f * lastTremorIntensity;
+        
+        if (lastTremorIntensity > TREMOR_THRESHOLD) {
+            return true;
+        }
+    } else {
+        lastTremorIntensity *= 0.8f;
+    }
+    
+    *intensity = lastTremorIntensity;
+    return false;
+#endif
+}
+
+bool Detector::detectDyskinesia(FrequencyPeak peak, float* intensity) {
+#if DETECTOR_WELCH
+    lastDyskinesiaIntensity = 0;
+    if (peak.frequency >= DYSKINESIA_FREQ_MIN && peak.frequency <= DYSKINESIA_FREQ_MAX) {
+        lastDyskinesiaIntensity = peak.magnitude;
+    }
+    *intensity = lastDyskinesiaIntensity;
+    return lastDyskinesiaIntensity > DYSKINESIA_THRESHOLD;
+#else
+    if (peak.frequency >= DYSKINESIA_FREQ_MIN && peak.frequency <= DYSKINESIA_FREQ_MAX) {
+        *intensity = peak.magnitude;
+        lastDyskinesiaIntensity = 0.7f * peak.magnitude + 0.3f * lastDyskinesiaIntensity;
+        
+        if (lastDyskinesiaIntensity > DYSKINESIA_THRESHOLD) {
+            return true;
+        }
+    } else {
+        lastDyskinesiaIntensity *= 0.8f;
+    }
+    
+    *intensity = lastDyskinesiaIntensity;
+    return false;
+#endif
+}
+
+void Detector::updateMotionState(const ActivitySnapshot& activity) {
+    // 上次分析以来新增样本 (一个步长) 的合成加速度标准差
+    float stdDev = sqrtf(activity.hop.variance);
+    uint32_t currentTime = now();
+
+    // 调试信息: 使用标准差判断是否在运动
+    // 标准差大 = 运动值波动大 = 走路
+    // 标准差小 = 运动值稳定 = 静止
+    DETECTOR_LOG(DETECTOR_MOTION, activity.hop.mean, stdDev, activity.hop.sma,
+           activity.window.mean, sqrtf(activity.window.variance), activity.window.sma);
+
+    // 使用标准差阈值判断是否在运动
+    bool isMoving = (stdDev > MOTION_THRESHOLD);
+
+    switch (currentState) {
+        case MOTION_IDLE:
+            if (isMoving) {
+                currentState = MOTION_WALKING;
+                walkingStartTime = currentTime;
+                lastMotionTime = currentTime;
+                DETECTOR_LOG(DETECTOR_IDLE_TO_WALKING, stdDev);
+            }
+            break;
+
+        case MOTION_WALKING:
+            if (isMoving) {
+                lastMotionTime = currentTime;
+                DETECTOR_LOG(DETECTOR_STILL_WALKING, currentTime - walkingStartTime, stdDev);
+            } else {
+                uint32_t stopTime = currentTime - lastMotionTime;
+                uint32_t walkTime = currentTime - walkingStartTime;
+                DETECTOR_LOG(DETECTOR_STOPPED, stopTime, walkTime, stdDev);
+
+                if (stopTime > FREEZE_TIME_MS) {
+                    if (walkTime > 3000) {
+                        currentState = MOTION_FROZEN;
+                        DETECTOR_LOG(DETECTOR_WALKING_TO_FROZEN);
+                    } else {
+                        currentState = MOTION_IDLE;
+                        DETECTOR_LOG(DETECTOR_WALKING_TO_IDLE);
+                    }
+                }
+            }
+            break;
+
+        case MOTION_FROZEN:
+            if (isMoving) {
+                currentState = MOTION_WALKING;
+                walkingStartTime = currentTime;
+                lastMotionTime = currentTime;
+                DETECTOR_LOG(DETECTOR_FROZEN_TO_WALKING, stdDev);
+            }
+            break;
+    }
+}
+
+bool Detector::detectFOG() {
+    return (currentState == MOTION_FROZEN);
+}
+
+void Detector::reset() {
+    lastTremorIntensity = 0;
+    lastDyskinesiaIntensity = 0;
+    currentState = MOTION_IDLE;
+    lastMotionTime = 0;
+    walkingStartTime = 0;
+    
+    bandTracker.reset();
+#if DETECTOR_WELCH
+    welch.reset();
+#endif
+    bandNextSample = 0;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include "config.h"
+#include "dsp_platform.h"
+#include "fft_processor.h"
+#include "fixed_fft.h"
+#include "band_tracker.h"
+#include "welch_psd.h"
+#include "activity_stats.h"
+#include "window_queue.h"
+#include "tokenlog.h"
+
+#if TRI_AXIAL_ANALYSIS && DSP_FIXED_POINT
+#error "TRI_AXIAL_ANALYSIS 需要浮点流水线 (DSP_FIXED_POINT 0)"
+#endif
+
+// Welch 平均只用于逐窗口 FFT 分析 (频带估计模式不做 FFT)
+#define DETECTOR_WELCH (DETECTOR_WELCH_SEGMENTS > 1 && !DETECTOR_USE_BAND_TRACKER)
+
+enum MotionState {
+    MOTION_IDLE,
+    MOTION_WALKING,
+    MOTION_FROZEN
+};
+
+struct DetectionResult {
+    bool tremorDetected;
+    float tremorIntensity;
+    
+    bool dyskinesiaDetected;
+    float dyskinesiaIntensity;
+    
+    bool fogDetected;
+    MotionState motionState;
+    
+    // 三轴分析: 各轴 1-10Hz 峰值，以及用于检测的主轴 (-1 表示合成幅值分析)
+    FrequencyPeak axisPeaks[NUM_AXES];
+    int dominantAxis;
+    
+    // 对应的窗口 (analyzeWindow 填写): 窗口序号，窗口最后一个样本自开始采样起的时间 (ms)
+    uint32_t sequence;
+    uint32_t timestampMs;
+};
+
+class Detector {
+private:
+#if DSP_FIXED_POINT
+    FixedFFTProcessor fftProcessor;
+#else
+    FFTProcessor fftProcessor;
+#endif
+    BandTracker bandTracker;
+#if DETECTOR_WELCH
+    WelchPsd welch;              // 最近几个窗口的平均功率谱，震颤/运动障碍峰值取自平均谱
+#endif
+    
+    float lastTremorIntensity;
+    float lastDyskinesiaIntensity;
+    
+    MotionState currentState;
+    // FOG 计时用的毫秒时钟 (未设置时时间不前进，FOG 不会触发) 和调试日志输出 (未设置时不输出)
+    DspClock clock;
+    void* clockContext;
+    DspLogSink logSink;
+    void* logContext;
+    DspMark spectrumMark;        // 阶段计时 (未设置或 STAGE_TIMING_ENABLED 为 0 时不调用)
+    void* markContext;
+    uint32_t lastMotionTime;
+    uint32_t walkingStartTime;
+    uint32_t bandNextSample;     // 频带估计下一个要送入的样本序号 (重叠窗口只送新样本)
+    
+    bool detectTremor(FrequencyPeak peak, float* intensity);
+    bool detectDyskinesia(FrequencyPeak peak, float* intensity);
+    bool detectFOG();
+    void updateMotionState(const ActivitySnapshot& activity);
+    uint32_t now();
+    // 打包参数交给日志输出; 低于 LOG_LEVEL 的消息编译为空
+    template <tokenlog::MessageId Id, typename... Args>
+    void log(Args... args) {
+        static_assert(sizeof...(Args) == tokenlog::argCountOf(Id), "参数个数与 log_messages.h 不符");
+        if (!tokenlog::isEnabled(Id) || logSink == nullptr) {
+            return;
+        }
+        const uint32_t words[sizeof...(Args) + 1] = {tokenlog::toWord(args)...};
+        logSink(logContext, Id, words, (int)sizeof...(Args));
+    }
+    void markSpectrumDone();
+    
+public:
+    Detector();
+    void setClock(DspClock source, void* context);
+    void setLogSink(DspLogSink sink, void* context);
+    void setSpectrumMark(DspMark mark, void* context);
+    
+    // 分析一个窗口: 按编译配置选择频带估计/三轴/合成幅值分析，并填写窗口序号和时间戳
+    DetectionResult analyzeWindow(const AnalysisWindow& window);
+    DetectionResult analyze(sample_t* data, const ActivitySnapshot& activity);
+#if TRI_AXIAL_ANALYSIS
+    DetectionResult analyzeAxes(const float* x, const float* y, const float* z, const ActivitySnapshot& activity);
+#endif
+    // 频带估计: 逐样本更新 (跟踪器已满一个窗口时返回 true)，每个窗口在 analyzeBands 中判定一次
+    bool updateBands(float sample);
+    DetectionResult analyzeBands(const ActivitySnapshot& activity);
+    void reset();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef DSP_PLATFORM_H
+#define DSP_PLATFORM_H
+
+#include <stdint.h>
+
+// DSP 核心与平台之间的接口: 核心不依赖 RTOS/HAL，时间和日志输出由调用者注入
+// 板上使用 LowPowerTimer 和令牌化日志缓冲区，主机回放/测试使用样本时钟 (或不输出日志)
+
+// 毫秒时钟
+typedef uint32_t (*DspClock)(void* context);
+
+// 日志输出: 消息编号 (tokenlog::MessageId) 和原始 32 位参数，不在调用处格式化
+typedef void (*DspLogSink)(void* context, uint16_t id, const uint32_t* args, int count);
+
+// 阶段标记: 分析中频谱计算 (FFT/频带估计) 完成时调用，调用者据此区分频谱和检测判决的耗时
+typedef void (*DspMark)(void* context);
+
+#endif
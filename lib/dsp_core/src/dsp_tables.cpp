@@ -0,0 +1,11 @@
+#include "dsp_tables.h"
+
+namespace dsp {
+
+// constexpr 保证常量初始化，表直接存放在 Flash 中
+constexpr HannWindowTable HANN_WINDOW;
+constexpr TwiddleTable TWIDDLE;
+constexpr HannWindowQ15Table HANN_WINDOW_Q15;
+constexpr TwiddleQ15Table TWIDDLE_Q15;
+
+}  // namespace dsp
@@ -0,0 +1,108 @@
+#ifndef DSP_TABLES_H
+#define DSP_TABLES_H
+
+#include "config.h"
+#include <stdint.h>
+
+// 编译期生成的 DSP 查找表 (汉宁窗 / FFT 旋转因子)
+// 表在编译期计算并放入 Flash (.rodata)，运行时不再调用 sinf/cosf
+
+namespace dsp {
+
+constexpr double PI_D = 3.14159265358979323846;
+
+// 将角度归约到 [-π, π]
+constexpr double reduceAngle(double x) {
+    while (x > PI_D) x -= 2.0 * PI_D;
+    while (x < -PI_D) x += 2.0 * PI_D;
+    return x;
+}
+
+// constexpr 正弦 (泰勒级数, |x| <= π 时误差 < 1e-12)
+constexpr double constSin(double x) {
+    x = reduceAngle(x);
+    double term = x;
+    double sum = x;
+    for (int i = 1; i < 14; i++) {
+        term *= -x * x / ((2.0 * i) * (2.0 * i + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constCos(double x) {
+    return constSin(x + PI_D / 2.0);
+}
+
+// 汉宁窗: w[i] = 0.5 * (1 - cos(2πi / (N-1)))
+struct HannWindowTable {
+    float value[WINDOW_SIZE];
+
+    constexpr HannWindowTable() : value() {
+        for (int i = 0; i < WINDOW_SIZE; i++) {
+            value[i] = (float)(0.5 * (1.0 - constCos(2.0 * PI_D * i / (WINDOW_SIZE - 1))));
+        }
+    }
+};
+
+// 旋转因子: W[k] = exp(-j2πk/N), k = 0 .. N/2-1
+// 长度为 len 的蝶形级使用步长 N/len 访问
+struct TwiddleTable {
+    float real[WINDOW_SIZE / 2];
+    float imag[WINDOW_SIZE / 2];
+
+    constexpr TwiddleTable() : real(), imag() {
+        for (int k = 0; k < WINDOW_SIZE / 2; k++) {
+            real[k] = (float)constCos(2.0 * PI_D * k / WINDOW_SIZE);
+            imag[k] = (float)-constSin(2.0 * PI_D * k / WINDOW_SIZE);
+        }
+    }
+};
+
+// 浮点值转 Q15 (四舍五入)
+constexpr int16_t toQ15(double v) {
+    return (int16_t)(v >= 0 ? v * 32767.0 + 0.5 : v * 32767.0 - 0.5);
+}
+
+// Q15 汉宁窗 (定点流水线)
+struct HannWindowQ15Table {
+    int16_t value[WINDOW_SIZE];
+
+    constexpr HannWindowQ15Table() : value() {
+        for (int i = 0; i < WINDOW_SIZE; i++) {
+            value[i] = toQ15(0.5 * (1.0 - constCos(2.0 * PI_D * i / (WINDOW_SIZE - 1))));
+        }
+    }
+};
+
+// Q15 旋转因子，re/im 交错存放，每个复数可作为一个 32 位字读取 (低半字 re, 高半字 im)
+struct TwiddleQ15Table {
+    int16_t value[WINDOW_SIZE];
+
+    constexpr TwiddleQ15Table() : value() {
+        for (int k = 0; k < WINDOW_SIZE / 2; k++) {
+            value[2 * k] = toQ15(constCos(2.0 * PI_D * k / WINDOW_SIZE));
+            value[2 * k + 1] = toQ15(-constSin(2.0 * PI_D * k / WINDOW_SIZE));
+        }
+    }
+};
+
+extern const HannWindowTable HANN_WINDOW;
+extern const TwiddleTable TWIDDLE;
+extern const HannWindowQ15Table HANN_WINDOW_Q15;
+extern const TwiddleQ15Table TWIDDLE_Q15;
+
+// 整圆旋转因子 W^m (m = 0 .. N-1)，后半圆利用 W^(m+N/2) = -W^m
+inline void twiddleAt(int m, float* real, float* imag) {
+    if (m < WINDOW_SIZE / 2) {
+        *real = TWIDDLE.real[m];
+        *imag = TWIDDLE.imag[m];
+    } else {
+        *real = -TWIDDLE.real[m - WINDOW_SIZE / 2];
+        *imag = -TWIDDLE.imag[m - WINDOW_SIZE / 2];
+    }
+}
+
+}  // namespace dsp
+
+#endif
@@ -0,0 +1,359 @@
+#include "fft_processor.h"
+#include "dsp_tables.h"
+
+FFTProcessor::FFTProcessor() {
+    // 初始化数组
+    for (int i = 0; i < FFT_BUFFER_SIZE; i++) {
+        realData[i] = 0;
+        imagData[i] = 0;
+    }
+    for (int i = 0; i < WINDOW_SIZE / 2; i++) {
+        magnitudes[i] = 0;
+    }
+#if TRI_AXIAL_ANALYSIS
+    for (int a = 0; a < NUM_AXES; a++) {
+        for (int i = 0; i < FFT_BUFFER_SIZE; i++) {
+            axisReal[a][i] = 0;
+            axisImag[a][i] = 0;
+        }
+        for (int i = 0; i < AXIS_NUM_BINS; i++) {
+            axisPowers[a][i] = 0;
+        }
+    }
+#endif
+}
+
+void FFTProcessor::bitReverse(float* real, float* imag, int n) {
+    int j = 0;
+    for (int i = 0; i < n - 1; i++) {
+        if (i < j) {
+            // 交换 real[i] 和 real[j]
+            float temp = real[i];
+            real[i] = real[j];
+            real[j] = temp;
+            
+            // 交换 imag[i] 和 imag[j]
+            temp = imag[i];
+            imag[i] = imag[j];
+            imag[j] = temp;
+        }
+        
+        int k = n / 2;
+        while (k <= j) {
+            j -= k;
+            k /= 2;
+        }
+        j += k;
+    }
+}
+
+void FFTProcessor::fft(float* real, float* imag, int n) {
+    // Cooley-Tukey FFT 算法
+    bitReverse(real, imag, n);
+    
+    // FFT 计算 (旋转因子查表，避免逐级 sinf/cosf 和递推误差累积)
+    for (int len = 2; len <= n; len *= 2) {
+        int half = len / 2;
+        int step = WINDOW_SIZE / len;
+        
+        for (int j = 0; j < half; j++) {
+            float wReal = dsp::TWIDDLE.real[j * step];
+            float wImag = dsp::TWIDDLE.imag[j * step];
+            
+            for (int i = 0; i < n; i += len) {
+                float uReal = real[i + j];
+                float uImag = imag[i + j];
+                
+                float vReal = real[i + j + half];
+                float vImag = imag[i + j + half];
+                
+                float tReal = wReal * vReal - wImag * vImag;
+                float tImag = wReal * vImag + wImag * vReal;
+                
+                real[i + j] = uReal + tReal;
+                imag[i + j] = uImag + tImag;
+                
+                real[i + j + half] = uReal - tReal;
+                imag[i + j + half] = uImag - tImag;
+            }
+        }
+    }
+}
+
+#if FFT_REAL_INPUT
+void FFTProcessor::loadWindow(const float* data) {
+    const int half = WINDOW_SIZE / 2;
+    
+    // 偶数样本放实部、奇数样本放虚部，并应用汉宁窗 (查表)
+    for (int i = 0; i < half; i++) {
+        realData[i] = data[2 * i] * dsp::HANN_WINDOW.value[2 * i];
+        imagData[i] = data[2 * i + 1] * dsp::HANN_WINDOW.value[2 * i + 1];
+    }
+}
+
+void FFTProcessor::transform() {
+    // N/2 点复数 FFT
+    fft(realData, imagData, WINDOW_SIZE / 2);
+}
+
+void FFTProcessor::computeSpectrum() {
+    const int half = WINDOW_SIZE / 2;
+    
+    // 拆分: X[k] = Fe[k] + W^k * Fo[k]
+    // Fe[k] = (Z[k] + conj(Z[N/2-k])) / 2, Fo[k] = -j(Z[k] - conj(Z[N/2-k])) / 2
+    for (int k = 0; k < half; k++) {
+        int m = (half - k) % half;
+        
+        float feReal = 0.5f * (realData[k] + realData[m]);
+        float feImag = 0.5f * (imagData[k] - imagData[m]);
+        float foReal = 0.5f * (imagData[k] + imagData[m]);
+        float foImag = -0.5f * (realData[k] - realData[m]);
+        
+        float wReal = dsp::TWIDDLE.real[k];
+        float wImag = dsp::TWIDDLE.imag[k];
+        
+        float xReal = feReal + wReal * foReal - wImag * foImag;
+        float xImag = feImag + wReal * foImag + wImag * foReal;
+        
+        magnitudes[k] = sqrtf(xReal * xReal + xImag * xImag) / (WINDOW_SIZE / 2.0f);
+    }
+}
+#else
+void FFTProcessor::loadWindow(const float* data) {
+    // 复制数据并应用汉宁窗 (查表)
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        realData[i] = data[i] * dsp::HANN_WINDOW.value[i];
+        imagData[i] = 0;
+    }
+}
+
+void FFTProcessor::transform() {
+    fft(realData, imagData, WINDOW_SIZE);
+}
+
+void FFTProcessor::computeSpectrum() {
+    // 计算幅值
+    for (int i = 0; i < WINDOW_SIZE / 2; i++) {
+        magnitudes[i] = sqrtf(realData[i] * realData[i] + imagData[i] * imagData[i]) / (WINDOW_SIZE / 2.0f);
+    }
+}
+#endif
+
+FrequencyPeak FFTProcessor::findPeak() {
+    // 找出最大峰值 (1-10Hz 范围)
+    int minBin = (int)(1.0f * WINDOW_SIZE / SAMPLE_RATE);
+    int maxBin = (int)(10.0f * WINDOW_SIZE / SAMPLE_RATE);
+    
+    FrequencyPeak peak;
+    peak.magnitude = 0;
+    peak.frequency = 0;
+    
+    for (int i = minBin; i < maxBin && i < WINDOW_SIZE / 2; i++) {
+        if (magnitudes[i] > peak.magnitude) {
+            peak.magnitude = magnitudes[i];
+            peak.frequency = (float)i * SAMPLE_RATE / WINDOW_SIZE;
+        }
+    }
+    
+    return peak;
+}
+
+FrequencyPeak FFTProcessor::process(float* data) {
+    loadWindow(data);
+    transform();
+    computeSpectrum();
+    return findPeak();
+}
+
+FrequencyPeak FFTProcessor::findPeakInRange(float minFreq, float maxFreq) {
+    int minBin = (int)(minFreq * WINDOW_SIZE / SAMPLE_RATE);
+    int maxBin = (int)(maxFreq * WINDOW_SIZE / SAMPLE_RATE);
+    
+    FrequencyPeak peak;
+    peak.magnitude = 0;
+    peak.frequency = 0;
+    
+    for (int i = minBin; i <= maxBin && i < WINDOW_SIZE / 2; i++) {
+        if (magnitudes[i] > peak.magnitude) {
+            peak.magnitude = magnitudes[i];
+            peak.frequency = (float)i * SAMPLE_RATE / WINDOW_SIZE;
+        }
+    }
+    
+    return peak;
+}
+
+float FFTProcessor::getMagnitude(int bin) {
+    if (bin < 0 || bin >= WINDOW_SIZE / 2) {
+        return 0.0f;
+    }
+    return magnitudes[bin];
+}
+
+#if TRI_AXIAL_ANALYSIS
+void FFTProcessor::fftAxes(int n) {
+    // 位反转: 下标只计算一次，三轴同时交换
+    int j = 0;
+    for (int i = 0; i < n - 1; i++) {
+        if (i < j) {
+            for (int a = 0; a < NUM_AXES; a++) {
+                float temp = axisReal[a][i];
+                axisReal[a][i] = axisReal[a][j];
+                axisReal[a][j] = temp;
+                
+                temp = axisImag[a][i];
+                axisImag[a][i] = axisImag[a][j];
+                axisImag[a][j] = temp;
+            }
+        }
+        
+        int k = n / 2;
+        while (k <= j) {
+            j -= k;
+            k /= 2;
+        }
+        j += k;
+    }
+    
+    // 蝶形运算: 每个旋转因子只读取一次，作用于三轴
+    for (int len = 2; len <= n; len *= 2) {
+        int half = len / 2;
+        int step = WINDOW_SIZE / len;
+        
+        for (int m = 0; m < half; m++) {
+            float wReal = dsp::TWIDDLE.real[m * step];
+            float wImag = dsp::TWIDDLE.imag[m * step];
+            
+            for (int i = 0; i < n; i += len) {
+                int p = i + m;
+                int q = p + half;
+                
+                for (int a = 0; a < NUM_AXES; a++) {
+                    float* real = axisReal[a];
+                    float* imag = axisImag[a];
+                    
+                    float tReal = wReal * real[q] - wImag * imag[q];
+                    float tImag = wReal * imag[q] + wImag * real[q];
+                    
+                    float uReal = real[p];
+                    float uImag = imag[p];
+                    
+                    real[p] = uReal + tReal;
+                    imag[p] = uImag + tImag;
+                    real[q] = uReal - tReal;
+                    imag[q] = uImag - tImag;
+                }
+            }
+        }
+    }
+}
+
+void FFTProcessor::processAxes(const float* x, const float* y, const float* z, FrequencyPeak* peaks) {
+    computeAxes(x, y, z);
+    
+    // 各轴最大峰值 (1-10Hz 范围)
+    for (int a = 0; a < NUM_AXES; a++) {
+        peaks[a] = findAxisPeakInRange(a, 1.0f, AXIS_MAX_FREQ);
+    }
+}
+
+void FFTProcessor::computeAxes(const float* x, const float* y, const float* z) {
+    const float* axes[NUM_AXES] = {x, y, z};
+    
+    // 去除各轴均值 (重力分量随姿态变化，不能只减 z 轴)
+    float mean[NUM_AXES];
+    for (int a = 0; a < NUM_AXES; a++) {
+        float sum = 0;
+        for (int i = 0; i < WINDOW_SIZE; i++) {
+            sum += axes[a][i];
+        }
+        mean[a] = sum / WINDOW_SIZE;
+    }
+    
+#if FFT_REAL_INPUT
+    const int half = WINDOW_SIZE / 2;
+    
+    // 汉宁窗系数只查一次，偶/奇样本打包为实部/虚部
+    for (int i = 0; i < half; i++) {
+        float wEven = dsp::HANN_WINDOW.value[2 * i];
+        float wOdd = dsp::HANN_WINDOW.value[2 * i + 1];
+        for (int a = 0; a < NUM_AXES; a++) {
+            axisReal[a][i] = (axes[a][2 * i] - mean[a]) * wEven;
+            axisImag[a][i] = (axes[a][2 * i + 1] - mean[a]) * wOdd;
+        }
+    }
+    
+    fftAxes(half);
+    
+    // 拆分 (同 computeSpectrum)，只计算 0 .. AXIS_MAX_FREQ 的频点
+    for (int k = 0; k < AXIS_NUM_BINS; k++) {
+        int m = (half - k) % half;
+        float wReal = dsp::TWIDDLE.real[k];
+        float wImag = dsp::TWIDDLE.imag[k];
+        
+        for (int a = 0; a < NUM_AXES; a++) {
+            const float* real = axisReal[a];
+            const float* imag = axisImag[a];
+            
+            float feReal = 0.5f * (real[k] + real[m]);
+            float feImag = 0.5f * (imag[k] - imag[m]);
+            float foReal = 0.5f * (imag[k] + imag[m]);
+            float foImag = -0.5f * (real[k] - real[m]);
+            
+            float xReal = feReal + wReal * foReal - wImag * foImag;
+            float xImag = feImag + wReal * foImag + wImag * foReal;
+            
+            axisPowers[a][k] = xReal * xReal + xImag * xImag;
+        }
+    }
+#else
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        float w = dsp::HANN_WINDOW.value[i];
+        for (int a = 0; a < NUM_AXES; a++) {
+            axisReal[a][i] = (axes[a][i] - mean[a]) * w;
+            axisImag[a][i] = 0;
+        }
+    }
+    
+    fftAxes(WINDOW_SIZE);
+    
+    for (int a = 0; a < NUM_AXES; a++) {
+        for (int i = 0; i < AXIS_NUM_BINS; i++) {
+            axisPowers[a][i] = axisReal[a][i] * axisReal[a][i] + axisImag[a][i] * axisImag[a][i];
+        }
+    }
+#endif
+}
+
+FrequencyPeak FFTProcessor::findAxisPeakInRange(int axis, float minFreq, float maxFreq) {
+    int minBin = (int)(minFreq * WINDOW_SIZE / SAMPLE_RATE);
+    int maxBin = (int)(maxFreq * WINDOW_SIZE / SAMPLE_RATE);
+    
+    // 比较功率，只对峰值开方
+    int peakBin = -1;
+    float peakPower = 0;
+    for (int i = minBin; i <= maxBin && i < AXIS_NUM_BINS; i++) {
+        if (axisPowers[axis][i] > peakPower) {
+            peakPower = axisPowers[axis][i];
+            peakBin = i;
+        }
+    }
+    
+    FrequencyPeak peak;
+    peak.magnitude = 0;
+    peak.frequency = 0;
+    if (peakBin >= 0) {
+        peak.magnitude = sqrtf(peakPower) / (WINDOW_SIZE / 2.0f);
+        peak.frequency = (float)peakBin * SAMPLE_RATE / WINDOW_SIZE;
+    }
+    
+    return peak;
+}
+
+float FFTProcessor::getAxisMagnitude(int axis, int bin) {
+    if (axis < 0 || axis >= NUM_AXES || bin < 0 || bin >= AXIS_NUM_BINS) {
+        return 0.0f;
+    }
+    return sqrtf(axisPowers[axis][bin]) / (WINDOW_SIZE / 2.0f);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef FFT_PROCESSOR_H
+#define FFT_PROCESSOR_H
+
+#include "config.h"
+#include <cmath>
+
+// FFT 工作缓冲区长度: 实数输入模式下只需 N/2 点
+#if FFT_REAL_INPUT
+#define FFT_BUFFER_SIZE (WINDOW_SIZE / 2)
+#else
+#define FFT_BUFFER_SIZE WINDOW_SIZE
+#endif
+
+#define NUM_AXES 3
+
+// 三轴分析只需要 0 .. AXIS_MAX_FREQ 的频点，拆分和幅值计算只做这一段
+#define AXIS_MAX_FREQ 10.0f
+#define AXIS_NUM_BINS ((int)(AXIS_MAX_FREQ * WINDOW_SIZE / SAMPLE_RATE) + 1)
+
+struct FrequencyPeak {
+    float frequency;
+    float magnitude;
+};
+
+class FFTProcessor {
+private:
+    float realData[FFT_BUFFER_SIZE];
+    float imagData[FFT_BUFFER_SIZE];
+    float magnitudes[WINDOW_SIZE / 2];
+    
+    void fft(float* real, float* imag, int n);
+    void bitReverse(float* real, float* imag, int n);
+    
+#if TRI_AXIAL_ANALYSIS
+    // 三轴批处理缓冲区 (每轴一行，结构体数组布局)，三轴共享旋转因子和窗函数
+    float axisReal[NUM_AXES][FFT_BUFFER_SIZE];
+    float axisImag[NUM_AXES][FFT_BUFFER_SIZE];
+    float axisPowers[NUM_AXES][AXIS_NUM_BINS];  // |X|²，只对峰值开方
+    
+    void fftAxes(int n);
+#endif
+    
+public:
+    FFTProcessor();
+    FrequencyPeak process(float* data);
+    
+    // process 的各个阶段，按顺序调用 (基准测试和阶段计时用)
+    void loadWindow(const float* data);     // 汉宁窗 + 装入 FFT 缓冲区
+    void transform();                       // 原地 FFT
+    void computeSpectrum();                 // (实数拆分 +) 幅值谱
+    FrequencyPeak findPeak();               // 1-10Hz 最大峰值
+    
+    FrequencyPeak findPeakInRange(float minFreq, float maxFreq);
+    float getMagnitude(int bin);
+    
+#if TRI_AXIAL_ANALYSIS
+    void processAxes(const float* x, const float* y, const float* z, FrequencyPeak* peaks);
+    void computeAxes(const float* x, const float* y, const float* z);  // processAxes 去掉峰值搜索
+    FrequencyPeak findAxisPeakInRange(int axis, float minFreq, float maxFreq);
+    float getAxisMagnitude(int axis, int bin);
+    // 各轴 |X|² (AXIS_NUM_BINS 个频点，未归一化，乘以 POWER_SCALE 为幅值²)，供 Welch 平均
+    const float* getAxisPowers(int axis) { return axisPowers[axis]; }
+    static constexpr float POWER_SCALE = 1.0f / ((WINDOW_SIZE / 2.0f) * (WINDOW_SIZE / 2.0f));
+#endif
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "fixed_fft.h"
+#include "dsp_tables.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_DSP)
+#include "cmsis.h"  // __SMUSD / __SMUADX / __QADD16 等 SIMD 指令
+#endif
+
+// 复数蝶形的分量增长上限为 1 + √2，每级开始前保证 |分量| <= 32767 / 2.414
+static const int32_t STAGE_LIMIT = 13572;
+
+static inline uint32_t load32(const int16_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store32(int16_t* p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+FixedFFTProcessor::FixedFFTProcessor() {
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        buffer[i] = 0;
+    }
+    for (int i = 0; i < WINDOW_SIZE / 2; i++) {
+        powers[i] = 0;
+    }
+    exponent = 0;
+}
+
+void FixedFFTProcessor::bitReverse(int16_t* data, int n) {
+    int j = 0;
+    for (int i = 0; i < n - 1; i++) {
+        if (i < j) {
+            // 交换复数 i 和 j (一次 32 位读写)
+            uint32_t temp = load32(&data[2 * i]);
+            store32(&data[2 * i], load32(&data[2 * j]));
+            store32(&data[2 * j], temp);
+        }
+
+        int k = n / 2;
+        while (k <= j) {
+            j -= k;
+            k /= 2;
+        }
+        j += k;
+    }
+}
+
+int FixedFFTProcessor::fft(int16_t* data, int n) {
+    int blockExponent = 0;
+
+    bitReverse(data, n);
+
+    for (int len = 2; len <= n; len *= 2) {
+        // 块浮点: 检查当前最大分量，必要时整体右移
+        int32_t peak = 0;
+        for (int i = 0; i < 2 * n; i++) {
+            int32_t v = data[i] < 0 ? -(int32_t)data[i] : data[i];
+            if (v > peak) {
+                peak = v;
+            }
+        }
+        int shift = 0;
+        while (peak > STAGE_LIMIT) {
+            peak >>= 1;
+            shift++;
+        }
+        if (shift > 0) {
+            for (int i = 0; i < 2 * n; i++) {
+                data[i] = (int16_t)(data[i] >> shift);
+            }
+            blockExponent += shift;
+        }
+
+        int half = len / 2;
+        int step = WINDOW_SIZE / len;
+
+        for (int j = 0; j < half; j++) {
+            const int16_t* w = &dsp::TWIDDLE_Q15.value[2 * j * step];
+
+            for (int i = 0; i < n; i += len) {
+                int16_t* u = &data[2 * (i + j)];
+                int16_t* v = &data[2 * (i + j + half)];
+
+#if defined(__ARM_FEATURE_DSP)
+                uint32_t wPacked = load32(w);
+                uint32_t vPacked = load32(v);
+                uint32_t uPacked = load32(u);
+
+                // tReal = wr*vr - wi*vi, tImag = wr*vi + wi*vr (双 16 位乘加)
+                int32_t tReal = ((int32_t)__SMUSD(wPacked, vPacked) + 0x4000) >> 15;
+                int32_t tImag = ((int32_t)__SMUADX(wPacked, vPacked) + 0x4000) >> 15;
+                uint32_t tPacked = __PKHBT(tReal, tImag, 16);
+
+                store32(u, __QADD16(uPacked, tPacked));
+                store32(v, __QSUB16(uPacked, tPacked));
+#else
+                int32_t tReal = ((int32_t)w[0] * v[0] - (int32_t)w[1] * v[1] + 0x4000) >> 15;
+                int32_t tImag = ((int32_t)w[0] * v[1] + (int32_t)w[1] * v[0] + 0x4000) >> 15;
+
+                int32_t uReal = u[0];
+                int32_t uImag = u[1];
+
+                u[0] = (int16_t)(uReal + tReal);
+                u[1] = (int16_t)(uImag + tImag);
+                v[0] = (int16_t)(uReal - tReal);
+                v[1] = (int16_t)(uImag - tImag);
+#endif
+            }
+        }
+    }
+
+    return blockExponent;
+}
+
+FrequencyPeak FixedFFTProcessor::process(const int16_t* data) {
+    const int half = WINDOW_SIZE / 2;
+
+    // Q15 汉宁窗，偶数样本放实部、奇数样本放虚部
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        buffer[i] = (int16_t)(((int32_t)data[i] * dsp::HANN_WINDOW_Q15.value[i] + 0x4000) >> 15);
+    }
+
+    // N/2 点块浮点 FFT
+    exponent = fft(buffer, half);
+
+    // 拆分: X[k] = Fe[k] + W^k * Fo[k]，保存 |X/2|² 以保证 32 位不溢出
+    for (int k = 0; k < half; k++) {
+        int m = (half - k) % half;
+
+        int32_t zkReal = buffer[2 * k];
+        int32_t zkImag = buffer[2 * k + 1];
+        int32_t zmReal = buffer[2 * m];
+        int32_t zmImag = buffer[2 * m + 1];
+
+        int32_t feReal = (zkReal + zmReal) >> 1;
+        int32_t feImag = (zkImag - zmImag) >> 1;
+        int32_t foReal = (zkImag + zmImag) >> 1;
+        int32_t foImag = (zmReal - zkReal) >> 1;
+
+        int32_t wReal = dsp::TWIDDLE_Q15.value[2 * k];
+        int32_t wImag = dsp::TWIDDLE_Q15.value[2 * k + 1];
+
+        int32_t xReal = (feReal + ((wReal * foReal - wImag * foImag + 0x4000) >> 15)) >> 1;
+        int32_t xImag = (feImag + ((wReal * foImag + wImag * foReal + 0x4000) >> 15)) >> 1;
+
+        powers[k] = (uint32_t)(xReal * xReal) + (uint32_t)(xImag * xImag);
+    }
+
+    // 找出最大峰值 (1-10Hz 范围)，与浮点版本一致
+    int minBin = (int)(1.0f * WINDOW_SIZE / SAMPLE_RATE);
+    int maxBin = (int)(10.0f * WINDOW_SIZE / SAMPLE_RATE);
+
+    int peakBin = -1;
+    uint32_t peakPower = 0;
+    for (int i = minBin; i < maxBin && i < half; i++) {
+        if (powers[i] > peakPower) {
+            peakPower = powers[i];
+            peakBin = i;
+        }
+    }
+
+    FrequencyPeak peak;
+    peak.magnitude = 0;
+    peak.frequency = 0;
+    if (peakBin >= 0) {
+        peak.magnitude = toMagnitude(peakPower);
+        peak.frequency = (float)peakBin * SAMPLE_RATE / WINDOW_SIZE;
+    }
+
+    return peak;
+}
+
+float FixedFFTProcessor::toMagnitude(uint32_t power) {
+    // |X| = 2 * sqrt(power) * 2^exponent，再按浮点版本归一化到 m/s²
+    float scale = ldexpf(2.0f, exponent) / (WINDOW_SIZE / 2.0f) * ACC_LSB_TO_MS2;
+    return sqrtf((float)power) * scale;
+}
+
+FrequencyPeak FixedFFTProcessor::findPeakInRange(float minFreq, float maxFreq) {
+    int minBin = (int)(minFreq * WINDOW_SIZE / SAMPLE_RATE);
+    int maxBin = (int)(maxFreq * WINDOW_SIZE / SAMPLE_RATE);
+
+    int peakBin = -1;
+    uint32_t peakPower = 0;
+    for (int i = minBin; i <= maxBin && i < WINDOW_SIZE / 2; i++) {
+        if (powers[i] > peakPower) {
+            peakPower = powers[i];
+            peakBin = i;
+        }
+    }
+
+    FrequencyPeak peak;
+    peak.magnitude = 0;
+    peak.frequency = 0;
+    if (peakBin >= 0) {
+        peak.magnitude = toMagnitude(peakPower);
+        peak.frequency = (float)peakBin * SAMPLE_RATE / WINDOW_SIZE;
+    }
+
+    return peak;
+}
+
+float FixedFFTProcessor::getMagnitude(int bin) {
+    if (bin < 0 || bin >= WINDOW_SIZE / 2) {
+        return 0.0f;
+    }
+    return toMagnitude(powers[bin]);
+}
@@ -0,0 +1,61 @@
+#ifndef FIXED_FFT_H
+#define FIXED_FFT_H
+
+#include "config.h"
+#include "fft_processor.h"
+#include <stdint.h>
+
+// 窗口样本类型: 浮点流水线为 m/s²，定点流水线为原始 LSB
+#if DSP_FIXED_POINT
+typedef int16_t sample_t;
+#else
+typedef float sample_t;
+#endif
+
+namespace dsp {
+
+// 32 位整数平方根 (逐位法，无 FPU)
+inline uint32_t isqrt32(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+}  // namespace dsp
+
+// Q15 定点 FFT 处理器
+// 输入为原始 LSB (int16)，Q15 汉宁窗 + 实数输入打包 + 块浮点 FFT + 整数幅值平方，
+// 只在输出峰值时换算为 m/s²。Cortex-M4 上使用双 16 位 MAC 指令 (SMUSD/SMUADX)。
+//
+// 误差界 (相对浮点 FFTProcessor，±2g 量程):
+//   峰值幅值误差 <= 0.5% * 幅值 + 0.002 m/s²，峰值频点一致
+class FixedFFTProcessor {
+private:
+    int16_t buffer[WINDOW_SIZE];       // N/2 个复数，re/im 交错存放
+    uint32_t powers[WINDOW_SIZE / 2];  // |X/2|² (以 2^exponent 缩放)
+    int exponent;                      // 块浮点指数
+
+    int fft(int16_t* data, int n);
+    void bitReverse(int16_t* data, int n);
+    float toMagnitude(uint32_t power);
+
+public:
+    FixedFFTProcessor();
+    FrequencyPeak process(const int16_t* data);
+    FrequencyPeak findPeakInRange(float minFreq, float maxFreq);
+    float getMagnitude(int bin);
+};
+
+#endif
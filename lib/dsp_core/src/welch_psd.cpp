@@ -0,0 +1,107 @@
+#include "welch_psd.h"
+#include <cmath>
+
+WelchPsd::WelchPsd() {
+    reset();
+}
+
+void WelchPsd::reset() {
+    for (int s = 0; s < SEGMENTS; s++) {
+        for (int c = 0; c < CHANNELS; c++) {
+            for (int b = 0; b < NUM_BINS; b++) {
+                segments[s][c][b] = 0;
+            }
+        }
+    }
+    for (int c = 0; c < CHANNELS; c++) {
+        for (int b = 0; b < NUM_BINS; b++) {
+            sum[c][b] = 0;
+        }
+    }
+    next = 0;
+    count = 0;
+    sinceRebuild = 0;
+}
+
+void WelchPsd::beginSegment() {
+    if (count < SEGMENTS) {
+        return;
+    }
+    for (int c = 0; c < CHANNELS; c++) {
+        for (int b = 0; b < NUM_BINS; b++) {
+            sum[c][b] -= segments[next][c][b];
+        }
+    }
+}
+
+void WelchPsd::setPowers(int channel, const float* powers, float scale) {
+    float* segment = segments[next][channel];
+    float* total = sum[channel];
+    for (int b = 0; b < NUM_BINS; b++) {
+        float power = powers[b] * scale;
+        segment[b] = power;
+        total[b] += power;
+    }
+}
+
+void WelchPsd::endSegment() {
+    next++;
+    if (next >= SEGMENTS) {
+        next = 0;
+    }
+    if (count < SEGMENTS) {
+        count++;
+    }
+
+    // 每 SEGMENTS 段从保存的各段重新求和，防止加减的舍入误差无限累积 (均摊每段一次加法)
+    sinceRebuild++;
+    if (sinceRebuild >= SEGMENTS) {
+        sinceRebuild = 0;
+        for (int c = 0; c < CHANNELS; c++) {
+            for (int b = 0; b < NUM_BINS; b++) {
+                float total = 0;
+                for (int s = 0; s < count; s++) {
+                    total += segments[s][c][b];
+                }
+                sum[c][b] = total;
+            }
+        }
+    }
+}
+
+int WelchPsd::getSegmentCount() {
+    return count;
+}
+
+float WelchPsd::getMagnitude(int channel, int bin) {
+    if (channel < 0 || channel >= CHANNELS || bin < 0 || bin >= NUM_BINS || count == 0) {
+        return 0.0f;
+    }
+    float power = sum[channel][bin] / count;
+    return power > 0 ? sqrtf(power) : 0.0f;
+}
+
+FrequencyPeak WelchPsd::findPeakInRange(int channel, float minFreq, float maxFreq) {
+    int minBin = (int)(minFreq * WINDOW_SIZE / SAMPLE_RATE);
+    int maxBin = (int)(maxFreq * WINDOW_SIZE / SAMPLE_RATE);
+
+    // 比较累加的功率，只对峰值开方
+    int peakBin = -1;
+    float peakPower = 0;
+    for (int i = minBin; i <= maxBin && i < NUM_BINS; i++) {
+        if (sum[channel][i] > peakPower) {
+            peakPower = sum[channel][i];
+            peakBin = i;
+        }
+    }
+
+    FrequencyPeak peak;
+    peak.magnitude = 0;
+    peak.frequency = 0;
+    if (peakBin >= 0) {
+        peak.magnitude = sqrtf(peakPower / count);
+        peak.frequency = (float)peakBin * SAMPLE_RATE / WINDOW_SIZE;
+    }
+
+    return peak;
+}
@@ -0,0 +1,44 @@
+#ifndef WELCH_PSD_H
+#define WELCH_PSD_H
+
+#include "config.h"
+#include "fft_processor.h"
+
+// Welch 功率谱平均
+// 保存最近 DETECTOR_WELCH_SEGMENTS 段 (每个分析窗口一段，段间错开一个步长) 的功率谱，
+// 并维护它们的累加和: 每段只做一次 FFT，加入新段时减去被替换的旧段，代价与段数无关。
+// 只保存 0 .. AXIS_MAX_FREQ 的频点; 功率以 FFTProcessor 的幅值归一化为准 (幅值²)，
+// 平均谱开方后与单窗口幅值可比，检测阈值不变
+class WelchPsd {
+public:
+    static constexpr int SEGMENTS = DETECTOR_WELCH_SEGMENTS;
+    static constexpr int CHANNELS = TRI_AXIAL_ANALYSIS ? NUM_AXES : 1;
+    static constexpr int NUM_BINS = AXIS_NUM_BINS;
+
+private:
+    float segments[SEGMENTS][CHANNELS][NUM_BINS];
+    float sum[CHANNELS][NUM_BINS];
+    int next;               // 下一段写入的位置 (已满时也是最旧的一段)
+    int count;              // 已有的段数 (不超过 SEGMENTS)
+    int sinceRebuild;
+
+public:
+    WelchPsd();
+
+    // 加入一段: beginSegment 从累加和中减去将被替换的最旧一段，
+    // setPower/setPowers 写入新段的功率 (同时累加)，endSegment 提交
+    void beginSegment();
+    void setPower(int channel, int bin, float power) {
+        segments[next][channel][bin] = power;
+        sum[channel][bin] += power;
+    }
+    void setPowers(int channel, const float* powers, float scale);    // 整个通道: powers[b] * scale
+    void endSegment();
+
+    int getSegmentCount();
+    float getMagnitude(int channel, int bin);
+    FrequencyPeak findPeakInRange(int channel, float minFreq, float maxFreq);
+    void reset();
+};
+
+#endif
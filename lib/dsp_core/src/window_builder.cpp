@@ -0,0 +1,127 @@
+#include "window_builder.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+WindowBuilder::WindowBuilder() {
+    hopSize = HOP_SIZE;
+    reset();
+}
+
+void WindowBuilder::reset() {
+    bufferIndex = 0;
+    sampleCount = 0;
+    hopCounter = 0;
+    totalSamples = 0;
+    windowSequence = 0;
+    readySequence = 0;
+    latestSample = 0;
+    activity.reset();
+}
+
+bool WindowBuilder::addSample(int16_t ax_raw, int16_t ay_raw, int16_t az_raw) {
+#if DSP_FIXED_POINT
+    // 定点: 直接使用原始 LSB，z 轴减去 1g，整数平方根 (超出 ±2g 时饱和)
+    int32_t dz = (int32_t)az_raw - GRAVITY_LSB;
+    if (dz < -32768) {
+        dz = -32768;
+    }
+    uint32_t sumSquares = (uint32_t)((int32_t)ax_raw * ax_raw) + (uint32_t)((int32_t)ay_raw * ay_raw)
+                        + (uint32_t)(dz * dz);
+    uint32_t root = dsp::isqrt32(sumSquares);
+    sample_t magnitude = (sample_t)(root > 32767 ? 32767 : root);
+
+    latestSample = magnitude * ACC_LSB_TO_MS2;
+    float smaTerm = (float)(abs(ax_raw) + abs(ay_raw) + abs((int)dz)) * ACC_LSB_TO_MS2;
+#else
+    // 转换为 m/s² (±2g, 灵敏度 0.061 mg/LSB)
+    float ax = ax_raw * ACC_LSB_TO_MS2;
+    float ay = ay_raw * ACC_LSB_TO_MS2;
+    float az = az_raw * ACC_LSB_TO_MS2;
+
+    // 减去重力
+    az -= 9.81f;
+
+    // 计算合成加速度
+    sample_t magnitude = sqrtf(ax*ax + ay*ay + az*az);
+
+    latestSample = magnitude;
+    float smaTerm = fabsf(ax) + fabsf(ay) + fabsf(az);
+#endif
+
+    // 活动统计 (FOG 检测用)，直接使用已读取的样本
+    activity.update(latestSample, smaTerm);
+
+    // 存入镜像环形缓冲区
+#if WINDOW_SAMPLES
+    dataBuffer[bufferIndex] = magnitude;
+    dataBuffer[bufferIndex + WINDOW_SIZE] = magnitude;
+#endif
+#if WINDOW_AXES
+    float axes[NUM_AXES] = {
+        ax_raw * ACC_LSB_TO_MS2,
+        ay_raw * ACC_LSB_TO_MS2,
+        az_raw * ACC_LSB_TO_MS2
+    };
+    for (int a = 0; a < NUM_AXES; a++) {
+        axisBuffer[a][bufferIndex] = axes[a];
+        axisBuffer[a][bufferIndex + WINDOW_SIZE] = axes[a];
+    }
+#endif
+    bufferIndex++;
+    if (bufferIndex >= WINDOW_SIZE) {
+        bufferIndex = 0;
+    }
+
+    if (sampleCount < WINDOW_SIZE) {
+        sampleCount++;
+    }
+    totalSamples++;
+    hopCounter++;
+
+    // 首个窗口填满后，每 hopSize 个样本产出一个新窗口 (窗口被丢弃时序号同样递增)
+    if (sampleCount >= WINDOW_SIZE && hopCounter >= hopSize) {
+        hopCounter = 0;
+        activity.closeHop();
+        readySequence = windowSequence++;
+        return true;
+    }
+    return false;
+}
+
+void WindowBuilder::fillWindow(AnalysisWindow* window) {
+    // bufferIndex 指向最旧的样本，镜像缓冲区中从这里开始的 WINDOW_SIZE 个样本是连续的
+    window->sequence = readySequence;
+    window->firstSample = totalSamples - WINDOW_SIZE;
+#if WINDOW_SAMPLES
+    memcpy(window->samples, &dataBuffer[bufferIndex], sizeof(window->samples));
+#endif
+#if WINDOW_AXES
+    for (int a = 0; a < NUM_AXES; a++) {
+        memcpy(window->axes[a], &axisBuffer[a][bufferIndex], sizeof(window->axes[a]));
+    }
+#endif
+    window->activity = activity.getSnapshot();
+}
+
+uint32_t WindowBuilder::getTotalSamples() {
+    return totalSamples;
+}
+
+float WindowBuilder::getLatestSample() {
+    return latestSample;
+}
+
+void WindowBuilder::setHopSize(int hop) {
+    if (hop < 1) {
+        hop = 1;
+    }
+    if (hop > WINDOW_SIZE) {
+        hop = WINDOW_SIZE;
+    }
+    hopSize = hop;
+}
+
+int WindowBuilder::getHopSize() {
+    return hopSize;
+}
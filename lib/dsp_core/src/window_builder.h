@@ -0,0 +1,49 @@
+#ifndef WINDOW_BUILDER_H
+#define WINDOW_BUILDER_H
+
+#include "config.h"
+#include "fixed_fft.h"
+#include "activity_stats.h"
+#include "window_queue.h"
+#include <stdint.h>
+
+// 滑动窗口组装: 原始 LSB 样本 -> 合成幅值/三轴缓冲区 + 活动统计，每 hopSize 个样本产出一个窗口
+// 不依赖 mbed: 板上由 SensorManager 在采集线程中调用，主机回放工具用同一份代码组装窗口
+class WindowBuilder {
+private:
+    // 镜像环形缓冲区: 每个样本同时写入 i 和 i + WINDOW_SIZE，
+    // 因此从任意起点开始的 WINDOW_SIZE 个样本都是连续且按时间排序的;
+    // 只保存窗口携带的数据 (见 window_queue.h)
+#if WINDOW_SAMPLES
+    sample_t dataBuffer[2 * WINDOW_SIZE];
+#endif
+#if WINDOW_AXES
+    // 三轴镜像环形缓冲区 (结构体数组, m/s², 含重力)
+    float axisBuffer[NUM_AXES][2 * WINDOW_SIZE];
+#endif
+    int bufferIndex;     // 下一个写入位置 (0 .. WINDOW_SIZE-1)，也是最旧的样本
+    int sampleCount;     // 已采集样本数 (最多 WINDOW_SIZE，用于首窗口填充)
+    int hopSize;         // 滑动步长
+    int hopCounter;      // 距上次窗口就绪的样本数
+    uint32_t totalSamples;      // 自 reset 起的样本数
+    uint32_t windowSequence;    // 下一个窗口的序号
+    uint32_t readySequence;     // 最近就绪窗口的序号
+    float latestSample;
+    ActivityTracker activity;   // 窗口/步长活动统计
+
+public:
+    WindowBuilder();
+    void reset();       // 保留步长设置
+
+    // 加入一个样本，窗口就绪时返回 true (随后调用 fillWindow，或直接丢弃该窗口)
+    bool addSample(int16_t ax_raw, int16_t ay_raw, int16_t az_raw);
+    // 复制最近就绪的窗口 (只复制配置的分析路径读取的数据)
+    void fillWindow(AnalysisWindow* window);
+
+    uint32_t getTotalSamples();
+    float getLatestSample();
+    void setHopSize(int hop);
+    int getHopSize();
+};
+
+#endif
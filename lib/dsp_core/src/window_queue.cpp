@@ -0,0 +1,46 @@
+#include "window_queue.h"
+
+WindowQueue::WindowQueue() {
+    reset();
+}
+
+void WindowQueue::reset() {
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    overruns = 0;
+}
+
+AnalysisWindow* WindowQueue::beginWrite() {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    // acquire: 消费者对该槽的读取在释放之前完成
+    if (h - tail.load(std::memory_order_acquire) >= WINDOW_QUEUE_SLOTS) {
+        overruns++;
+        return nullptr;
+    }
+    return &slots[h % WINDOW_QUEUE_SLOTS];
+}
+
+void WindowQueue::commitWrite() {
+    // release: 窗口内容先于 head 对消费者可见
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+AnalysisWindow* WindowQueue::beginRead() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t) {
+        return nullptr;
+    }
+    return &slots[t % WINDOW_QUEUE_SLOTS];
+}
+
+void WindowQueue::commitRead() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+int WindowQueue::getPending() {
+    return (int)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
+
+uint32_t WindowQueue::getOverruns() {
+    return overruns;
+}
@@ -0,0 +1,66 @@
+#ifndef WINDOW_QUEUE_H
+#define WINDOW_QUEUE_H
+
+#include "config.h"
+#include "fixed_fft.h"
+#include "activity_stats.h"
+#include <atomic>
+#include <cmath>
+#include <stdint.h>
+
+// 窗口只携带所配置的分析路径读取的数据 (采集线程每个步长只复制这一份):
+// 三轴 FFT 读 axes，合成幅值 FFT 和频带估计读 samples
+#define WINDOW_AXES (TRI_AXIAL_ANALYSIS && !DETECTOR_USE_BAND_TRACKER)
+#define WINDOW_SAMPLES (!WINDOW_AXES)
+
+// 一个分析窗口的快照: 采集端复制，分析端独占读取
+struct AnalysisWindow {
+    uint32_t sequence;                  // 窗口序号 (从 0 开始，丢弃的窗口也计数)
+    uint32_t firstSample;               // 最旧样本的序号 (自 startSampling 起)
+#if WINDOW_SAMPLES
+    sample_t samples[WINDOW_SIZE];      // 合成幅值，按时间从旧到新排列
+#endif
+#if WINDOW_AXES
+    float axes[NUM_AXES][WINDOW_SIZE];  // 三轴加速度 (m/s², 含重力)
+#endif
+    ActivitySnapshot activity;
+};
+
+// 窗口中第 i 个样本的合成幅值 (m/s²)，只有三轴数据时由三轴计算 (日志和测试用，不在分析路径上)
+inline float windowMagnitude(const AnalysisWindow& window, int i) {
+#if WINDOW_AXES
+    float ax = window.axes[0][i];
+    float ay = window.axes[1][i];
+    float az = window.axes[2][i] - 9.81f;
+    return sqrtf(ax * ax + ay * ay + az * az);
+#elif DSP_FIXED_POINT
+    return window.samples[i] * ACC_LSB_TO_MS2;
+#else
+    return window.samples[i];
+#endif
+}
+
+// 单生产者/单消费者窗口队列 (无锁)
+// 采集端 beginWrite/commitWrite，分析端 beginRead/commitRead；
+// 槽在 commitRead 之前不会被覆盖，队列满时丢弃新窗口并计数，采集端从不等待
+class WindowQueue {
+private:
+    AnalysisWindow slots[WINDOW_QUEUE_SLOTS];
+    std::atomic<uint32_t> head;         // 已提交的窗口数 (只由生产者写)
+    std::atomic<uint32_t> tail;         // 已释放的窗口数 (只由消费者写)
+    uint32_t overruns;                  // 队列满而丢弃的窗口数 (只由生产者写)
+
+public:
+    WindowQueue();
+    void reset();                       // 只能在生产者和消费者都停止时调用
+
+    AnalysisWindow* beginWrite();       // 队列满时返回 nullptr 并计数
+    void commitWrite();
+    AnalysisWindow* beginRead();        // 队列空时返回 nullptr
+    void commitRead();
+
+    int getPending();
+    uint32_t getOverruns();
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+// 令牌化日志的消息表 (X-macro): X(名称, 级别, 参数个数, 格式)
+// 设备端只展开名称和级别 (消息编号 = 表中位置)，格式字符串只编译进主机端解码器，不占 flash。
+// 格式使用 printf 语法，参数只能是整数、字符和浮点数 (每个参数 32 位)，不支持 %s。
+// 只在表末尾追加新消息; 删除或调整顺序会使已记录的日志无法解码
+#define LOG_MESSAGES(X) \
+    X(LOG_DROPPED,                 LEVEL_WARN,  1, "Log: %lu entries dropped (ring full)") \
+    X(DETECTOR_PEAK,               LEVEL_DEBUG, 2, "Peak: %.2f Hz, Magnitude: %.3f") \
+    X(DETECTOR_AXIS_PEAK,          LEVEL_DEBUG, 3, "Peak: %.2f Hz, Magnitude: %.3f (axis %c)") \
+    X(DETECTOR_TREMOR,             LEVEL_INFO,  0, ">>> TREMOR DETECTED <<<") \
+    X(DETECTOR_DYSKINESIA,         LEVEL_INFO,  0, ">>> DYSKINESIA DETECTED <<<") \
+    X(DETECTOR_MOTION,             LEVEL_DEBUG, 6, "Motion: hop avg %.2f std %.3f sma %.2f, window avg %.2f std %.3f sma %.2f") \
+    X(DETECTOR_IDLE_TO_WALKING,    LEVEL_INFO,  1, "State: IDLE -> WALKING (stddev=%.3f)") \
+    X(DETECTOR_STILL_WALKING,      LEVEL_DEBUG, 2, "Still walking (time: %lu ms, stddev: %.3f)") \
+    X(DETECTOR_STOPPED,            LEVEL_DEBUG, 3, "Stopped! Stop time: %lu ms, Walk time: %lu ms (stddev: %.3f)") \
+    X(DETECTOR_WALKING_TO_FROZEN,  LEVEL_INFO,  0, "State: WALKING -> FROZEN") \
+    X(DETECTOR_WALKING_TO_IDLE,    LEVEL_INFO,  0, "State: WALKING -> IDLE (walk too short)") \
+    X(DETECTOR_FROZEN_TO_WALKING,  LEVEL_INFO,  1, "State: FROZEN -> WALKING (resumed, stddev=%.3f)") \
+    X(WINDOW_READY,                LEVEL_DEBUG, 1, "--- Data ready (window %lu) ---") \
+    X(FIRST_SAMPLES,               LEVEL_DEBUG, 5, "First samples: %.2f %.2f %.2f %.2f %.2f") \
+    X(DETECTION_SUMMARY,           LEVEL_INFO,  6, "Tremor %d (%.2f), dyskinesia %d (%.2f), FOG %d (state %d)") \
+    X(AXIS_PEAKS,                  LEVEL_DEBUG, 7, "Axis peaks: X %.2fHz/%.3f, Y %.2fHz/%.3f, Z %.2fHz/%.3f (dominant %c)") \
+    X(OVERRUNS,                    LEVEL_WARN,  3, "Overruns: window %lu, FIFO %lu, BLE %lu") \
+    X(BLE_STATS,                   LEVEL_DEBUG, 3, "BLE: %lu notifications, %lu results suppressed, %lu deferred by rate limit") \
+    X(EVENT_LOG_STATS,             LEVEL_DEBUG, 5, "Event log: next %lu, %lu erases, %lu write errors, %lu queue drops, %lu chunks downloaded") \
+    X(RECORDER_STATS,              LEVEL_DEBUG, 5, "Recorder: %lu samples, %lu dropped, block %lu/%lu, full %d") \
+    X(RAW_STREAM_STATS,            LEVEL_DEBUG, 5, "Raw stream: %lu samples, %.2f bytes/sample, %lu packets sent, %lu dropped samples, %lu backpressure") \
+    X(SLEEP_STATS,                 LEVEL_DEBUG, 3, "Sleep: stop %lu entries (%.1f%%), sleep %lu entries") \
+    X(CAPTURE_STATS,               LEVEL_DEBUG, 3, "Capture: %lu packets, %lu bytes queued, %lu packets dropped (buffer full)")
+
+#endif
@@ -0,0 +1,92 @@
+#include "tokenlog.h"
+
+namespace tokenlog {
+
+// 条目序列号: 等于位置时可写入，等于位置 + 1 时已提交可读取，读取后加上容量留给下一轮
+LogRing::LogRing() : head(0), tail(0), dropped(0) {
+    for (uint32_t i = 0; i < LOG_RING_ENTRIES; i++) {
+        entries[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogRing::push(MessageId id, const uint32_t* args, int count) {
+    if (count > MAX_ARGS) {
+        count = MAX_ARGS;
+    }
+    uint32_t pos = head.load(std::memory_order_relaxed);
+    Entry* entry;
+    while (true) {
+        entry = &entries[pos & (LOG_RING_ENTRIES - 1)];
+        uint32_t sequence = entry->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 该位置还没被消费者读走: 缓冲区满
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    entry->id = id;
+    entry->count = (uint8_t)count;
+    for (int i = 0; i < count; i++) {
+        entry->args[i] = args[i];
+    }
+    entry->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRing::pop(MessageId* id, uint32_t* args, int* count) {
+    Entry* entry = &entries[tail & (LOG_RING_ENTRIES - 1)];
+    uint32_t sequence = entry->sequence.load(std::memory_order_acquire);
+    if ((int32_t)(sequence - (tail + 1)) < 0) {
+        return false;
+    }
+
+    *id = (MessageId)entry->id;
+    *count = entry->count;
+    for (int i = 0; i < entry->count; i++) {
+        args[i] = entry->args[i];
+    }
+    entry->sequence.store(tail + LOG_RING_ENTRIES, std::memory_order_release);
+    tail++;
+    return true;
+}
+
+uint8_t crc8(const uint8_t* data, int len) {
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int encodeFrame(uint8_t* out, MessageId id, const uint32_t* args, int count) {
+    if (count > MAX_ARGS) {
+        count = MAX_ARGS;
+    }
+    int payload = 2 + 4 * count;
+    out[0] = FRAME_START;
+    out[1] = (uint8_t)payload;
+    out[2] = (uint8_t)(id & 0xFF);
+    out[3] = (uint8_t)(id >> 8);
+    for (int i = 0; i < count; i++) {
+        uint8_t* p = out + 4 + 4 * i;
+        p[0] = (uint8_t)(args[i] & 0xFF);
+        p[1] = (uint8_t)(args[i] >> 8);
+        p[2] = (uint8_t)(args[i] >> 16);
+        p[3] = (uint8_t)(args[i] >> 24);
+    }
+    out[2 + payload] = crc8(out + 1, 1 + payload);
+    return FRAME_OVERHEAD + 4 * count;
+}
+
+}  // namespace tokenlog
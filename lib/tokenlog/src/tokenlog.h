@@ -0,0 +1,149 @@
+#ifndef TOKENLOG_H
+#define TOKENLOG_H
+
+#include "config.h"
+#include "log_messages.h"
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// 令牌化延迟日志: 调用处只写入 消息编号 + 原始 32 位参数 (浮点数按位保存) 到无锁环形缓冲区，
+// 不做格式化、不访问串口; 低优先级线程把条目编码为二进制帧发出，主机端解码器按消息表还原文本。
+// 级别低于 LOG_LEVEL 的消息在编译期去除 (调用处不产生代码)
+//
+// 帧格式 (小端):
+//   [0]        FRAME_START (0xA5)
+//   [1]        负载长度 n = 2 + 4 × 参数个数
+//   [2..3]     消息编号 (u16)
+//   [4..]      参数 (u32 × 参数个数)
+//   [2 + n]    CRC-8 (多项式 0x07，覆盖长度字节和负载)
+// 帧之间可以夹杂普通文本 (启动信息等)，解码器按起始字节和 CRC 重新同步
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 0
+#endif
+
+#ifndef LOG_RING_ENTRIES
+#define LOG_RING_ENTRIES 32
+#endif
+
+#if (LOG_RING_ENTRIES & (LOG_RING_ENTRIES - 1)) != 0
+#error "LOG_RING_ENTRIES 必须是 2 的幂次方"
+#endif
+
+namespace tokenlog {
+
+enum Level {
+    LEVEL_DEBUG,
+    LEVEL_INFO,
+    LEVEL_WARN,
+    LEVEL_ERROR,
+    LEVEL_NONE          // LOG_LEVEL 设为此值时去除全部消息
+};
+
+enum MessageId : uint16_t {
+#define TOKENLOG_ID(name, level, args, format) name,
+    LOG_MESSAGES(TOKENLOG_ID)
+#undef TOKENLOG_ID
+    NUM_MESSAGES
+};
+
+const int MAX_ARGS = 8;
+const uint8_t FRAME_START = 0xA5;
+const int FRAME_OVERHEAD = 5;                       // 起始字节 + 长度 + 编号 + CRC
+const int MAX_FRAME_SIZE = FRAME_OVERHEAD + 4 * MAX_ARGS;
+
+constexpr uint8_t MESSAGE_LEVELS[NUM_MESSAGES] = {
+#define TOKENLOG_LEVEL(name, level, args, format) level,
+    LOG_MESSAGES(TOKENLOG_LEVEL)
+#undef TOKENLOG_LEVEL
+};
+
+constexpr uint8_t MESSAGE_ARGS[NUM_MESSAGES] = {
+#define TOKENLOG_ARGS(name, level, args, format) args,
+    LOG_MESSAGES(TOKENLOG_ARGS)
+#undef TOKENLOG_ARGS
+};
+
+constexpr Level levelOf(MessageId id) {
+    return (Level)MESSAGE_LEVELS[id];
+}
+
+constexpr int argCountOf(MessageId id) {
+    return MESSAGE_ARGS[id];
+}
+
+constexpr bool isEnabled(MessageId id) {
+    return levelOf(id) >= LOG_LEVEL;
+}
+
+// 参数转换为 32 位字: 浮点数保存 float 的位模式，整数/字符/枚举截断为 32 位
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, uint32_t>::type toWord(T value) {
+    float f = (float)value;
+    uint32_t word;
+    memcpy(&word, &f, sizeof(word));
+    return word;
+}
+
+template <typename T>
+inline typename std::enable_if<!std::is_floating_point<T>::value, uint32_t>::type toWord(T value) {
+    return (uint32_t)value;
+}
+
+inline float wordToFloat(uint32_t word) {
+    float f;
+    memcpy(&f, &word, sizeof(f));
+    return f;
+}
+
+// 环形缓冲区条目
+struct Entry {
+    std::atomic<uint32_t> sequence;
+    uint16_t id;
+    uint8_t count;
+    uint32_t args[MAX_ARGS];
+};
+
+// 有界无锁队列: 任意线程写入 (CAS 占位，满时丢弃并计数，从不等待)，单个消费者 (日志线程) 读取。
+// 不能在中断中写入 (中断打断占位与提交之间的写入者时会一直等到该写入者继续)
+class LogRing {
+private:
+    Entry entries[LOG_RING_ENTRIES];
+    std::atomic<uint32_t> head;         // 下一个写入位置 (写入者竞争)
+    uint32_t tail;                      // 下一个读取位置 (只由消费者访问)
+    std::atomic<uint32_t> dropped;
+
+public:
+    LogRing();
+
+    bool push(MessageId id, const uint32_t* args, int count);
+
+    // 写入一条消息: 参数个数与消息表不符时编译失败，低于 LOG_LEVEL 的消息编译为空
+    template <MessageId Id, typename... Args>
+    void write(Args... args) {
+        static_assert(sizeof...(Args) == argCountOf(Id), "参数个数与 log_messages.h 不符");
+        static_assert(sizeof...(Args) <= MAX_ARGS, "参数过多");
+        if (!isEnabled(Id)) {
+            return;
+        }
+        const uint32_t words[sizeof...(Args) + 1] = {toWord(args)...};
+        push(Id, words, (int)sizeof...(Args));
+    }
+
+    // 取出一条 (只能由消费者调用)，args 至少 MAX_ARGS 个; 为空时返回 false
+    bool pop(MessageId* id, uint32_t* args, int* count);
+
+    // 因缓冲区满而丢弃的条目数 (累计)
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+// 编码一帧，返回字节数 (不超过 MAX_FRAME_SIZE)
+int encodeFrame(uint8_t* out, MessageId id, const uint32_t* args, int count);
+
+uint8_t crc8(const uint8_t* data, int len);
+
+}  // namespace tokenlog
+
+#endif
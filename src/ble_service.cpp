@@ -6,10 +6,30 @@ static events::EventQueue event_queue(16 * EVENTS_EVENT_SIZE);
 BLEService::BLEService() : 
     _ble(BLE::Instance()), 
     _event_queue(event_queue),
+    _event_thread(osPriorityNormal, BLE_THREAD_STACK_SIZE, nullptr, "ble"),
     _connected(false),
-    _tremorChar(nullptr),
-    _dyskinesiaChar(nullptr),
-    _fogChar(nullptr),
+    _pendingUpdates(0),
+    _droppedUpdates(0),
+    _frameChar(nullptr),
+    _flushScheduled(false),
+    _attMtu(ATT_MTU_DEFAULT),
+    _notifications(0),
+    _rawChar(nullptr),
+    _rawStream(nullptr),
+    _rawFlushPending(false),
+    _rawPacketsSent(0),
+    _rawBackpressure(0),
+    _logChar(nullptr),
+    _eventLog(nullptr),
+    _eventLogQueue(nullptr),
+    _eventLogLock(nullptr),
+    _downloading(false),
+    _downloadRetryScheduled(false),
+    _downloadCursor(0),
+    _logChunksSent(0),
+#if STAGE_TIMING_ENABLED
+    _diagChar(nullptr),
+#endif
     _adv_handle(ble::LEGACY_ADVERTISING_HANDLE)
 {
 }
@@ -21,6 +41,8 @@ BLEService::~BLEService() {
 void BLEService::begin() {
     printf("Initializing onboard BLE...\r\n");
     
+    _clock.start();
+
     // 绑定事件处理回调
     _ble.onEventsToProcess(makeFunctionPointer(this, &BLEService::scheduleBleEventsProcessing));
 
@@ -32,7 +54,13 @@ void BLEService::begin() {
 }
 
 void BLEService::scheduleBleEventsProcessing(BLE::OnEventsToProcessCallbackContext *context) {
-    _event_queue.call(Callback<void()>(&context->ble, &BLE::processEvents));
+    _event_queue.call(Callback<void()>(this, &BLEService::processBleEvents));
+}
+
+void BLEService::processBleEvents() {
+    // HCI (SPI) 传输期间不进入 Stop 模式，空闲时由 BLE 芯片中断唤醒
+    DeepSleepLock lock;
+    _ble.processEvents();
 }
 
 void BLEService::onInitComplete(BLE::InitializationCompleteCallbackContext *params) {
@@ -46,26 +74,41 @@ void BLEService::onInitComplete(BLE::InitializationCompleteCallbackContext *para
     // 设置 Gap 事件处理程序 (this 类实现了 Gap::EventHandler)
     _ble.gap().setEventHandler(this);
 
-    // 配置特征值
-    // 1. Tremor: Read + Notify
-    UUID tremorUUID(TREMOR_CHAR_UUID);
-    _tremorChar = new GattCharacteristic(tremorUUID, _tremorValue, sizeof(_tremorValue), sizeof(_tremorValue), 
-                                         GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+    // 设置 GattServer 事件处理程序 (MTU 协商、订阅)
+    _ble.gattServer().setEventHandler(this);
 
-    // 2. Dyskinesia: Read + Notify
-    UUID dyskinesiaUUID(DYSKINESIA_CHAR_UUID);
-    _dyskinesiaChar = new GattCharacteristic(dyskinesiaUUID, _dyskinesiaValue, sizeof(_dyskinesiaValue), sizeof(_dyskinesiaValue), 
-                                             GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+    // 配置特征值: 检测帧 Read + Notify，变长 (最大 MTU - 3)
+    int initialLength = frame::encodeBatch(nullptr, 0, _frameValue);
+    UUID frameUUID(DETECTION_FRAME_CHAR_UUID);
+    _frameChar = new GattCharacteristic(frameUUID, _frameValue, initialLength, sizeof(_frameValue),
+                                        GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
 
-    // 3. FOG: Read + Notify
-    UUID fogUUID(FOG_CHAR_UUID);
-    _fogChar = new GattCharacteristic(fogUUID, _fogValue, sizeof(_fogValue), sizeof(_fogValue), 
-                                      GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+    // 原始数据流: Notify，变长
+    UUID rawUUID(RAW_STREAM_CHAR_UUID);
+    _rawChar = new GattCharacteristic(rawUUID, _rawValue, 0, sizeof(_rawValue),
+                                      GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+
+    // 事件日志下载: Write (起始序号) + Notify，变长
+    UUID logUUID(EVENT_LOG_CHAR_UUID);
+    _logChar = new GattCharacteristic(logUUID, _logValue, 0, sizeof(_logValue),
+                                      GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY);
+
+#if STAGE_TIMING_ENABLED
+    // 诊断: Read，定长 (首次发布前为空统计)
+    int diagLength = timing::encodeStats(_diagValue);
+    UUID diagUUID(DIAGNOSTICS_CHAR_UUID);
+    _diagChar = new GattCharacteristic(diagUUID, _diagValue, diagLength, sizeof(_diagValue),
+                                       GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ);
+#endif
 
     // 配置服务
-    GattCharacteristic *charTable[] = { _tremorChar, _dyskinesiaChar, _fogChar };
+#if STAGE_TIMING_ENABLED
+    GattCharacteristic *charTable[] = { _frameChar, _rawChar, _logChar, _diagChar };
+#else
+    GattCharacteristic *charTable[] = { _frameChar, _rawChar, _logChar };
+#endif
     UUID pdServiceUUID(PD_SERVICE_UUID);
-    GattService pdService(pdServiceUUID, charTable, 3);
+    GattService pdService(pdServiceUUID, charTable, sizeof(charTable) / sizeof(charTable[0]));
 
     _ble.gattServer().addService(pdService);
 
@@ -116,34 +159,312 @@ void BLEService::onConnectionComplete(const ble::ConnectionCompleteEvent &event)
     if (event.getStatus() == BLE_ERROR_NONE) {
         printf("Device connected!\r\n");
         _connected = true;
+
+        ble::connection_handle_t handle = event.getConnectionHandle();
+
+        // 请求更大的 ATT MTU (上限由 cordio.desired-att-mtu 配置)，结果见 onAttMtuChange
+        _ble.gattClient().negotiateAttMtu(handle);
+
+        // 2M PHY: 控制器支持时请求，减少每字节空中时间; 数据长度扩展 (DLE) 由 Cordio 协议栈按
+        // cordio.rx-acl-buffer-size 自动协商，结果见 onDataLengthChange
+        if (_ble.gap().isFeatureSupported(ble::controller_supported_features_t::LE_2M_PHY)) {
+            ble::phy_set_t phys(false, true, false);
+            _ble.gap().setPhy(handle, &phys, &phys, ble::coded_symbol_per_bit_t::UNDEFINED);
+        }
+    }
+}
+
+void BLEService::onDataLengthChange(ble::connection_handle_t connectionHandle, uint16_t txSize, uint16_t rxSize) {
+    printf("Data length: tx %u, rx %u\r\n", txSize, rxSize);
+}
+
+void BLEService::onPhyUpdateComplete(ble_error_t status, ble::connection_handle_t connectionHandle,
+                                     ble::phy_t txPhy, ble::phy_t rxPhy) {
+    if (status == BLE_ERROR_NONE) {
+        printf("PHY: tx %d, rx %d\r\n", txPhy.value(), rxPhy.value());
     }
 }
 
 void BLEService::onDisconnectionComplete(const ble::DisconnectionCompleteEvent &event) {
     printf("Device disconnected. Restarting advertising...\r\n");
     _connected = false;
+    _attMtu = ATT_MTU_DEFAULT;
+    _downloading = false;       // 重连后由客户端写入续传位置
+    if (_rawStream != nullptr) {
+        // 停止压缩并丢弃未发送的包 (断开后原始数据不补发)
+        _rawStream->setEnabled(false);
+        _rawStream->setPayloadLimit(_attMtu - 3);
+        int length;
+        while (_rawStream->peek(&length) != nullptr) {
+            _rawStream->pop();
+        }
+    }
     startAdvertising();
 }
 
+void BLEService::onAttMtuChange(ble::connection_handle_t connectionHandle, uint16_t attMtuSize) {
+    _attMtu = (attMtuSize > ATT_MTU_MAX) ? ATT_MTU_MAX : attMtuSize;
+    if (_rawStream != nullptr) {
+        _rawStream->setPayloadLimit(_attMtu - 3);
+    }
+    printf("ATT MTU: %u\r\n", _attMtu);
+}
+
+void BLEService::onUpdatesEnabled(const GattUpdatesEnabledCallbackParams &params) {
+    // 客户端订阅后补发断开期间积累的记录，下一个结果无论是否变化都发布
+    if (params.attHandle == _frameChar->getValueHandle()) {
+        _policy.reset();
+        flushFrames();
+    }
+    // 订阅原始数据流即开始压缩，取消订阅即停止
+    if (params.attHandle == _rawChar->getValueHandle() && _rawStream != nullptr) {
+        _rawStream->setPayloadLimit(_attMtu - 3);
+        _rawStream->setEnabled(true);
+        printf("Raw stream started\r\n");
+    }
+}
+
+void BLEService::onUpdatesDisabled(const GattUpdatesDisabledCallbackParams &params) {
+    if (params.attHandle == _rawChar->getValueHandle() && _rawStream != nullptr) {
+        _rawStream->setEnabled(false);
+        printf("Raw stream stopped\r\n");
+    }
+}
+
+void BLEService::onDataSent(const GattDataSentCallbackParams &params) {
+    // 协议栈发送缓冲区有空位，继续发送积压的包
+    if (_rawStream != nullptr && _rawStream->getPendingPackets() > 0) {
+        flushRawStream();
+    }
+    if (_frames.getPending() > 0 && !_flushScheduled) {
+        flushFrames();
+    }
+    if (_downloading) {
+        flushDownload();
+    }
+}
+
+void BLEService::onDataWritten(const GattWriteCallbackParams &params) {
+    // 客户端写入 u32 起始序号 (上次收到的最后一条 + 1) 开始下载
+    if (_logChar == nullptr || params.handle != _logChar->getValueHandle() || _eventLog == nullptr) return;
+    if (params.len < 4) return;
+
+    _downloadCursor = params.data[0] | (params.data[1] << 8) | (params.data[2] << 16) | ((uint32_t)params.data[3] << 24);
+    _downloading = true;
+    printf("Log download from %lu\r\n", (unsigned long)_downloadCursor);
+    flushDownload();
+}
+
+void BLEService::flushDownload() {
+    if (!_connected || _eventLog == nullptr) return;
+
+    // 写线程正在写入 (可能在擦除扇区) 时不等待，稍后在事件线程上重试
+    if (!_eventLogLock->trylock()) {
+        if (!_downloadRetryScheduled) {
+            _downloadRetryScheduled = true;
+            if (_event_queue.call_in(std::chrono::milliseconds(EVENT_LOG_RETRY_MS), this, &BLEService::onDownloadRetry) == 0) {
+                _downloadRetryScheduled = false;
+            }
+        }
+        return;
+    }
+
+    DeepSleepLock lock;
+    while (_downloading) {
+        uint32_t next;
+        int length = _eventLog->encodeChunk(_downloadCursor, _logValue, _attMtu - 3, &next);
+        if (_ble.gattServer().write(_logChar->getValueHandle(), _logValue, length) != BLE_ERROR_NONE) {
+            break;      // 协议栈缓冲区满，onDataSent 时从同一位置继续
+        }
+        _downloadCursor = next;
+        _logChunksSent++;
+        if (_logValue[1] == 0) {
+            _downloading = false;   // 已发送结束块
+        }
+    }
+    _eventLogLock->unlock();
+}
+
+void BLEService::onDownloadRetry() {
+    _downloadRetryScheduled = false;
+    if (_downloading) {
+        flushDownload();
+    }
+}
+
+void BLEService::attachRawStream(RawStreamer *streamer) {
+    _rawStream = streamer;
+    _rawStream->setReadyCallback(&BLEService::onRawPacketReady, this);
+}
+
+void BLEService::attachEventLog(EventLog *log, EventLogQueue *queue, Mutex *lock) {
+    _eventLog = log;
+    _eventLogQueue = queue;
+    _eventLogLock = lock;
+}
+
+void BLEService::onRawPacketReady(void *context) {
+    // 采集线程: 只在没有待处理的发送任务时投递一次，开销固定
+    BLEService *self = (BLEService *)context;
+    if (!core_util_atomic_exchange_bool(&self->_rawFlushPending, true)) {
+        if (self->_event_queue.call(self, &BLEService::flushRawStream) == 0) {
+            self->_rawFlushPending = false;
+        }
+    }
+}
+
+void BLEService::flushRawStream() {
+    _rawFlushPending = false;
+    if (!_connected || _rawStream == nullptr) return;
+
+    DeepSleepLock lock;
+    int length;
+    const uint8_t *packet;
+    while ((packet = _rawStream->peek(&length)) != nullptr) {
+        if (_ble.gattServer().write(_rawChar->getValueHandle(), packet, length) != BLE_ERROR_NONE) {
+            _rawBackpressure++;     // onDataSent 时重试; 期间队列满则采集端丢弃样本
+            break;
+        }
+        _rawStream->pop();
+        _rawPacketsSent++;
+    }
+}
+
 void BLEService::updateData(DetectionResult result) {
-    if (!_connected) return;
+    DetectionRecord record;
+    record.sequence = (uint16_t)(result.sequence & 0xFFFF);
+    record.timestampMs = result.timestampMs;
+    record.tremorDetected = result.tremorDetected;
+    record.tremorIntensity = result.tremorIntensity;
+    record.dyskinesiaDetected = result.dyskinesiaDetected;
+    record.dyskinesiaIntensity = result.dyskinesiaIntensity;
+    record.fogDetected = result.fogDetected;
+    record.motionState = (uint8_t)result.motionState;
+    record.dominantAxis = (int8_t)result.dominantAxis;
+
+    // 队列操作和 GATT 写入只在 BLE 事件线程进行; BLE 线程来不及时丢弃结果，不阻塞分析线程
+    // 未连接时记录同样入队，重连后可补发
+    if (core_util_atomic_incr_s32(&_pendingUpdates, 1) > BLE_RESULT_QUEUE_DEPTH
+        || _event_queue.call(this, &BLEService::writeRecord, record) == 0) {
+        core_util_atomic_decr_s32(&_pendingUpdates, 1);
+        _droppedUpdates++;
+    }
+}
+
+void BLEService::writeRecord(DetectionRecord record) {
+    core_util_atomic_decr_s32(&_pendingUpdates, 1);
+#if STAGE_TIMING_ENABLED
+    uint32_t start = timing::now();
+    publishRecord(record);
+    timing::record(timing::STAGE_PUBLISH, timing::now() - start);
+    refreshDiagnostics();
+#else
+    publishRecord(record);
+#endif
+}
+
+#if STAGE_TIMING_ENABLED
+void BLEService::refreshDiagnostics() {
+    // 只更新本地值，不发送通知
+    if (_diagChar == nullptr) return;
+    int length = timing::encodeStats(_diagValue);
+    _ble.gattServer().write(_diagChar->getValueHandle(), _diagValue, length, true);
+}
+#endif
+
+void BLEService::publishRecord(const DetectionRecord &record) {
+    // 未变化的结果不入队 (断开期间同样筛选，重连后只补发有变化的记录)
+    if (!_policy.offer(record)) {
+        return;
+    }
+    // 交给写线程写入 flash 日志 (与连接状态无关)，断开期间的记录由客户端下载补齐
+    if (_eventLogQueue != nullptr) {
+        _eventLogQueue->push(record);
+    }
+    // 等待速率限制或断开期间，只有强度变化的记录替换队尾，翻转的记录全部保留
+    _frames.pushLatest(record);
+    flushFrames();
+}
+
+void BLEService::flushFrames() {
+    if (!_connected || _frames.getPending() == 0) return;
+
+    // 最大通知速率: 间隔未到时定时重试，期间到达的记录在队列中等待
+    uint32_t now = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(_clock.elapsed_time()).count();
+    uint32_t delay = _policy.notifyDelay(now);
+    if (delay > 0) {
+        scheduleFlush(delay);
+        return;
+    }
+
+    // 每次通知按协商的 MTU 装入尽可能多的积压记录 (通知速率受限，批量不能再设上限)
+    int payloadLimit = _attMtu - 3;
+    int batch = frame::recordsPerPayload(payloadLimit);
+    if (batch < 1) {
+        return;
+    }
+
+    DeepSleepLock lock;
+    int records = 0;
+    int length = _frames.encodePending(_frameValue, payloadLimit, batch, &records);
+    if (_ble.gattServer().write(_frameChar->getValueHandle(), _frameValue, length) != BLE_ERROR_NONE) {
+        return;     // 协议栈发送缓冲区满，保留记录，onDataSent 时重试
+    }
+    _frames.markSent(records);
+    _notifications++;
+    _policy.notified(now);
 
-    // 更新 Tremor 数据
-    _tremorValue[0] = result.tremorDetected ? 1 : 0;
-    memcpy(&_tremorValue[1], &result.tremorIntensity, sizeof(float));
-    _ble.gattServer().write(_tremorChar->getValueHandle(), _tremorValue, 5);
+    // 还有积压 (重连补发) 时按最大速率继续发送
+    if (_frames.getPending() > 0) {
+        scheduleFlush(BLE_MIN_NOTIFY_INTERVAL_MS);
+    }
+}
 
-    // 更新 Dyskinesia 数据
-    _dyskinesiaValue[0] = result.dyskinesiaDetected ? 1 : 0;
-    memcpy(&_dyskinesiaValue[1], &result.dyskinesiaIntensity, sizeof(float));
-    _ble.gattServer().write(_dyskinesiaChar->getValueHandle(), _dyskinesiaValue, 5);
+void BLEService::scheduleFlush(uint32_t delayMs) {
+    // 同一时间只有一个定时发送任务
+    if (_flushScheduled) return;
+    _flushScheduled = true;
+    if (_event_queue.call_in(std::chrono::milliseconds(delayMs), this, &BLEService::onFlushTimer) == 0) {
+        _flushScheduled = false;
+        return;
+    }
+    _policy.countDeferral();
+}
 
-    // 更新 FOG 数据
-    _fogValue[0] = result.fogDetected ? 1 : 0;
-    _fogValue[1] = (uint8_t)result.motionState;
-    _ble.gattServer().write(_fogChar->getValueHandle(), _fogValue, 2);
+void BLEService::onFlushTimer() {
+    _flushScheduled = false;
+    flushFrames();
 }
 
 bool BLEService::isConnected() {
     return _connected;
 }
+
+uint32_t BLEService::getDroppedUpdates() {
+    // 事件队列满丢弃的结果 + 断开过久被覆盖的记录
+    return _droppedUpdates + _frames.getDropped();
+}
+
+uint32_t BLEService::getNotifications() {
+    return _notifications;
+}
+
+uint32_t BLEService::getSuppressedUpdates() {
+    return _policy.getSuppressed();
+}
+
+uint32_t BLEService::getDeferredNotifications() {
+    return _policy.getDeferred();
+}
+
+uint32_t BLEService::getRawPacketsSent() {
+    return _rawPacketsSent;
+}
+
+uint32_t BLEService::getRawBackpressure() {
+    return _rawBackpressure;
+}
+
+uint32_t BLEService::getLogChunksSent() {
+    return _logChunksSent;
+}
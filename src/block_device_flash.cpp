@@ -0,0 +1,39 @@
+#include "block_device_flash.h"
+
+BlockDeviceFlash::BlockDeviceFlash(mbed::BlockDevice& blockDevice) : device(blockDevice) {
+    initialized = false;
+}
+
+bool BlockDeviceFlash::init() {
+    if (!initialized) {
+        initialized = (device.init() == BD_ERROR_OK);
+    }
+    return initialized;
+}
+
+bool BlockDeviceFlash::read(uint32_t addr, void* data, uint32_t size) {
+    DeepSleepLock lock;
+    return device.read(data, addr, size) == BD_ERROR_OK;
+}
+
+bool BlockDeviceFlash::program(uint32_t addr, const void* data, uint32_t size) {
+    DeepSleepLock lock;
+    return device.program(data, addr, size) == BD_ERROR_OK;
+}
+
+bool BlockDeviceFlash::erase(uint32_t addr, uint32_t size) {
+    DeepSleepLock lock;
+    return device.erase(addr, size) == BD_ERROR_OK;
+}
+
+uint32_t BlockDeviceFlash::getProgramSize() {
+    return (uint32_t)device.get_program_size();
+}
+
+uint32_t BlockDeviceFlash::getEraseSize() {
+    return (uint32_t)device.get_erase_size();
+}
+
+uint32_t BlockDeviceFlash::getSize() {
+    return (uint32_t)device.size();
+}
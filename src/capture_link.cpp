@@ -0,0 +1,178 @@
+#include "capture_link.h"
+
+#if !DEVICE_SERIAL_ASYNCH
+#error "CaptureLink 需要异步串口 (DEVICE_SERIAL_ASYNCH)"
+#endif
+
+CaptureLink::CaptureLink(PinName tx, PinName rx, int baud) : SerialBase(tx, rx, baud) {
+    txHead = 0;
+    txTail = 0;
+    txLength = 0;
+    sampleOpen = false;
+    samplePackets = 0;
+    memset(&session, 0, sizeof(session));
+    sessionValid = false;
+    packetsSent = 0;
+    packetsDropped = 0;
+    bytesQueued = 0;
+
+    // 目标支持时由 DMA 搬运 (STM32 的 HAL 实现按中断逐字节发送)，两种方式调用者都不等待
+    set_dma_usage_tx(DMA_USAGE_OPPORTUNISTIC);
+}
+
+bool CaptureLink::enqueue(uint8_t type, const uint8_t* payload, int len) {
+    uint8_t encoded[capture::MAX_ENCODED_SIZE];
+    int encodedLength = capture::encodePacket(type, payload, len, encoded);
+    if (encodedLength < 0) {
+        return false;
+    }
+
+    // 临界区内只复制整包 (最多约 250 字节)，多个线程的包不会交错
+    core_util_critical_section_enter();
+    uint32_t head = txHead;
+    bool fits = (uint32_t)encodedLength <= CAPTURE_TX_BUFFER_SIZE - (head - txTail);
+    if (fits) {
+        for (int i = 0; i < encodedLength; i++) {
+            txBuffer[(head + i) & (CAPTURE_TX_BUFFER_SIZE - 1)] = encoded[i];
+        }
+        txHead = head + encodedLength;
+        packetsSent++;
+        bytesQueued += encodedLength;
+        if (txLength == 0) {
+            startTransmit();
+        }
+    } else {
+        packetsDropped++;
+    }
+    core_util_critical_section_exit();
+    return fits;
+}
+
+void CaptureLink::startTransmit() {
+    uint32_t tail = txTail;
+    uint32_t pending = txHead - tail;
+    if (pending == 0) {
+        txLength = 0;
+        return;
+    }
+    // 一次发送到缓冲区末尾为止的连续一段，回绕部分在下一次完成中断中发送
+    uint32_t offset = tail & (CAPTURE_TX_BUFFER_SIZE - 1);
+    uint32_t length = CAPTURE_TX_BUFFER_SIZE - offset;
+    if (length > pending) {
+        length = pending;
+    }
+    txLength = length;
+    if (SerialBase::write(&txBuffer[offset], (int)length, callback(this, &CaptureLink::onTransmitDone),
+                          SERIAL_EVENT_TX_COMPLETE) != 0) {
+        txLength = 0;       // 发送端忙 (不应发生): 下一个包入队时重试
+    }
+}
+
+void CaptureLink::onTransmitDone(int event) {
+    txTail = txTail + txLength;
+    startTransmit();
+}
+
+void CaptureLink::setSession(const sessionfile::SessionInfo& info) {
+    session = info;
+    sessionValid = true;
+    uint8_t payload[capture::SESSION_PAYLOAD_SIZE];
+    int len = capture::encodeSession(session, payload);
+    enqueue(capture::PACKET_SESSION, payload, len);
+}
+
+void CaptureLink::pushSample(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex) {
+    if (!sampleOpen) {
+        encoder.begin(samplePayload, capture::MAX_PAYLOAD, sampleIndex);
+        sampleOpen = true;
+    }
+    encoder.add(x, y, z);
+    if (encoder.isFull() || encoder.getCount() >= rawstream::MAX_SAMPLES_PER_PACKET) {
+        flushSamples();
+    }
+}
+
+void CaptureLink::flushSamples() {
+    if (!sampleOpen) {
+        return;
+    }
+    sampleOpen = false;
+    int len = encoder.finish();
+    enqueue(capture::PACKET_SAMPLES, samplePayload, len);
+
+    // 定期重发会话信息，接收端中途接入时也能建立会话文件
+    samplePackets++;
+    if (sessionValid && samplePackets % capture::SESSION_RESEND_PACKETS == 0) {
+        uint8_t payload[capture::SESSION_PAYLOAD_SIZE];
+        int sessionLength = capture::encodeSession(session, payload);
+        enqueue(capture::PACKET_SESSION, payload, sessionLength);
+    }
+}
+
+void CaptureLink::sendDetection(const DetectionResult& result) {
+    DetectionRecord record;
+    record.sequence = (uint16_t)(result.sequence & 0xFFFF);
+    record.timestampMs = result.timestampMs;
+    record.tremorDetected = result.tremorDetected;
+    record.tremorIntensity = result.tremorIntensity;
+    record.dyskinesiaDetected = result.dyskinesiaDetected;
+    record.dyskinesiaIntensity = result.dyskinesiaIntensity;
+    record.fogDetected = result.fogDetected;
+    record.motionState = (uint8_t)result.motionState;
+    record.dominantAxis = (int8_t)result.dominantAxis;
+
+    uint8_t payload[frame::RECORD_SIZE];
+    frame::encodeRecord(record, payload);
+    enqueue(capture::PACKET_DETECTION, payload, frame::RECORD_SIZE);
+}
+
+ssize_t CaptureLink::write(const void* buffer, size_t size) {
+    const uint8_t* data = (const uint8_t*)buffer;
+    size_t sent = 0;
+    while (sent < size) {
+        size_t chunk = size - sent;
+        if (chunk > (size_t)capture::MAX_PAYLOAD) {
+            chunk = capture::MAX_PAYLOAD;
+        }
+        enqueue(capture::PACKET_CONSOLE, data + sent, (int)chunk);
+        sent += chunk;
+    }
+    // 丢弃的控制台输出也按已写入返回 (同串口满时的行为，调用者不重试)
+    return (ssize_t)size;
+}
+
+ssize_t CaptureLink::read(void* buffer, size_t size) {
+    if (size == 0 || !SerialBase::readable()) {
+        return -EAGAIN;
+    }
+    *(char*)buffer = (char)_base_getc();
+    return 1;
+}
+
+off_t CaptureLink::seek(off_t offset, int whence) {
+    return -ESPIPE;
+}
+
+int CaptureLink::close() {
+    return 0;
+}
+
+bool CaptureLink::readable() const {
+    return const_cast<CaptureLink*>(this)->SerialBase::readable();
+}
+
+int CaptureLink::isatty() {
+    return true;
+}
+
+uint32_t CaptureLink::getPacketsSent() {
+    return packetsSent;
+}
+
+uint32_t CaptureLink::getPacketsDropped() {
+    return packetsDropped;
+}
+
+uint32_t CaptureLink::getBytesQueued() {
+    return bytesQueued;
+}
@@ -0,0 +1,178 @@
+#include "detection_frame.h"
+
+namespace frame {
+
+uint16_t quantizeIntensity(float intensity) {
+    float scaled = intensity * INTENSITY_SCALE + 0.5f;
+    if (!(scaled > 0.0f)) {
+        return 0;       // 负值和 NaN
+    }
+    if (scaled >= 65535.0f) {
+        return 65535;
+    }
+    return (uint16_t)scaled;
+}
+
+float dequantizeIntensity(uint16_t value) {
+    return value / INTENSITY_SCALE;
+}
+
+static void putU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+uint8_t stateOf(const DetectionRecord& record) {
+    uint8_t flags = 0;
+    if (record.tremorDetected) {
+        flags |= FLAG_TREMOR;
+    }
+    if (record.dyskinesiaDetected) {
+        flags |= FLAG_DYSKINESIA;
+    }
+    if (record.fogDetected) {
+        flags |= FLAG_FOG;
+    }
+    flags |= (uint8_t)((record.motionState & 0x03) << 3);
+    flags |= (uint8_t)(((record.dominantAxis + 1) & 0x03) << 5);
+    return flags;
+}
+
+void encodeRecord(const DetectionRecord& record, uint8_t* out) {
+    uint8_t flags = stateOf(record);
+
+    putU16(&out[0], record.sequence);
+    putU16(&out[2], (uint16_t)(record.timestampMs & 0xFFFF));
+    putU16(&out[4], (uint16_t)(record.timestampMs >> 16));
+    out[6] = flags;
+    putU16(&out[7], quantizeIntensity(record.tremorIntensity));
+    putU16(&out[9], quantizeIntensity(record.dyskinesiaIntensity));
+}
+
+void decodeRecord(const uint8_t* in, DetectionRecord* record) {
+    uint8_t flags = in[6];
+    record->sequence = getU16(&in[0]);
+    record->timestampMs = getU16(&in[2]) | ((uint32_t)getU16(&in[4]) << 16);
+    record->tremorDetected = (flags & FLAG_TREMOR) != 0;
+    record->dyskinesiaDetected = (flags & FLAG_DYSKINESIA) != 0;
+    record->fogDetected = (flags & FLAG_FOG) != 0;
+    record->motionState = (flags >> 3) & 0x03;
+    record->dominantAxis = (int8_t)(((flags >> 5) & 0x03) - 1);
+    record->tremorIntensity = dequantizeIntensity(getU16(&in[7]));
+    record->dyskinesiaIntensity = dequantizeIntensity(getU16(&in[9]));
+}
+
+int recordsPerPayload(int payloadLimit) {
+    int records = (payloadLimit - HEADER_SIZE) / RECORD_SIZE;
+    if (records > 255) {
+        records = 255;
+    }
+    return records > 0 ? records : 0;
+}
+
+int encodeBatch(const DetectionRecord* records, int count, uint8_t* out) {
+    out[0] = FRAME_VERSION;
+    out[1] = (uint8_t)count;
+    for (int i = 0; i < count; i++) {
+        encodeRecord(records[i], &out[HEADER_SIZE + i * RECORD_SIZE]);
+    }
+    return HEADER_SIZE + count * RECORD_SIZE;
+}
+
+int decodeBatch(const uint8_t* in, int len, DetectionRecord* records, int maxRecords) {
+    if (len < HEADER_SIZE || in[0] != FRAME_VERSION) {
+        return -1;
+    }
+    int count = in[1];
+    if (len != HEADER_SIZE + count * RECORD_SIZE || count > maxRecords) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        decodeRecord(&in[HEADER_SIZE + i * RECORD_SIZE], &records[i]);
+    }
+    return count;
+}
+
+}  // namespace frame
+
+DetectionFrameQueue::DetectionFrameQueue() {
+    clear();
+}
+
+void DetectionFrameQueue::clear() {
+    head = 0;
+    count = 0;
+    dropped = 0;
+    merged = 0;
+    hasLast = false;
+    lastState = 0;
+    tailMergeable = false;
+}
+
+void DetectionFrameQueue::push(const DetectionRecord& record) {
+    if (count == CAPACITY) {
+        // 覆盖最旧的未发送记录
+        head = (head + 1) % CAPACITY;
+        count--;
+        dropped++;
+    }
+    records[(head + count) % CAPACITY] = record;
+    count++;
+
+    uint8_t state = frame::stateOf(record);
+    tailMergeable = hasLast && state == lastState;
+    hasLast = true;
+    lastState = state;
+}
+
+void DetectionFrameQueue::pushLatest(const DetectionRecord& record) {
+    // 队尾未发送且不是翻转: 只有强度变化，新记录替换它 (序号缺口同被抑制的窗口)
+    if (count > 0 && tailMergeable && frame::stateOf(record) == lastState) {
+        records[(head + count - 1) % CAPACITY] = record;
+        merged++;
+        return;
+    }
+    push(record);
+}
+
+int DetectionFrameQueue::getPending() {
+    return count;
+}
+
+uint32_t DetectionFrameQueue::getDropped() {
+    return dropped;
+}
+
+uint32_t DetectionFrameQueue::getMerged() {
+    return merged;
+}
+
+int DetectionFrameQueue::encodePending(uint8_t* out, int payloadLimit, int maxRecords, int* records) {
+    int n = frame::recordsPerPayload(payloadLimit);
+    if (n > maxRecords) {
+        n = maxRecords;
+    }
+    if (n > count) {
+        n = count;
+    }
+
+    out[0] = frame::FRAME_VERSION;
+    out[1] = (uint8_t)n;
+    for (int i = 0; i < n; i++) {
+        frame::encodeRecord(this->records[(head + i) % CAPACITY], &out[frame::HEADER_SIZE + i * frame::RECORD_SIZE]);
+    }
+    *records = n;
+    return frame::HEADER_SIZE + n * frame::RECORD_SIZE;
+}
+
+void DetectionFrameQueue::markSent(int sent) {
+    if (sent > count) {
+        sent = count;
+    }
+    head = (head + sent) % CAPACITY;
+    count -= sent;
+}
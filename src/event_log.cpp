@@ -0,0 +1,355 @@
+#include "event_log.h"
+#include <cstring>
+
+namespace eventlog {
+
+uint8_t crc8(const uint8_t* data, int len) {
+    // CRC-8 (多项式 0x07)
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int recordsPerChunk(int payloadLimit) {
+    int records = (payloadLimit - CHUNK_HEADER_SIZE) / frame::RECORD_SIZE;
+    if (records > CHUNK_MAX_RECORDS) {
+        records = CHUNK_MAX_RECORDS;
+    }
+    return records > 0 ? records : 0;
+}
+
+static void putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+int decodeChunk(const uint8_t* in, int len, DetectionRecord* records, int maxRecords, uint32_t* firstIndex) {
+    if (len < CHUNK_HEADER_SIZE || in[0] != CHUNK_VERSION) {
+        return -1;
+    }
+    int count = in[1];
+    if (len != CHUNK_HEADER_SIZE + count * frame::RECORD_SIZE || count > maxRecords) {
+        return -1;
+    }
+    *firstIndex = getU32(&in[2]);
+    for (int i = 0; i < count; i++) {
+        frame::decodeRecord(&in[CHUNK_HEADER_SIZE + i * frame::RECORD_SIZE], &records[i]);
+    }
+    return count;
+}
+
+}  // namespace eventlog
+
+using namespace eventlog;
+
+static uint32_t roundUp(uint32_t value, uint32_t unit) {
+    return (value + unit - 1) / unit * unit;
+}
+
+EventLog::EventLog(FlashDevice& device) : flash(device) {
+    mounted = false;
+    sectorSize = 0;
+    sectorCount = 0;
+    headerSize = 0;
+    entrySize = 0;
+    entriesPerSector = 0;
+    headSeq = 0;
+    headSlot = 0;
+    tailSeq = 0;
+    appended = 0;
+    erases = 0;
+    writeErrors = 0;
+    corruptEntries = 0;
+}
+
+uint32_t EventLog::sectorAddress(uint32_t seq) {
+    return (seq % sectorCount) * sectorSize;
+}
+
+bool EventLog::readSectorSeq(uint32_t sector, uint32_t* seq) {
+    uint8_t header[SECTOR_HEADER_SIZE];
+    if (!flash.read(sector * sectorSize, header, SECTOR_HEADER_SIZE)) {
+        return false;
+    }
+    uint32_t magic = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+    *seq = header[4] | (header[5] << 8) | (header[6] << 16) | ((uint32_t)header[7] << 24);
+    // 扇区位置必须与序号对应，否则是旧格式或损坏的数据
+    return magic == SECTOR_MAGIC && *seq % sectorCount == sector;
+}
+
+bool EventLog::isErased(const uint8_t* entry) {
+    for (uint32_t i = 0; i < entrySize; i++) {
+        if (entry[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EventLog::openSector(uint32_t seq) {
+    // 擦除下一个扇区 (若仍有旧记录则丢弃最旧的一个扇区)，写入扇区头
+    uint32_t addr = sectorAddress(seq);
+    erases++;
+    if (!flash.erase(addr, sectorSize)) {
+        writeErrors++;
+        return false;
+    }
+
+    uint8_t header[MAX_PROGRAM_SIZE > SECTOR_HEADER_SIZE ? MAX_PROGRAM_SIZE : SECTOR_HEADER_SIZE];
+    memset(header, 0xFF, sizeof(header));
+    uint32_t magic = SECTOR_MAGIC;
+    for (int i = 0; i < 4; i++) {
+        header[i] = (uint8_t)(magic >> (8 * i));
+        header[4 + i] = (uint8_t)(seq >> (8 * i));
+    }
+    if (!flash.program(addr, header, headerSize)) {
+        writeErrors++;
+        return false;
+    }
+
+    headSeq = seq;
+    headSlot = 0;
+    if (headSeq - tailSeq >= sectorCount) {
+        tailSeq = headSeq - sectorCount + 1;
+    }
+    return true;
+}
+
+bool EventLog::format() {
+    mounted = false;
+    tailSeq = 0;
+    if (!openSector(0)) {
+        return false;
+    }
+    mounted = true;
+    return true;
+}
+
+bool EventLog::mount() {
+    mounted = false;
+    sectorSize = flash.getEraseSize();
+    uint32_t programSize = flash.getProgramSize();
+    if (sectorSize == 0 || programSize == 0 || programSize > MAX_PROGRAM_SIZE) {
+        return false;
+    }
+    sectorCount = flash.getSize() / sectorSize;
+    headerSize = roundUp(SECTOR_HEADER_SIZE, programSize);
+    entrySize = roundUp(ENTRY_DATA_SIZE, programSize);
+    entriesPerSector = (sectorSize - headerSize) / entrySize;
+    if (sectorCount < 2 || entriesPerSector == 0) {
+        return false;
+    }
+
+    // 序号最大的有效扇区是正在写入的扇区
+    bool found = false;
+    uint32_t maxSeq = 0;
+    for (uint32_t sector = 0; sector < sectorCount; sector++) {
+        uint32_t seq;
+        if (readSectorSeq(sector, &seq) && (!found || seq > maxSeq)) {
+            maxSeq = seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        return format();
+    }
+
+    // 向前找连续的有效扇区 (擦除后掉电、未写入扇区头的扇区截断历史)
+    headSeq = maxSeq;
+    tailSeq = maxSeq;
+    while (tailSeq > 0 && headSeq - tailSeq + 1 < sectorCount) {
+        uint32_t seq;
+        if (!readSectorSeq((tailSeq - 1) % sectorCount, &seq) || seq != tailSeq - 1) {
+            break;
+        }
+        tailSeq--;
+    }
+
+    // 第一个全 0xFF 的条目是写入位置 (写了一半的条目不为空，读取时由 CRC 跳过)
+    uint32_t base = sectorAddress(headSeq) + headerSize;
+    headSlot = entriesPerSector;
+    for (uint32_t slot = 0; slot < entriesPerSector; slot++) {
+        if (!flash.read(base + slot * entrySize, readBuffer, entrySize)) {
+            return false;
+        }
+        if (isErased(readBuffer)) {
+            headSlot = slot;
+            break;
+        }
+    }
+
+    mounted = true;
+    return true;
+}
+
+bool EventLog::isMounted() {
+    return mounted;
+}
+
+bool EventLog::append(const DetectionRecord& record) {
+    if (!mounted) {
+        return false;
+    }
+    if (headSlot >= entriesPerSector && !openSector(headSeq + 1)) {
+        return false;
+    }
+
+    uint8_t entry[MAX_PROGRAM_SIZE];
+    memset(entry, 0xFF, sizeof(entry));
+    frame::encodeRecord(record, entry);
+    entry[frame::RECORD_SIZE] = crc8(entry, frame::RECORD_SIZE);
+
+    // 写入失败时槽位同样作废 (可能已写入一部分)
+    uint32_t addr = sectorAddress(headSeq) + headerSize + headSlot * entrySize;
+    headSlot++;
+    if (!flash.program(addr, entry, entrySize)) {
+        writeErrors++;
+        return false;
+    }
+    appended++;
+    return true;
+}
+
+int EventLog::encodeChunk(uint32_t index, uint8_t* out, int payloadLimit, uint32_t* nextIndex) {
+    uint32_t first = getFirstIndex();
+    uint32_t end = getNextIndex();
+    if (index < first) {
+        index = first;      // 请求的记录已被覆盖，从最旧的开始
+    }
+    if (index > end) {
+        index = end;
+    }
+
+    int maxRecords = recordsPerChunk(payloadLimit);
+    int count = 0;
+    uint32_t chunkFirst = index;
+
+    // 同一扇区内的连续条目一次读出; 遇到损坏条目时结束本块，保证块内序号连续
+    bool stop = !mounted;
+    while (!stop && index < end && count < maxRecords) {
+        uint32_t slot = index % entriesPerSector;
+        uint32_t n = entriesPerSector - slot;
+        if (n > end - index) {
+            n = end - index;
+        }
+        if (n > (uint32_t)(maxRecords - count)) {
+            n = maxRecords - count;
+        }
+        uint32_t addr = sectorAddress(index / entriesPerSector) + headerSize + slot * entrySize;
+        if (!flash.read(addr, readBuffer, n * entrySize)) {
+            break;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            const uint8_t* entry = &readBuffer[i * entrySize];
+            if (crc8(entry, frame::RECORD_SIZE) != entry[frame::RECORD_SIZE]) {
+                if (count > 0) {
+                    stop = true;
+                    break;
+                }
+                corruptEntries++;
+                index++;
+                chunkFirst = index;
+                continue;
+            }
+            memcpy(&out[CHUNK_HEADER_SIZE + count * frame::RECORD_SIZE], entry, frame::RECORD_SIZE);
+            count++;
+            index++;
+        }
+    }
+
+    out[0] = CHUNK_VERSION;
+    out[1] = (uint8_t)count;
+    putU32(&out[2], chunkFirst);
+    *nextIndex = index;
+    return CHUNK_HEADER_SIZE + count * frame::RECORD_SIZE;
+}
+
+uint32_t EventLog::getFirstIndex() {
+    return tailSeq * entriesPerSector;
+}
+
+uint32_t EventLog::getNextIndex() {
+    return headSeq * entriesPerSector + headSlot;
+}
+
+uint32_t EventLog::getCapacity() {
+    return (sectorCount - 1) * entriesPerSector;
+}
+
+uint32_t EventLog::getAppended() {
+    return appended;
+}
+
+uint32_t EventLog::getErases() {
+    return erases;
+}
+
+uint32_t EventLog::getWriteErrors() {
+    return writeErrors;
+}
+
+uint32_t EventLog::getCorruptEntries() {
+    return corruptEntries;
+}
+
+EventLogQueue::EventLogQueue() {
+    readyCallback = nullptr;
+    readyContext = nullptr;
+    reset();
+}
+
+void EventLogQueue::reset() {
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    dropped = 0;
+}
+
+bool EventLogQueue::push(const DetectionRecord& record) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    // acquire: 消费者对该槽的读取在释放之前完成
+    if (h - tail.load(std::memory_order_acquire) >= EVENT_LOG_QUEUE_SLOTS) {
+        dropped++;
+        return false;
+    }
+    slots[h % EVENT_LOG_QUEUE_SLOTS] = record;
+    // release: 记录内容先于 head 对消费者可见
+    head.store(h + 1, std::memory_order_release);
+    if (readyCallback != nullptr) {
+        readyCallback(readyContext);
+    }
+    return true;
+}
+
+bool EventLogQueue::pop(DetectionRecord* record) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t) {
+        return false;
+    }
+    *record = slots[t % EVENT_LOG_QUEUE_SLOTS];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+void EventLogQueue::setReadyCallback(RecordReadyCallback callback, void* context) {
+    readyCallback = callback;
+    readyContext = context;
+}
+
+int EventLogQueue::getPending() {
+    return (int)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
+
+uint32_t EventLogQueue::getDropped() {
+    return dropped;
+}
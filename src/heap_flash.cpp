@@ -0,0 +1,127 @@
+#include "heap_flash.h"
+#include <cstring>
+
+HeapFlash::HeapFlash(uint32_t totalSize, uint32_t sectorSize, uint32_t programUnit) {
+    size = totalSize;
+    eraseSize = sectorSize;
+    programSize = programUnit;
+    data = new uint8_t[size];
+    eraseCounts = new uint32_t[size / eraseSize];
+    memset(data, 0xFF, size);
+    memset(eraseCounts, 0, sizeof(uint32_t) * (size / eraseSize));
+    tornAfterBytes = -1;
+    violations = 0;
+    bytesRead = 0;
+    bytesProgrammed = 0;
+    pageSize = 256;
+    programPageUs = 0;
+    eraseSectorUs = 0;
+    elapsedUs = 0;
+}
+
+HeapFlash::~HeapFlash() {
+    delete[] data;
+    delete[] eraseCounts;
+}
+
+bool HeapFlash::aligned(uint32_t addr, uint32_t len, uint32_t unit) {
+    return addr % unit == 0 && len % unit == 0 && addr + len <= size && addr + len >= addr;
+}
+
+void HeapFlash::tearNextProgram(int32_t bytes) {
+    tornAfterBytes = bytes;
+}
+
+void HeapFlash::setLatency(uint32_t page, uint32_t programUs, uint32_t eraseUs) {
+    pageSize = page;
+    programPageUs = programUs;
+    eraseSectorUs = eraseUs;
+}
+
+uint64_t HeapFlash::getElapsedUs() {
+    return elapsedUs;
+}
+
+uint32_t HeapFlash::getEraseCount(uint32_t sector) {
+    return eraseCounts[sector];
+}
+
+uint32_t HeapFlash::getViolations() {
+    return violations;
+}
+
+uint32_t HeapFlash::getBytesRead() {
+    return bytesRead;
+}
+
+uint32_t HeapFlash::getBytesProgrammed() {
+    return bytesProgrammed;
+}
+
+bool HeapFlash::read(uint32_t addr, void* buffer, uint32_t len) {
+    if (addr + len > size || addr + len < addr) {
+        violations++;
+        return false;
+    }
+    memcpy(buffer, &data[addr], len);
+    bytesRead += len;
+    return true;
+}
+
+bool HeapFlash::program(uint32_t addr, const void* buffer, uint32_t len) {
+    if (!aligned(addr, len, programSize)) {
+        violations++;
+        return false;
+    }
+
+    const uint8_t* bytes = (const uint8_t*)buffer;
+    uint32_t written = len;
+    if (tornAfterBytes >= 0 && (uint32_t)tornAfterBytes < len) {
+        written = (uint32_t)tornAfterBytes;
+    }
+
+    for (uint32_t i = 0; i < written; i++) {
+        // NOR: 编程只能清零位，要置 1 必须先擦除
+        if ((bytes[i] & ~data[addr + i]) != 0) {
+            violations++;
+        }
+        data[addr + i] &= bytes[i];
+    }
+    bytesProgrammed += written;
+    // 跨越的每个 NOR 页各需一次编程
+    if (len > 0) {
+        uint32_t pages = (addr + len - 1) / pageSize - addr / pageSize + 1;
+        elapsedUs += (uint64_t)pages * programPageUs;
+    }
+
+    if (written < len) {
+        tornAfterBytes = -1;
+        return false;
+    }
+    return true;
+}
+
+bool HeapFlash::erase(uint32_t addr, uint32_t len) {
+    if (!aligned(addr, len, eraseSize)) {
+        violations++;
+        return false;
+    }
+    memset(&data[addr], 0xFF, len);
+    for (uint32_t sector = addr / eraseSize; sector < (addr + len) / eraseSize; sector++) {
+        eraseCounts[sector]++;
+        elapsedUs += eraseSectorUs;
+    }
+    return true;
+}
+
+uint32_t HeapFlash::getProgramSize() {
+    return programSize;
+}
+
+uint32_t HeapFlash::getEraseSize() {
+    return eraseSize;
+}
+
+uint32_t HeapFlash::getSize() {
+    return size;
+}
@@ -0,0 +1,204 @@
+#include "log_decoder.h"
+#include <cstring>
+
+namespace logdecode {
+
+static const char* const MESSAGE_FORMATS[tokenlog::NUM_MESSAGES] = {
+#define LOGDECODE_FORMAT(name, level, args, format) format,
+    LOG_MESSAGES(LOGDECODE_FORMAT)
+#undef LOGDECODE_FORMAT
+};
+
+const char* formatOf(uint16_t id) {
+    if (id >= tokenlog::NUM_MESSAGES) {
+        return nullptr;
+    }
+    return MESSAGE_FORMATS[id];
+}
+
+// 追加到输出: 超出 size 的部分截断，pos 仍按完整长度累加 (同 snprintf)
+static void append(char* out, int size, int* pos, const char* text, int len) {
+    for (int i = 0; i < len; i++) {
+        if (*pos + 1 < size) {
+            out[*pos] = text[i];
+        }
+        (*pos)++;
+    }
+}
+
+int formatRecord(char* out, int size, uint16_t id, const uint32_t* args, int count) {
+    const char* format = formatOf(id);
+    if (format == nullptr || count != tokenlog::argCountOf((tokenlog::MessageId)id)) {
+        return -1;
+    }
+
+    int pos = 0;
+    int next = 0;
+    const char* p = format;
+    while (*p != '\0') {
+        if (*p != '%') {
+            append(out, size, &pos, p, 1);
+            p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            append(out, size, &pos, "%", 1);
+            p += 2;
+            continue;
+        }
+
+        // 转换说明: 标志、宽度、精度原样保留，长度修饰符按参数类型重写
+        char spec[16];
+        int specLen = 0;
+        spec[specLen++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr && specLen < 10) {
+            spec[specLen++] = *p++;
+        }
+        while (*p == 'h' || *p == 'l' || *p == 'z') {
+            p++;
+        }
+        char conversion = *p;
+        if (conversion == '\0' || next >= count) {
+            return -1;
+        }
+        p++;
+
+        char text[64];
+        int textLen;
+        uint32_t word = args[next++];
+        if (strchr("di", conversion) != nullptr) {
+            spec[specLen++] = 'l';
+            spec[specLen++] = conversion;
+            spec[specLen] = '\0';
+            textLen = snprintf(text, sizeof(text), spec, (long)(int32_t)word);
+        } else if (strchr("uxXo", conversion) != nullptr) {
+            spec[specLen++] = 'l';
+            spec[specLen++] = conversion;
+            spec[specLen] = '\0';
+            textLen = snprintf(text, sizeof(text), spec, (unsigned long)word);
+        } else if (strchr("fFeEgG", conversion) != nullptr) {
+            spec[specLen++] = conversion;
+            spec[specLen] = '\0';
+            textLen = snprintf(text, sizeof(text), spec, (double)tokenlog::wordToFloat(word));
+        } else if (conversion == 'c') {
+            spec[specLen++] = conversion;
+            spec[specLen] = '\0';
+            textLen = snprintf(text, sizeof(text), spec, (int)(word & 0xFF));
+        } else {
+            return -1;
+        }
+        if (textLen < 0) {
+            return -1;
+        }
+        append(out, size, &pos, text, textLen < (int)sizeof(text) ? textLen : (int)sizeof(text) - 1);
+    }
+    if (next != count) {
+        return -1;
+    }
+    if (size > 0) {
+        out[pos < size ? pos : size - 1] = '\0';
+    }
+    return pos;
+}
+
+StreamDecoder::StreamDecoder(FILE* output) {
+    out = output;
+    length = 0;
+    frames = 0;
+    badFrames = 0;
+}
+
+// 普通文本: 去掉 '\r' 和其他控制字符 (坏帧的残余字节不会弄乱终端)
+void StreamDecoder::emitText(uint8_t byte) {
+    if (byte == '\n' || byte == '\t' || byte >= 0x20) {
+        fputc(byte, out);
+    }
+}
+
+void StreamDecoder::emitFrame() {
+    uint16_t id = (uint16_t)(frame[2] | (frame[3] << 8));
+    int count = (frame[1] - 2) / 4;
+    uint32_t args[tokenlog::MAX_ARGS] = {0};
+    for (int i = 0; i < count; i++) {
+        const uint8_t* p = frame + 4 + 4 * i;
+        args[i] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    char text[256];
+    if (formatRecord(text, sizeof(text), id, args, count) >= 0) {
+        fprintf(out, "%s\n", text);
+    } else {
+        // 消息表与固件不一致: 输出原始参数
+        fprintf(out, "<message %u:", (unsigned)id);
+        for (int i = 0; i < count; i++) {
+            fprintf(out, " %08lx", (unsigned long)args[i]);
+        }
+        fprintf(out, ">\n");
+    }
+}
+
+void StreamDecoder::feedByte(uint8_t byte) {
+    if (length == 0) {
+        if (byte == tokenlog::FRAME_START) {
+            frame[length++] = byte;
+        } else {
+            emitText(byte);
+        }
+        return;
+    }
+
+    frame[length++] = byte;
+    if (length == 2) {
+        int payload = byte;
+        if (payload < 2 || payload > 2 + 4 * tokenlog::MAX_ARGS || (payload - 2) % 4 != 0) {
+            // 不是帧: 起始字节按文本输出，长度字节重新处理
+            length = 0;
+            emitText(frame[0]);
+            feedByte(byte);
+        }
+        return;
+    }
+
+    int total = 3 + frame[1];
+    if (length < total) {
+        return;
+    }
+
+    length = 0;
+    if (tokenlog::crc8(frame + 1, total - 2) == frame[total - 1]) {
+        frames++;
+        emitFrame();
+        return;
+    }
+
+    // CRC 错误: 坏帧的字节不是文本，只在其中找下一个起始字节 (可能是下一帧的开头)，
+    // 从那里重新同步，之前的字节丢弃
+    badFrames++;
+    int next = 1;
+    while (next < total && frame[next] != tokenlog::FRAME_START) {
+        next++;
+    }
+    uint8_t rest[tokenlog::MAX_FRAME_SIZE];
+    int count = total - next;
+    memcpy(rest, frame + next, count);
+    for (int i = 0; i < count; i++) {
+        feedByte(rest[i]);
+    }
+}
+
+void StreamDecoder::feed(const uint8_t* data, int len) {
+    for (int i = 0; i < len; i++) {
+        feedByte(data[i]);
+    }
+}
+
+void StreamDecoder::finish() {
+    int pending = length;
+    length = 0;
+    for (int i = 0; i < pending; i++) {
+        emitText(frame[i]);
+    }
+    fflush(out);
+}
+
+}  // namespace logdecode
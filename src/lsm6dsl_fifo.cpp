@@ -0,0 +1,129 @@
+#include "lsm6dsl_fifo.h"
+
+using namespace lsm6dsl;
+
+Lsm6dslFifo::Lsm6dslFifo(SensorBus& sensorBus) : bus(sensorBus) {
+    watermark = 0;
+    overruns = 0;
+    transactions = 0;
+}
+
+bool Lsm6dslFifo::configure(int watermarkSamples) {
+    watermark = watermarkSamples;
+    int thresholdWords = watermarkSamples * WORDS_PER_SAMPLE;
+
+    // 先切到 Bypass 模式清空 FIFO
+    if (!bus.writeReg(FIFO_CTRL5, FIFO_MODE_BYPASS)) {
+        return false;
+    }
+
+    // 水位 (以 16 位字为单位)
+    if (!bus.writeReg(FIFO_CTRL1, (uint8_t)(thresholdWords & 0xFF))) {
+        return false;
+    }
+    if (!bus.writeReg(FIFO_CTRL2, (uint8_t)((thresholdWords >> 8) & 0x07))) {
+        return false;
+    }
+
+    // 只有加速度计入 FIFO，不抽取
+    if (!bus.writeReg(FIFO_CTRL3, FIFO_CTRL3_XL_NO_DEC)) {
+        return false;
+    }
+    if (!bus.writeReg(FIFO_CTRL4, 0x00)) {
+        return false;
+    }
+
+    // INT1 输出水位中断
+    if (!bus.writeReg(INT1_CTRL, INT1_FTH)) {
+        return false;
+    }
+
+    // FIFO ODR = 52Hz，连续模式 (满后覆盖最旧数据)
+    if (!bus.writeReg(FIFO_CTRL5, FIFO_ODR_52HZ | FIFO_MODE_CONTINUOUS)) {
+        return false;
+    }
+
+    transactions += 7;
+    return true;
+}
+
+bool Lsm6dslFifo::stop() {
+    transactions += 2;
+    return bus.writeReg(INT1_CTRL, 0x00) && bus.writeReg(FIFO_CTRL5, FIFO_MODE_BYPASS);
+}
+
+int Lsm6dslFifo::prepareBatch(int maxSamples) {
+    // 一次读取 FIFO_STATUS1..4: 未读字数、标志和 pattern
+    uint8_t status[4];
+    transactions++;
+    if (!bus.readRegs(FIFO_STATUS1, status, 4)) {
+        return -1;
+    }
+
+    if (status[1] & STATUS2_OVER_RUN) {
+        overruns++;
+    }
+    if (status[1] & STATUS2_EMPTY) {
+        return 0;
+    }
+
+    int words = status[0] | ((status[1] & 0x07) << 8);
+    if (words == 0) {
+        // DIFF_FIFO 只有 11 位，FIFO 全满 (2048 字) 时读数为 0 而 EMPTY 未置位
+        words = FIFO_WORDS;
+    }
+    int pattern = status[2] | ((status[3] & 0x03) << 8);
+
+    // 溢出覆盖后下一个字可能不是 x 轴，丢弃到下一个样本边界
+    int skip = (WORDS_PER_SAMPLE - pattern % WORDS_PER_SAMPLE) % WORDS_PER_SAMPLE;
+    if (skip > 0) {
+        uint8_t discard[2 * WORDS_PER_SAMPLE];
+        transactions++;
+        if (!bus.readRegs(FIFO_DATA_OUT_L, discard, 2 * skip)) {
+            return -1;
+        }
+        words -= skip;
+    }
+
+    int samples = words / WORDS_PER_SAMPLE;
+    if (samples > maxSamples) {
+        samples = maxSamples;
+    }
+    return samples;
+}
+
+bool Lsm6dslFifo::startBatchRead(int16_t* xyz, int samples, BusCompletion done, void* context) {
+    // 突发读取: 地址在 FIFO_DATA_OUT_H 之后自动回卷到 FIFO_DATA_OUT_L
+    transactions++;
+    return bus.readRegsAsync(FIFO_DATA_OUT_L, (uint8_t*)xyz, samples * WORDS_PER_SAMPLE * 2, done, context);
+}
+
+void Lsm6dslFifo::finishBatch(int16_t* xyz, int samples) {
+    // 小端字节转 int16 (原地转换，与 CPU 字节序无关)
+    const uint8_t* bytes = (const uint8_t*)xyz;
+    for (int i = 0; i < samples * WORDS_PER_SAMPLE; i++) {
+        xyz[i] = (int16_t)((bytes[2 * i + 1] << 8) | bytes[2 * i]);
+    }
+}
+
+int Lsm6dslFifo::readBatch(int16_t* xyz, int maxSamples) {
+    int samples = prepareBatch(maxSamples);
+    if (samples <= 0) {
+        return samples;
+    }
+
+    transactions++;
+    if (!bus.readRegs(FIFO_DATA_OUT_L, (uint8_t*)xyz, samples * WORDS_PER_SAMPLE * 2)) {
+        return -1;
+    }
+    finishBatch(xyz, samples);
+    return samples;
+}
+
+uint32_t Lsm6dslFifo::getOverruns() {
+    return overruns;
+}
+
+uint32_t Lsm6dslFifo::getTransactions() {
+    return transactions;
+}
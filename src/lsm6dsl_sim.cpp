@@ -0,0 +1,159 @@
+#include "lsm6dsl_sim.h"
+
+using namespace lsm6dsl;
+
+Lsm6dslSim::Lsm6dslSim() {
+    reset();
+}
+
+void Lsm6dslSim::reset() {
+    for (int i = 0; i < 128; i++) {
+        regs[i] = 0;
+    }
+    regs[WHO_AM_I] = WHO_AM_I_VALUE;
+    regs[CTRL3_C] = 0x04;   // 上电默认 IF_INC = 1
+
+    fifoHead = 0;
+    fifoCount = 0;
+    readPhase = 0;
+    highByteNext = false;
+    overrun = false;
+    readTransactions = 0;
+    writeTransactions = 0;
+}
+
+bool Lsm6dslSim::fifoEnabled() {
+    // 连续模式且 FIFO ODR 非零、加速度计入 FIFO
+    return (regs[FIFO_CTRL5] & 0x07) == FIFO_MODE_CONTINUOUS
+        && (regs[FIFO_CTRL5] & 0x78) != 0
+        && (regs[FIFO_CTRL3] & 0x07) != 0;
+}
+
+int Lsm6dslSim::thresholdWords() {
+    return regs[FIFO_CTRL1] | ((regs[FIFO_CTRL2] & 0x07) << 8);
+}
+
+void Lsm6dslSim::pushWord(uint16_t word) {
+    if (fifoCount == FIFO_WORDS) {
+        // 连续模式: 覆盖最旧的字
+        fifoHead = (fifoHead + 1) % FIFO_WORDS;
+        fifoCount--;
+        readPhase = (readPhase + 1) % WORDS_PER_SAMPLE;
+        overrun = true;
+    }
+    fifo[(fifoHead + fifoCount) % FIFO_WORDS] = word;
+    fifoCount++;
+}
+
+void Lsm6dslSim::pushSample(int16_t x, int16_t y, int16_t z) {
+    int16_t axes[3] = {x, y, z};
+    for (int i = 0; i < 3; i++) {
+        regs[OUTX_L_XL + 2 * i] = (uint8_t)(axes[i] & 0xFF);
+        regs[OUTX_L_XL + 2 * i + 1] = (uint8_t)((axes[i] >> 8) & 0xFF);
+    }
+
+    if (fifoEnabled()) {
+        for (int i = 0; i < 3; i++) {
+            pushWord((uint16_t)axes[i]);
+        }
+    }
+}
+
+bool Lsm6dslSim::isInt1Asserted() {
+    return (regs[INT1_CTRL] & INT1_FTH) && thresholdWords() > 0 && fifoCount >= thresholdWords();
+}
+
+int Lsm6dslSim::getFifoSamples() {
+    return fifoCount / WORDS_PER_SAMPLE;
+}
+
+uint32_t Lsm6dslSim::getReadTransactions() {
+    return readTransactions;
+}
+
+uint32_t Lsm6dslSim::getWriteTransactions() {
+    return writeTransactions;
+}
+
+uint8_t Lsm6dslSim::readByte(uint8_t reg) {
+    switch (reg) {
+        case FIFO_STATUS1:
+            return (uint8_t)(fifoCount & 0xFF);
+
+        case FIFO_STATUS2: {
+            uint8_t value = (uint8_t)((fifoCount >> 8) & 0x07);
+            if (thresholdWords() > 0 && fifoCount >= thresholdWords()) {
+                value |= STATUS2_WATERMARK;
+            }
+            if (overrun) {
+                value |= STATUS2_OVER_RUN;
+                overrun = false;
+            }
+            if (fifoCount == 0) {
+                value |= STATUS2_EMPTY;
+            }
+            return value;
+        }
+
+        case FIFO_STATUS3:
+            return (uint8_t)readPhase;
+
+        case FIFO_STATUS4:
+            return 0;
+
+        case FIFO_DATA_OUT_L:
+        case FIFO_DATA_OUT_H: {
+            if (fifoCount == 0) {
+                return 0;
+            }
+            uint16_t word = fifo[fifoHead];
+            if (!highByteNext) {
+                highByteNext = true;
+                return (uint8_t)(word & 0xFF);
+            }
+            // 读完高字节后出队
+            highByteNext = false;
+            fifoHead = (fifoHead + 1) % FIFO_WORDS;
+            fifoCount--;
+            readPhase = (readPhase + 1) % WORDS_PER_SAMPLE;
+            return (uint8_t)(word >> 8);
+        }
+
+        default:
+            return regs[reg & 0x7F];
+    }
+}
+
+bool Lsm6dslSim::writeReg(uint8_t reg, uint8_t value) {
+    writeTransactions++;
+    regs[reg & 0x7F] = value;
+
+    // 切换到 Bypass 模式时清空 FIFO
+    if (reg == FIFO_CTRL5 && (value & 0x07) == FIFO_MODE_BYPASS) {
+        fifoHead = 0;
+        fifoCount = 0;
+        readPhase = 0;
+        highByteNext = false;
+        overrun = false;
+    }
+    return true;
+}
+
+bool Lsm6dslSim::readRegs(uint8_t reg, uint8_t* data, int len) {
+    readTransactions++;
+    bool autoIncrement = (regs[CTRL3_C] & 0x04) != 0;
+
+    for (int i = 0; i < len; i++) {
+        data[i] = readByte(reg);
+        if (!autoIncrement) {
+            continue;
+        }
+        // FIFO_DATA_OUT_H 之后回卷到 FIFO_DATA_OUT_L
+        if (reg == FIFO_DATA_OUT_H) {
+            reg = FIFO_DATA_OUT_L;
+        } else {
+            reg++;
+        }
+    }
+    return true;
+}
@@ -3,9 +3,24 @@
 #include "sensor.h"
 #include "detector.h"
 #include "ble_service.h"
+#include "power_stats.h"
+#include "block_device_flash.h"
+#include "event_log.h"
+#include "raw_recorder.h"
+#include "stage_timing.h"
+#include "tokenlog.h"
+#include "capture_link.h"
+#include "SlicingBlockDevice.h"
 
 // 重定向 stdout 到硬件串口 (修复串口输出问题)
+// 启动信息和按需命令输出为文本，逐窗口日志为令牌帧 (主机端 logdecode 还原，文本原样透传)
+#if UART_CAPTURE_ENABLED
+// 有线采集: 控制台串口换为二进制采集链路 (更高波特率，异步发送)，文本和日志帧作为控制台包发送，
+// 主机端 capture_rx 写入会话文件
+CaptureLink pc(USBTX, USBRX, UART_CAPTURE_BAUD);
+#else
 UnbufferedSerial pc(USBTX, USBRX, 115200);
+#endif
 
 namespace mbed {
     FileHandle *mbed_override_console(int fd) {
@@ -17,13 +32,274 @@ namespace mbed {
 SensorManager sensor;
 Detector detector;
 BLEService bleService;
+RawStreamer rawStream;      // BLE 原始数据流 (客户端订阅时启用)
+
+// 事件日志: 板载 QSPI flash 开头的 EVENT_LOG_SIZE 字节
+SlicingBlockDevice logPartition(BlockDevice::get_default_instance(), 0, EVENT_LOG_SIZE);
+BlockDeviceFlash logFlash(logPartition);
+EventLog eventLog(logFlash);
+EventLogQueue eventLogQueue;
+Mutex eventLogLock;             // 写线程写入与 BLE 线程下载互斥 (BLE 线程只 trylock)
+EventFlags eventLogFlags;
+Thread eventLogThread(osPriorityBelowNormal, EVENT_LOG_THREAD_STACK_SIZE, nullptr, "eventlog");
+
+#if RAW_RECORDER_ENABLED
+// 原始数据记录: QSPI flash 中事件日志之后的全部空间
+SlicingBlockDevice recordPartition(BlockDevice::get_default_instance(), EVENT_LOG_SIZE, 0);
+BlockDeviceFlash recordFlash(recordPartition);
+RawRecorder rawRecorder(recordFlash);
+EventFlags recorderFlags;
+Thread recorderThread(osPriorityBelowNormal, RECORDER_THREAD_STACK_SIZE, nullptr, "recorder");
+#endif
+
+// 令牌化日志: 分析线程写入，日志线程 (低优先级) 编码后阻塞写串口
+tokenlog::LogRing logRing;
+EventFlags logFlags;
+Thread logThread(osPriorityLow, LOG_THREAD_STACK_SIZE, nullptr, "log");
 
 // LED
 DigitalOut led1(LED1);
 
+// 线程: 采集 (高优先级，由 FIFO 中断唤醒) -> 窗口队列 -> 分析 (普通优先级) -> BLE 事件线程
+Thread captureThread(osPriorityHigh, CAPTURE_THREAD_STACK_SIZE, nullptr, "capture");
+Thread analysisThread(osPriorityNormal, ANALYSIS_THREAD_STACK_SIZE, nullptr, "analysis");
+
 // 状态
 DetectionResult currentResult;
 
+// 检测器平台接口: 低功耗定时器 (不阻止深度睡眠，Timer 运行时会持有深度睡眠锁) 和串口输出
+LowPowerTimer detectorTimer;
+
+uint32_t detectorClock(void* context) {
+    return (uint32_t)(detectorTimer.elapsed_time().count() / 1000);
+}
+
+void detectorLog(void* context, uint16_t id, const uint32_t* args, int count) {
+    logRing.push((tokenlog::MessageId)id, args, count);
+}
+
+// 日志线程: 分析线程每个窗口唤醒一次 (不定时轮询，不影响 Stop 模式)，
+// 取出全部条目逐帧写串口; 丢弃的条目数作为一条消息补报
+void logTask() {
+    uint32_t reportedDrops = 0;
+    uint8_t frame[tokenlog::MAX_FRAME_SIZE];
+    uint32_t args[tokenlog::MAX_ARGS];
+    while (true) {
+        logFlags.wait_any(0x01);
+        tokenlog::MessageId id;
+        int count;
+        while (logRing.pop(&id, args, &count)) {
+            int len = tokenlog::encodeFrame(frame, id, args, count);
+            pc.write(frame, len);
+        }
+        uint32_t drops = logRing.getDropped();
+        if (drops != reportedDrops && tokenlog::isEnabled(tokenlog::LOG_DROPPED)) {
+            args[0] = drops - reportedDrops;
+            int len = tokenlog::encodeFrame(frame, tokenlog::LOG_DROPPED, args, 1);
+            pc.write(frame, len);
+        }
+        reportedDrops = drops;
+    }
+}
+
+#if STAGE_TIMING_ENABLED
+// 频谱计算完成的时刻 (分析线程中由检测器回调记录)
+uint32_t spectrumDoneUs = 0;
+
+void onSpectrumDone(void* context) {
+    spectrumDoneUs = timing::now();
+}
+
+// 阶段计时表: 每个阶段一行统计，一行非空的直方图桶 (下限 µs: 次数)
+void printStageTiming() {
+    printf("\r\n--- Stage timing (us) ---\r\n");
+    printf("%-8s %8s %8s %8s %8s\r\n", "stage", "count", "min", "mean", "max");
+    for (int s = 0; s < timing::NUM_STAGES; s++) {
+        timing::StageStats stats;
+        if (!timing::getStats((timing::Stage)s, &stats)) {
+            continue;
+        }
+        printf("%-8s %8lu %8lu %8lu %8lu\r\n", timing::stageName((timing::Stage)s),
+               (unsigned long)stats.count, (unsigned long)stats.minUs,
+               (unsigned long)timing::meanUs(stats), (unsigned long)stats.maxUs);
+        printf("        ");
+        for (int b = 0; b < timing::HISTOGRAM_BUCKETS; b++) {
+            if (stats.histogram[b] > 0) {
+                printf(" %lu:%lu", (unsigned long)timing::bucketLowerUs(b), (unsigned long)stats.histogram[b]);
+            }
+        }
+        printf("\r\n");
+    }
+    printf("-------------------------\r\n");
+}
+
+// 串口命令: 分析线程每个窗口轮询一次，不阻塞
+// 接收中断会持有深度睡眠锁，因此不使用; Stop 模式下 UART 不接收，按键可能需要重复
+void pollSerialCommands() {
+    while (pc.readable()) {
+        char command;
+        if (pc.read(&command, 1) != 1) {
+            break;
+        }
+        if (command == 't') {
+            printStageTiming();
+        } else if (command == 'z') {
+            timing::reset();
+            printf("Stage timing reset\r\n");
+        }
+    }
+}
+#endif
+
+#if RAW_RECORDER_ENABLED
+// 记录块时间戳: 上电以来的 ms (RTOS 内核时钟，采集线程中调用)
+uint32_t recorderClock() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(Kernel::Clock::now().time_since_epoch()).count();
+}
+
+// 采集线程: 一块写满，唤醒记录线程
+void onRecorderBlockReady(void* context) {
+    recorderFlags.set(0x01);
+}
+
+// 记录线程 (低优先级): CRC + flash 擦除/编程，期间采集照常进行
+void recorderTask() {
+    while (true) {
+        recorderFlags.wait_any(0x01);
+        while (rawRecorder.service()) {
+        }
+    }
+}
+#endif
+
+// BLE 事件线程: 发布的记录已入队，唤醒事件日志写线程
+void onEventLogRecord(void* context) {
+    eventLogFlags.set(0x01);
+}
+
+// 事件日志写线程 (低优先级): flash 编程和扇区擦除，期间 BLE 事件照常处理
+void eventLogTask() {
+    DetectionRecord record;
+    while (true) {
+        eventLogFlags.wait_any(0x01);
+        while (eventLogQueue.pop(&record)) {
+            eventLogLock.lock();
+            eventLog.append(record);
+            eventLogLock.unlock();
+        }
+    }
+}
+
+// 采集线程: 只搬运数据，分析负载不影响采样时序
+void captureTask() {
+    while (true) {
+        // 等待 FIFO 水位中断或异步传输完成 (线程阻塞，RTOS 可进入睡眠)
+        sensor.waitForData();
+
+        // 处理本批全部样本; 窗口就绪时复制到队列并唤醒分析线程
+        while (sensor.update()) {
+        }
+    }
+}
+
+// 分析线程: 依次分析就绪的窗口
+void analysisTask() {
+    while (true) {
+        AnalysisWindow* window = sensor.waitForWindow();
+#if STAGE_TIMING_ENABLED
+        uint32_t reportStart = timing::now();
+#endif
+        logRing.write<tokenlog::WINDOW_READY>(window->sequence);
+
+        // 前几个样本
+        logRing.write<tokenlog::FIRST_SAMPLES>(windowMagnitude(*window, 0), windowMagnitude(*window, 1),
+                                                windowMagnitude(*window, 2), windowMagnitude(*window, 3),
+                                                windowMagnitude(*window, 4));
+
+        // 运行检测器分析 (窗口/步长活动统计用于 FOG 检测)
+#if STAGE_TIMING_ENABLED
+        uint32_t analysisStart = timing::now();
+        uint32_t reportUs = analysisStart - reportStart;
+        spectrumDoneUs = analysisStart;
+        currentResult = detector.analyzeWindow(*window);
+        uint32_t analysisEnd = timing::now();
+        timing::record(timing::STAGE_FFT, spectrumDoneUs - analysisStart);
+        timing::record(timing::STAGE_DETECT, analysisEnd - spectrumDoneUs);
+#else
+        currentResult = detector.analyzeWindow(*window);
+#endif
+
+        // 归还窗口槽
+        sensor.releaseWindow();
+
+        // 更新 BLE 数据
+        bleService.updateData(currentResult);
+#if UART_CAPTURE_ENABLED
+        pc.sendDetection(currentResult);
+#endif
+        
+        // LED 指示
+        if (currentResult.tremorDetected || 
+            currentResult.dyskinesiaDetected || 
+            currentResult.fogDetected) {
+            led1 = !led1;  // 检测到异常时闪烁
+        } else {
+            led1 = 1;  // 正常时常亮
+        }
+        
+        // 结果摘要 (写入日志缓冲区后唤醒日志线程)
+#if STAGE_TIMING_ENABLED
+        reportStart = timing::now();
+#endif
+        logRing.write<tokenlog::DETECTION_SUMMARY>(
+            currentResult.tremorDetected, currentResult.tremorIntensity,
+            currentResult.dyskinesiaDetected, currentResult.dyskinesiaIntensity,
+            currentResult.fogDetected, currentResult.motionState);
+        if (currentResult.dominantAxis >= 0) {
+            logRing.write<tokenlog::AXIS_PEAKS>(
+                currentResult.axisPeaks[0].frequency, currentResult.axisPeaks[0].magnitude,
+                currentResult.axisPeaks[1].frequency, currentResult.axisPeaks[1].magnitude,
+                currentResult.axisPeaks[2].frequency, currentResult.axisPeaks[2].magnitude,
+                "XYZ"[currentResult.dominantAxis]);
+        }
+        if (sensor.getWindowOverruns() > 0 || sensor.getFifoOverruns() > 0 || bleService.getDroppedUpdates() > 0) {
+            logRing.write<tokenlog::OVERRUNS>(sensor.getWindowOverruns(), sensor.getFifoOverruns(),
+                                              bleService.getDroppedUpdates());
+        }
+        logRing.write<tokenlog::BLE_STATS>(bleService.getNotifications(), bleService.getSuppressedUpdates(),
+                                           bleService.getDeferredNotifications());
+        if (eventLog.isMounted()) {
+            logRing.write<tokenlog::EVENT_LOG_STATS>(eventLog.getNextIndex(), eventLog.getErases(),
+                                                     eventLog.getWriteErrors(), eventLogQueue.getDropped(),
+                                                     bleService.getLogChunksSent());
+        }
+#if RAW_RECORDER_ENABLED
+        logRing.write<tokenlog::RECORDER_STATS>(rawRecorder.getSamplesRecorded(), rawRecorder.getSamplesDropped(),
+                                                rawRecorder.getNextBlock(), rawRecorder.getBlockCount(),
+                                                rawRecorder.isFull());
+#endif
+        if (rawStream.isEnabled()) {
+            logRing.write<tokenlog::RAW_STREAM_STATS>(
+                rawStream.getSamplesEncoded(),
+                rawStream.getSamplesEncoded() > 0 ? (float)rawStream.getBytesProduced() / rawStream.getSamplesEncoded() : 0.0f,
+                bleService.getRawPacketsSent(), rawStream.getSamplesDropped(), bleService.getRawBackpressure());
+        }
+        SleepStats sleepStats;
+        power::getSleepStats(&sleepStats);
+        logRing.write<tokenlog::SLEEP_STATS>(sleepStats.deepSleepEntries, power::deepSleepPercent(sleepStats),
+                                             sleepStats.sleepEntries);
+#if UART_CAPTURE_ENABLED
+        logRing.write<tokenlog::CAPTURE_STATS>(pc.getPacketsSent(), pc.getBytesQueued(), pc.getPacketsDropped());
+#endif
+        logFlags.set(0x01);
+#if STAGE_TIMING_ENABLED
+        reportUs += timing::now() - reportStart;
+        timing::record(timing::STAGE_REPORT, reportUs);
+        pollSerialCommands();
+#endif
+    }
+}
+
 int main() {
     // 等待串口稳定
     ThisThread::sleep_for(1000ms);
@@ -34,6 +310,13 @@ int main() {
     printf("STM32L475 Discovery Kit IoT\r\n");
     printf("=================================\r\n\r\n");
     
+    detectorTimer.start();
+    detector.setClock(detectorClock, nullptr);
+    detector.setLogSink(detectorLog, nullptr);
+#if STAGE_TIMING_ENABLED
+    detector.setSpectrumMark(onSpectrumDone, nullptr);
+#endif
+    
     // 初始化传感器
     printf("Initializing sensor...\r\n");
     if (!sensor.begin()) {
@@ -44,10 +327,56 @@ int main() {
         }
     }
     
+    // 挂载事件日志 (失败时只是不记录，不影响检测)
+    printf("Mounting event log...\r\n");
+    if (logFlash.init() && eventLog.mount()) {
+        printf("Event log: records %lu..%lu, capacity %lu\r\n",
+               (unsigned long)eventLog.getFirstIndex(),
+               (unsigned long)eventLog.getNextIndex(),
+               (unsigned long)eventLog.getCapacity());
+        eventLogQueue.setReadyCallback(onEventLogRecord, nullptr);
+        bleService.attachEventLog(&eventLog, &eventLogQueue, &eventLogLock);
+    } else {
+        printf("WARNING: Event log unavailable\r\n");
+    }
+    
+#if RAW_RECORDER_ENABLED
+    // 每次上电开始一个新会话，接在已记录的数据之后
+    if (recordFlash.init() && rawRecorder.mount()
+        && rawRecorder.startSession(lsm6dsl::WHO_AM_I_VALUE, 0, recorderClock(), (uint32_t)time(nullptr))) {
+        rawRecorder.setClock(recorderClock);
+        rawRecorder.setReadyCallback(onRecorderBlockReady, nullptr);
+        sensor.setRecorder(&rawRecorder);
+        printf("Recording session %lu (block %lu of %lu)\r\n",
+               (unsigned long)rawRecorder.getSessionId(),
+               (unsigned long)rawRecorder.getNextBlock(),
+               (unsigned long)rawRecorder.getBlockCount());
+    } else {
+        printf("WARNING: Recorder unavailable (flash full?)\r\n");
+    }
+#endif
+    
     // 初始化 BLE
     printf("Initializing BLE...\r\n");
+    sensor.setRawStream(&rawStream);
+    bleService.attachRawStream(&rawStream);
     bleService.begin();
 
+#if UART_CAPTURE_ENABLED
+    // 有线采集会话: 样本序号从开始采样起计
+    sessionfile::SessionInfo captureSession;
+    captureSession.sessionId = 0;
+    captureSession.sensorId = lsm6dsl::WHO_AM_I_VALUE;
+    captureSession.odrHz = SAMPLE_RATE;
+    captureSession.fullScaleG = 2;
+    captureSession.startSample = 0;
+    captureSession.startMs = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        Kernel::Clock::now().time_since_epoch()).count();
+    captureSession.startEpoch = (uint32_t)time(nullptr);
+    pc.setSession(captureSession);
+    sensor.setCaptureLink(&pc);
+#endif
+
     // 启动采样
     sensor.startSampling();
     
@@ -55,62 +384,22 @@ int main() {
     led1 = 1;
     
     printf("\r\nSystem ready!\r\n");
+#if STAGE_TIMING_ENABLED
+    printf("Serial commands: t = stage timing, z = reset timing\r\n");
+#endif
     printf("Waiting for data...\r\n\r\n");
     
-    while (1) {
-        // 更新传感器（读取数据）
-        sensor.update();
-
-        // 检查是否有足够数据
-        if (sensor.isBufferReady()) {
-            printf("\r\n--- Data ready ---\r\n");
-
-            // 获取数据缓冲区
-            float* buffer = sensor.getDataBuffer();
-
-            // 打印前几个样本
-            printf("First samples: ");
-            for (int i = 0; i < 5 && i < WINDOW_SIZE; i++) {
-                printf("%.2f ", buffer[i]);
-            }
-            printf("\r\n");
-
-            // 获取当前运动强度 (用于 FOG 检测)
-            float currentMotion = sensor.getCurrentMagnitude();
-
-            // 运行检测器分析
-            printf("Running detector analysis...\r\n");
-            currentResult = detector.analyze(sensor.getDataBuffer(), currentMotion);
-
-            // 更新 BLE 数据
-            bleService.updateData(currentResult);
-
-            // 清除缓冲区标志
-            sensor.clearBuffer();
-            
-            // LED 指示
-            if (currentResult.tremorDetected || 
-                currentResult.dyskinesiaDetected || 
-                currentResult.fogDetected) {
-                led1 = !led1;  // 检测到异常时闪烁
-            } else {
-                led1 = 1;  // 正常时常亮
-            }
-            
-            // 打印结果
-            printf("\r\n--- Detection Summary ---\r\n");
-            printf("Tremor: %s (Intensity: %.2f)\r\n", 
-                   currentResult.tremorDetected ? "YES" : "NO", 
-                   currentResult.tremorIntensity);
-            printf("Dyskinesia: %s (Intensity: %.2f)\r\n", 
-                   currentResult.dyskinesiaDetected ? "YES" : "NO", 
-                   currentResult.dyskinesiaIntensity);
-            printf("FOG: %s (State: %d)\r\n", 
-                   currentResult.fogDetected ? "YES" : "NO", 
-                   currentResult.motionState);
-            printf("-------------------------\r\n\r\n");
-        }
-        
-        thread_sleep_for(10);
+    // 启动流水线
+    captureThread.start(captureTask);
+    analysisThread.start(analysisTask);
+    logThread.start(logTask);
+    if (eventLog.isMounted()) {
+        eventLogThread.start(eventLogTask);
     }
-}
\ No newline at end of file
+#if RAW_RECORDER_ENABLED
+    recorderThread.start(recorderTask);
+#endif
+
+    // 主线程无其他工作
+    analysisThread.join();
+}
@@ -0,0 +1,247 @@
+// 信号处理基准 (板上: pio run -e bench -t upload，结果从串口输出; 主机: pio run -e bench_native)
+//
+// 逐次计时 FFTProcessor 的各阶段 (加窗、FFT、幅值谱、峰值搜索)、完整 process、三轴 processAxes、
+// Welch 平均 (每个步长加入一段并找峰值)、Q15 定点 FFT、Detector::analyze / analyzeWindow 和每个步长的窗口组装，
+// 每个阶段和信号输出一行 CSV: stage,signal,window,iterations,min,median,mean,max,unit
+// '#' 开头的行是构建配置; 窗口长度是编译期常量，不同长度分别构建 (bench_native_64 / bench_native_256)，
+// 输出可以直接拼接后比较。板上计时包含中断 (RTOS 节拍等)，以 min/median 为准
+#include "config.h"
+#include "bench_clock.h"
+#include "detector.h"
+#include "fft_processor.h"
+#include "fixed_fft.h"
+#include "welch_psd.h"
+#include "window_builder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdint.h>
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 200        // 每个阶段的计时次数
+#endif
+#define BENCH_WARMUP 10             // 计时前的预热次数 (填充缓存/分支预测)
+#define BENCH_TRACE_SAMPLES (2 * WINDOW_SIZE)
+
+enum SignalType {
+    SIGNAL_REST,            // 静止: 只有重力和传感器噪声
+    SIGNAL_TREMOR,          // 4Hz 震颤
+    SIGNAL_DYSKINESIA,      // 6Hz 运动障碍 + 噪声
+    SIGNAL_NOISE,           // 三轴宽带噪声
+    NUM_SIGNALS
+};
+
+static const char* const SIGNAL_NAMES[NUM_SIGNALS] = {"rest", "tremor", "dyskinesia", "noise"};
+
+// 被测对象和缓冲区都放在静态区 (板上主线程栈放不下检测器)
+static FFTProcessor fft;
+static FixedFFTProcessor fixedFft;
+static WelchPsd welch;
+static Detector detector;
+static WindowBuilder builder;
+static AnalysisWindow window;
+static AnalysisWindow scratchWindow;
+static int16_t trace[BENCH_TRACE_SAMPLES][3];
+static float signalData[WINDOW_SIZE];      // 合成幅值 (m/s²)
+static int16_t rawData[WINDOW_SIZE];       // 合成幅值 (原始 LSB)
+static uint32_t ticks[4][BENCH_ITERATIONS];
+
+// 防止被测代码被优化掉
+static volatile float sink;
+
+static uint32_t noiseState = 12345;
+
+// 确定性的均匀噪声 [-1, 1)，各平台结果一致
+static float noise() {
+    noiseState = noiseState * 1664525UL + 1013904223UL;
+    return (float)(int32_t)noiseState / 2147483648.0f;
+}
+
+static int16_t toRaw(float value) {
+    return (int16_t)lrintf(value / ACC_LSB_TO_MS2);
+}
+
+static void makeTrace(SignalType type) {
+    const float twoPi = 6.2831853f;
+    noiseState = 12345;
+    for (int i = 0; i < BENCH_TRACE_SAMPLES; i++) {
+        float t = (float)i / SAMPLE_RATE;
+        float x = 0.01f * noise();
+        float y = 0.01f * noise();
+        float z = 9.81f + 0.01f * noise();
+        switch (type) {
+            case SIGNAL_TREMOR:
+                x += 0.5f * sinf(twoPi * 4.0f * t);
+                break;
+            case SIGNAL_DYSKINESIA:
+                y += 0.8f * sinf(twoPi * 6.0f * t) + 0.2f * noise();
+                break;
+            case SIGNAL_NOISE:
+                x += noise();
+                y += noise();
+                z += noise();
+                break;
+            default:
+                break;
+        }
+        trace[i][0] = toRaw(x);
+        trace[i][1] = toRaw(y);
+        trace[i][2] = toRaw(z);
+    }
+}
+
+static void report(const char* stage, const char* signal, uint32_t* samples) {
+    std::sort(samples, samples + BENCH_ITERATIONS);
+    uint64_t sum = 0;
+    for (int n = 0; n < BENCH_ITERATIONS; n++) {
+        sum += samples[n];
+    }
+    printf("%s,%s,%d,%d,%lu,%lu,%lu,%lu,%s\n", stage, signal, WINDOW_SIZE, BENCH_ITERATIONS,
+           (unsigned long)samples[0], (unsigned long)samples[BENCH_ITERATIONS / 2],
+           (unsigned long)((sum + BENCH_ITERATIONS / 2) / BENCH_ITERATIONS),
+           (unsigned long)samples[BENCH_ITERATIONS - 1], bench::clockUnit());
+}
+
+// 预热后逐次计时 body
+template <typename Body>
+static void timeStage(const char* stage, const char* signal, Body body) {
+    for (int n = 0; n < BENCH_WARMUP; n++) {
+        body();
+    }
+    for (int n = 0; n < BENCH_ITERATIONS; n++) {
+        uint32_t start = bench::clockNow();
+        body();
+        ticks[0][n] = bench::clockNow() - start;
+    }
+    report(stage, signal, ticks[0]);
+}
+
+// process 的四个阶段在同一次调用序列中分段计时 (各阶段的输入依赖上一阶段)
+static void benchFftStages(const char* signal) {
+    for (int n = -BENCH_WARMUP; n < BENCH_ITERATIONS; n++) {
+        uint32_t t0 = bench::clockNow();
+        fft.loadWindow(signalData);
+        uint32_t t1 = bench::clockNow();
+        fft.transform();
+        uint32_t t2 = bench::clockNow();
+        fft.computeSpectrum();
+        uint32_t t3 = bench::clockNow();
+        FrequencyPeak peak = fft.findPeak();
+        uint32_t t4 = bench::clockNow();
+        sink = peak.magnitude;
+        if (n >= 0) {
+            ticks[0][n] = t1 - t0;
+            ticks[1][n] = t2 - t1;
+            ticks[2][n] = t3 - t2;
+            ticks[3][n] = t4 - t3;
+        }
+    }
+    report("window", signal, ticks[0]);
+    report("fft", signal, ticks[1]);
+    report("spectrum", signal, ticks[2]);
+    report("peak", signal, ticks[3]);
+}
+
+static void benchSignal(SignalType type) {
+    const char* signal = SIGNAL_NAMES[type];
+    makeTrace(type);
+
+    // 经过 WindowBuilder 组装分析窗口，与板上采集线程相同
+    builder.reset();
+    for (int i = 0; i < BENCH_TRACE_SAMPLES; i++) {
+        if (builder.addSample(trace[i][0], trace[i][1], trace[i][2]) && i + HOP_SIZE >= BENCH_TRACE_SAMPLES) {
+            builder.fillWindow(&window);
+        }
+    }
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+#if DSP_FIXED_POINT
+        rawData[i] = window.samples[i];
+#else
+        rawData[i] = toRaw(windowMagnitude(window, i));
+#endif
+        signalData[i] = windowMagnitude(window, i);
+    }
+
+    benchFftStages(signal);
+
+    timeStage("process", signal, [] {
+        sink = fft.process(signalData).magnitude;
+    });
+
+#if WINDOW_AXES
+    timeStage("process_axes", signal, [] {
+        FrequencyPeak peaks[NUM_AXES];
+        fft.processAxes(window.axes[0], window.axes[1], window.axes[2], peaks);
+        sink = peaks[0].magnitude;
+    });
+    
+    // 一段频谱加入 Welch 平均 (减去最旧的一段) 并找各轴峰值，与段数无关
+    welch.reset();
+    timeStage("welch_segment", signal, [] {
+        welch.beginSegment();
+        for (int a = 0; a < NUM_AXES; a++) {
+            welch.setPowers(a, fft.getAxisPowers(a), FFTProcessor::POWER_SCALE);
+        }
+        welch.endSegment();
+        sink = welch.findPeakInRange(0, 1.0f, AXIS_MAX_FREQ).magnitude;
+    });
+#endif
+
+    timeStage("fixed_process", signal, [] {
+        sink = fixedFft.process(rawData).magnitude;
+    });
+
+    detector.reset();
+    timeStage("analyze", signal, [] {
+#if DSP_FIXED_POINT
+        sink = detector.analyze(rawData, window.activity).tremorIntensity;
+#else
+        sink = detector.analyze(signalData, window.activity).tremorIntensity;
+#endif
+    });
+
+    detector.reset();
+    timeStage("analyze_window", signal, [] {
+        sink = detector.analyzeWindow(window).tremorIntensity;
+    });
+
+    // 稳态下每 HOP_SIZE 个样本产出一个窗口 (含复制到窗口槽)
+    int next = 0;
+    timeStage("builder_hop", signal, [&next] {
+        for (int h = 0; h < HOP_SIZE; h++) {
+            const int16_t* xyz = trace[next];
+            next = (next + 1) % BENCH_TRACE_SAMPLES;
+            if (builder.addSample(xyz[0], xyz[1], xyz[2])) {
+                builder.fillWindow(&scratchWindow);
+            }
+        }
+        sink = builder.getLatestSample();
+    });
+}
+
+int main() {
+    bench::clockInit();
+
+    printf("# bench platform=%s window=%d hop=%d sample_rate=%d real_fft=%d fixed_point=%d triaxial=%d "
+           "band_tracker=%d welch_segments=%d iterations=%d unit=%s clock_hz=%lu\n",
+           bench::platformName(), WINDOW_SIZE, HOP_SIZE, SAMPLE_RATE, FFT_REAL_INPUT, DSP_FIXED_POINT,
+           TRI_AXIAL_ANALYSIS, DETECTOR_USE_BAND_TRACKER, DETECTOR_WELCH_SEGMENTS, BENCH_ITERATIONS, bench::clockUnit(),
+           (unsigned long)bench::clockHz());
+    printf("stage,signal,window,iterations,min,median,mean,max,unit\n");
+
+    // 计时本身的开销 (两次读时钟)
+    timeStage("clock", "none", [] {
+    });
+
+    for (int type = 0; type < NUM_SIGNALS; type++) {
+        benchSignal((SignalType)type);
+    }
+    printf("# done\n");
+    fflush(stdout);
+
+#if defined(__arm__)
+    while (true) {
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,246 @@
+// 有线采集接收工具 (主机，PlatformIO native 环境: pio run -e capture_rx)
+//
+// 用法: capture_rx [-d detections.csv] out.pds [输入]      不给输入时读标准输入
+//   串口 (Linux): stty -F /dev/ttyACM0 921600 raw && capture_rx -d day.csv day.pds /dev/ttyACM0
+// 固件用 capture 环境构建 (UART_CAPTURE_ENABLED)。样本写入会话文件 (session_format.h)，
+// 检测记录写 CSV (列同 replay 的结果文件)，控制台包 (启动文本和令牌化日志) 解码后输出到标准输出;
+// 输入结束或 Ctrl-C 时写入会话文件的索引和尾部，并打印包数和样本缺口统计
+#include "config.h"
+#include "detection_frame.h"
+#include "log_decoder.h"
+#include "lsm6dsl_fifo.h"
+#include "raw_stream.h"
+#include "session_file.h"
+#include "uart_capture.h"
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+
+using namespace sessionfile;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int signal) {
+    stopRequested = 1;
+}
+
+static void printUsage() {
+    printf("usage: capture_rx [-d detections.csv] out.pds [input]   (default input: stdin)\n");
+}
+
+// 接收状态和统计
+struct Capture {
+    FileWriter writer;
+    FILE* pdsFile;
+    bool writerOpen;
+    SessionInfo session;
+    bool haveSession;
+    uint32_t nextSample;        // 下一个期望的样本序号
+    uint32_t samples;
+    uint32_t sampleGaps;
+    uint32_t lostSamples;
+    uint32_t staleSamples;      // 序号倒退的样本 (固件复位后的新会话)，不写入
+    uint32_t sessionChanges;
+
+    FILE* detectionFile;
+    uint32_t detections;
+    uint32_t detectionGaps;
+    uint16_t nextDetection;
+
+    Capture() {
+        pdsFile = nullptr;
+        writerOpen = false;
+        memset(&session, 0, sizeof(session));
+        haveSession = false;
+        nextSample = 0;
+        samples = 0;
+        sampleGaps = 0;
+        lostSamples = 0;
+        staleSamples = 0;
+        sessionChanges = 0;
+        detectionFile = nullptr;
+        detections = 0;
+        detectionGaps = 0;
+        nextDetection = 0;
+    }
+};
+
+static void onSession(Capture* capture, const uint8_t* payload, int len) {
+    SessionInfo info;
+    if (!capture::decodeSession(payload, len, &info)) {
+        return;
+    }
+    if (capture->haveSession && (info.startMs != capture->session.startMs || info.sessionId != capture->session.sessionId)) {
+        // 固件复位: 会话文件只保存第一个会话，之后序号倒退的样本被跳过
+        capture->sessionChanges++;
+        fprintf(stderr, "capture_rx: device restarted (new session), later samples with lower indices are skipped\n");
+    }
+    if (!capture->writerOpen) {
+        capture->session = info;
+    }
+    capture->haveSession = true;
+}
+
+static void onSamples(Capture* capture, const uint8_t* payload, int len) {
+    static int16_t xyz[rawstream::MAX_SAMPLES_PER_PACKET * 3];
+    uint32_t first;
+    int count = rawstream::decodePacket(payload, len, xyz, rawstream::MAX_SAMPLES_PER_PACKET, &first);
+    if (count <= 0) {
+        return;
+    }
+
+    if (!capture->writerOpen) {
+        if (!capture->haveSession) {
+            // 在会话信息之前接入: 按当前构建的配置建立会话
+            capture->session.sensorId = lsm6dsl::WHO_AM_I_VALUE;
+            capture->session.odrHz = SAMPLE_RATE;
+            capture->session.fullScaleG = 2;
+            capture->session.startSample = first;
+            capture->haveSession = true;
+        }
+        if (!capture->writer.open(capture->pdsFile, capture->session)) {
+            fprintf(stderr, "capture_rx: cannot write session file\n");
+            stopRequested = 1;
+            return;
+        }
+        capture->writerOpen = true;
+        capture->nextSample = first;
+    }
+
+    for (int i = 0; i < count; i++) {
+        uint32_t index = first + (uint32_t)i;
+        if ((int32_t)(index - capture->nextSample) < 0) {
+            capture->staleSamples++;
+            continue;
+        }
+        if (index != capture->nextSample) {
+            capture->sampleGaps++;
+            capture->lostSamples += index - capture->nextSample;
+        }
+        capture->writer.append(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2], index);
+        capture->nextSample = index + 1;
+        capture->samples++;
+    }
+}
+
+static void onDetection(Capture* capture, const uint8_t* payload, int len) {
+    if (len < frame::RECORD_SIZE) {
+        return;
+    }
+    DetectionRecord record;
+    frame::decodeRecord(payload, &record);
+    if (capture->detections > 0 && record.sequence != capture->nextDetection) {
+        capture->detectionGaps++;
+    }
+    capture->nextDetection = (uint16_t)(record.sequence + 1);
+    capture->detections++;
+
+    if (capture->detectionFile != nullptr) {
+        fprintf(capture->detectionFile, "%lu,%lu,%d,%.4f,%d,%.4f,%d,%d,%d\n",
+                (unsigned long)record.sequence, (unsigned long)record.timestampMs,
+                record.tremorDetected ? 1 : 0, record.tremorIntensity,
+                record.dyskinesiaDetected ? 1 : 0, record.dyskinesiaIntensity,
+                record.fogDetected ? 1 : 0, (int)record.motionState, (int)record.dominantAxis);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* detectionPath = nullptr;
+    const char* paths[2] = {nullptr, nullptr};
+    int pathCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            detectionPath = argv[++i];
+        } else if (argv[i][0] == '-' || pathCount == 2) {
+            printUsage();
+            return 1;
+        } else {
+            paths[pathCount++] = argv[i];
+        }
+    }
+    if (pathCount == 0) {
+        printUsage();
+        return 1;
+    }
+
+    Capture capture;
+    capture.pdsFile = fopen(paths[0], "wb");
+    FILE* in = pathCount > 1 ? fopen(paths[1], "rb") : stdin;
+    if (capture.pdsFile == nullptr || in == nullptr) {
+        fprintf(stderr, "capture_rx: cannot open %s\n", capture.pdsFile == nullptr ? paths[0] : paths[1]);
+        return 1;
+    }
+    if (detectionPath != nullptr) {
+        capture.detectionFile = fopen(detectionPath, "w");
+        if (capture.detectionFile == nullptr) {
+            fprintf(stderr, "capture_rx: cannot open %s\n", detectionPath);
+            return 1;
+        }
+        fprintf(capture.detectionFile, "sequence,timestamp_ms,tremor,tremor_intensity,dyskinesia,dyskinesia_intensity,"
+                                       "fog,motion_state,dominant_axis\n");
+    }
+
+    // Ctrl-C 中断阻塞的读取 (不自动重启)，随后正常写入索引和尾部
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    logdecode::StreamDecoder console(stdout);
+    capture::PacketReceiver receiver;
+    int c;
+    while (!stopRequested && (c = fgetc(in)) != EOF) {
+        if (!receiver.feed((uint8_t)c)) {
+            continue;
+        }
+        const uint8_t* payload = receiver.getPayload();
+        int len = receiver.getPayloadLength();
+        switch (receiver.getType()) {
+            case capture::PACKET_SESSION:
+                onSession(&capture, payload, len);
+                break;
+            case capture::PACKET_SAMPLES:
+                onSamples(&capture, payload, len);
+                break;
+            case capture::PACKET_DETECTION:
+                onDetection(&capture, payload, len);
+                break;
+            case capture::PACKET_CONSOLE:
+                console.feed(payload, len);
+                break;
+            default:
+                break;
+        }
+    }
+    console.finish();
+
+    bool ok = true;
+    if (capture.writerOpen) {
+        ok = capture.writer.close();
+    }
+    fclose(capture.pdsFile);
+    if (capture.detectionFile != nullptr) {
+        fclose(capture.detectionFile);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    fprintf(stderr, "capture_rx: %lu packets, %lu bad packets\n",
+            (unsigned long)receiver.getPackets(), (unsigned long)receiver.getBadPackets());
+    fprintf(stderr, "capture_rx: %lu samples (%.1f s at %u Hz), %lu gaps, %lu samples lost, %lu stale\n",
+            (unsigned long)capture.samples,
+            capture.session.odrHz > 0 ? (double)capture.samples / capture.session.odrHz : 0.0,
+            (unsigned)capture.session.odrHz, (unsigned long)capture.sampleGaps,
+            (unsigned long)capture.lostSamples, (unsigned long)capture.staleSamples);
+    fprintf(stderr, "capture_rx: %lu detections, %lu gaps, %lu session restarts\n",
+            (unsigned long)capture.detections, (unsigned long)capture.detectionGaps,
+            (unsigned long)capture.sessionChanges);
+    if (!ok) {
+        fprintf(stderr, "capture_rx: error writing %s\n", paths[0]);
+        return 1;
+    }
+    return 0;
+}
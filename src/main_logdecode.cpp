@@ -0,0 +1,42 @@
+// 令牌化日志解码工具 (主机，PlatformIO native 环境: pio run -e logdecode)
+//
+// 用法: logdecode [文件]      不给文件时读标准输入
+//   串口实时解码 (Linux): stty -F /dev/ttyACM0 115200 raw && logdecode < /dev/ttyACM0
+// 日志帧还原为文本行，帧之间的普通文本 (启动信息、按需命令输出) 原样输出;
+// 消息表 (log_messages.h) 须与固件一致
+#include "log_decoder.h"
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "-h") == 0)) {
+        printf("usage: logdecode [file]   (default: stdin)\n");
+        return 1;
+    }
+
+    FILE* in = stdin;
+    if (argc == 2) {
+        in = fopen(argv[1], "rb");
+        if (in == nullptr) {
+            fprintf(stderr, "logdecode: cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    // 逐字节读取，输出按行刷新: 从串口读取时解码结果实时显示
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    logdecode::StreamDecoder decoder(stdout);
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        uint8_t byte = (uint8_t)c;
+        decoder.feed(&byte, 1);
+    }
+    decoder.finish();
+
+    fprintf(stderr, "logdecode: %lu frames, %lu bad frames\n",
+            (unsigned long)decoder.getFrames(), (unsigned long)decoder.getBadFrames());
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+// 离线回放工具 (主机，PlatformIO native 环境: pio run -e replay)
+//
+// 用法: replay [-j 线程数] [-o 输出目录] [-h 步长] 文件...
+//   *.csv  每行 x,y,z 或 序号,x,y,z (原始 LSB)
+//   *.pds  会话文件 (session_format.h)
+//   其他   原始数据记录器的 flash 镜像
+// 每个文件在一个工作线程中边读边回放，每段输出 <输出目录>/<段名>.csv (逐窗口检测结果)，
+// 最后打印各段汇总和吞吐量
+#include "config.h"
+#include "replay_engine.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+static void printUsage() {
+    printf("usage: replay [-j threads] [-o outdir] [-h hop] file...\n");
+    printf("  *.csv   x,y,z or index,x,y,z per line (raw LSB)\n");
+    printf("  *.pds   session file\n");
+    printf("  other   raw recorder flash image\n");
+}
+
+// 一个输入文件的回放结果 (只保留各段的汇总)
+struct InputResult {
+    std::vector<replay::SegmentSummary> segments;
+    replay::LoadStats stats;
+    bool loaded;
+};
+
+static bool endsWith(const std::string& text, const char* suffix) {
+    size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+int main(int argc, char** argv) {
+    int threads = (int)std::thread::hardware_concurrency();
+    int hop = HOP_SIZE;
+    const char* outDir = nullptr;
+    std::vector<const char*> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (strcmp(argv[i], "-h") == 0 && i + 1 < argc) {
+            hop = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            printUsage();
+            return 2;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 2;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    // 每个工作线程一个回放器; 每个输入文件一个任务，在任务中边读边回放 (记录按缺口拆成连续的段)，
+    // 大的文件先提交，窃取时小的文件填补空闲
+    WorkStealingPool pool(threads);
+    std::vector<std::unique_ptr<replay::SessionReplayer>> replayers;
+    for (int i = 0; i < pool.getWorkerCount(); i++) {
+        replayers.push_back(std::unique_ptr<replay::SessionReplayer>(new replay::SessionReplayer()));
+        replayers.back()->setHopSize(hop);
+    }
+
+    std::vector<off_t> sizes(inputs.size(), 0);
+    std::vector<size_t> order(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        struct stat info;
+        if (stat(inputs[i], &info) == 0) {
+            sizes[i] = info.st_size;
+        }
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {
+        return sizes[a] > sizes[b];
+    });
+
+    std::vector<InputResult> results(inputs.size());
+    for (size_t k = 0; k < order.size(); k++) {
+        size_t index = order[k];
+        pool.submit([&, index](int worker) {
+            InputResult& result = results[index];
+            memset(&result.stats, 0, sizeof(result.stats));
+            std::string path(inputs[index]);
+            replay::SessionReplayer* replayer = replayers[worker].get();
+            if (endsWith(path, ".csv")) {
+                result.loaded = replay::replayCsv(inputs[index], replayer, outDir, &result.segments, &result.stats);
+            } else if (endsWith(path, ".pds")) {
+                result.loaded = replay::replaySessionFile(inputs[index], replayer, outDir,
+                                                          &result.segments, &result.stats);
+            } else {
+                result.loaded = replay::replayRecorderImage(inputs[index], replayer, outDir,
+                                                            &result.segments, &result.stats);
+            }
+        });
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.run();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 汇总 (按输入顺序)
+    uint64_t totalSamples = 0;
+    uint64_t totalWindows = 0;
+    uint64_t busyUs = 0;
+    int failures = 0;
+    size_t segmentCount = 0;
+    replay::LoadStats stats;
+    memset(&stats, 0, sizeof(stats));
+    for (size_t i = 0; i < results.size(); i++) {
+        if (!results[i].loaded) {
+            fprintf(stderr, "replay: cannot read %s\n", inputs[i]);
+            failures++;
+            continue;
+        }
+        stats.sessions += results[i].stats.sessions;
+        stats.gaps += results[i].stats.gaps;
+        stats.badBlocks += results[i].stats.badBlocks;
+        segmentCount += results[i].segments.size();
+    }
+    printf("Loaded %lu sessions, %lu segments (%lu gaps, %lu bad blocks)\n",
+           (unsigned long)stats.sessions, (unsigned long)segmentCount,
+           (unsigned long)stats.gaps, (unsigned long)stats.badBlocks);
+
+    printf("%-32s %10s %8s %7s %7s %7s %9s\n", "segment", "samples", "windows", "tremor", "dysk", "fog", "ms");
+    for (size_t i = 0; i < results.size(); i++) {
+        for (size_t j = 0; j < results[i].segments.size(); j++) {
+            const replay::SegmentSummary& segment = results[i].segments[j];
+            const replay::Summary& summary = segment.summary;
+            if (segment.openFailed || summary.outputError) {
+                fprintf(stderr, "replay: cannot write results for %s\n", segment.name.c_str());
+                failures++;
+                continue;
+            }
+            printf("%-32s %10lu %8lu %7lu %7lu %7lu %9.1f\n", segment.name.c_str(),
+                   (unsigned long)summary.samples, (unsigned long)summary.windows,
+                   (unsigned long)summary.tremorWindows, (unsigned long)summary.dyskinesiaWindows,
+                   (unsigned long)summary.fogWindows, summary.elapsedUs / 1000.0);
+            totalSamples += summary.samples;
+            totalWindows += summary.windows;
+            busyUs += summary.elapsedUs;
+        }
+    }
+
+    double recordedHours = (double)totalSamples / SAMPLE_RATE / 3600.0;
+    double coreSeconds = busyUs / 1e6;
+    printf("\n%d threads, %lu steals\n", pool.getWorkerCount(), (unsigned long)pool.getSteals());
+    printf("%llu samples (%.2f h recorded), %llu windows in %.3f s wall, %.3f core-s\n",
+           (unsigned long long)totalSamples, recordedHours, (unsigned long long)totalWindows,
+           wallSeconds, coreSeconds);
+    if (coreSeconds > 0 && wallSeconds > 0) {
+        printf("%.0f samples/s per core, %.1f s per recorded day per core, %.0fx real time overall\n",
+               totalSamples / coreSeconds, 24.0 * coreSeconds / recordedHours,
+               recordedHours * 3600.0 / wallSeconds);
+    }
+    return failures > 0 ? 1 : 0;
+}
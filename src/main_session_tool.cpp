@@ -0,0 +1,278 @@
+// 会话文件工具 (主机，PlatformIO native 环境: pio run -e session_tool)
+//
+//   session_tool csv2pds in.csv out.pds       CSV (x,y,z 或 序号,x,y,z，原始 LSB) 转会话文件
+//   session_tool img2pds image.bin outdir     原始数据记录器 flash 镜像按会话拆成会话文件 (数据块原样复制)
+//   session_tool pds2csv in.pds out.csv       会话文件转 CSV (序号,x,y,z)
+//   session_tool info in.pds                  会话信息并校验所有块
+//   session_tool bench in.pds [in.csv]        顺序扫描和随机窗口访问基准 (可与 CSV 解析对比)
+#include "config.h"
+#include "lsm6dsl_fifo.h"
+#include "mapped_file.h"
+#include "session_file.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace sessionfile;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int csvToSession(const char* inPath, const char* outPath) {
+    FILE* in = fopen(inPath, "r");
+    FILE* out = fopen(outPath, "wb");
+    if (in == nullptr || out == nullptr) {
+        fprintf(stderr, "session_tool: cannot open %s\n", in == nullptr ? inPath : outPath);
+        return 1;
+    }
+
+    SessionInfo info;
+    memset(&info, 0, sizeof(info));
+    info.sensorId = lsm6dsl::WHO_AM_I_VALUE;
+    info.odrHz = SAMPLE_RATE;
+    info.fullScaleG = 2;
+
+    FileWriter writer;
+    bool ok = true;
+    bool started = false;
+    char line[128];
+    uint32_t nextIndex = 0;
+    while (ok && fgets(line, sizeof(line), in) != nullptr) {
+        uint32_t index = nextIndex;
+        int16_t xyz[3];
+        if (parseCsvSample(line, &index, xyz) == 0) {
+            continue;
+        }
+        if (!started) {
+            // 第一个样本的序号作为会话起点
+            info.startSample = index;
+            ok = writer.open(out, info);
+            started = true;
+        }
+        ok = ok && writer.append(xyz[0], xyz[1], xyz[2], index);
+        nextIndex = index + 1;
+    }
+    if (!started) {
+        ok = writer.open(out, info);
+    }
+    ok = writer.close() && ok;
+    fclose(in);
+    ok = fclose(out) == 0 && ok;
+
+    printf("%s: %lu samples, %lu blocks\n", outPath, (unsigned long)writer.getSampleCount(),
+           (unsigned long)writer.getBlockCount());
+    return ok ? 0 : 1;
+}
+
+static int imageToSessions(const char* imagePath, const char* outDir) {
+    FILE* in = fopen(imagePath, "rb");
+    if (in == nullptr) {
+        fprintf(stderr, "session_tool: cannot open %s\n", imagePath);
+        return 1;
+    }
+
+    static uint8_t block[BLOCK_SIZE];
+    FileWriter writer;
+    FILE* out = nullptr;
+    uint32_t badBlocks = 0;
+    int sessions = 0;
+    bool ok = true;
+    while (ok && fread(block, 1, BLOCK_SIZE, in) == (size_t)BLOCK_SIZE) {
+        SessionInfo session;
+        BlockInfo info;
+        int type = decodeBlock(block, &session, &info, nullptr);
+        if (type == 0) {
+            break;
+        }
+        if (type < 0) {
+            badBlocks++;
+            continue;
+        }
+        if (type == 1) {
+            if (out != nullptr) {
+                ok = writer.close() && fclose(out) == 0;
+            }
+            std::string path = std::string(outDir) + "/session-" + std::to_string(session.sessionId) + ".pds";
+            out = fopen(path.c_str(), "wb");
+            ok = ok && out != nullptr && writer.open(out, session);
+            sessions++;
+            continue;
+        }
+        // 会话块之前的数据块 (会话块损坏) 无法归属，计为损坏
+        if (out == nullptr) {
+            badBlocks++;
+            continue;
+        }
+        ok = writer.appendBlock(block);
+    }
+    if (out != nullptr) {
+        ok = writer.close() && fclose(out) == 0 && ok;
+    }
+    fclose(in);
+
+    printf("%d sessions, %lu bad blocks\n", sessions, (unsigned long)badBlocks);
+    return ok ? 0 : 1;
+}
+
+static int sessionToCsv(const char* inPath, const char* outPath) {
+    MappedFile mapped;
+    FileView view;
+    if (!mapped.open(inPath) || !view.open(mapped.getData(), mapped.getSize())) {
+        fprintf(stderr, "session_tool: %s is not a session file\n", inPath);
+        return 1;
+    }
+    FILE* out = fopen(outPath, "w");
+    if (out == nullptr) {
+        fprintf(stderr, "session_tool: cannot open %s\n", outPath);
+        return 1;
+    }
+
+    fprintf(out, "index,x,y,z\n");
+    int16_t xyz[SAMPLES_PER_BLOCK * 3];
+    for (uint32_t k = 0; k < view.getBlockCount(); k++) {
+        int count = view.getBlockSamples(k);
+        readColumns(view.getBlock(k), 0, count, xyz);
+        uint32_t first = view.getBlockFirstSample(k);
+        for (int i = 0; i < count; i++) {
+            fprintf(out, "%lu,%d,%d,%d\n", (unsigned long)(first + i), xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+        }
+    }
+    return fclose(out) == 0 ? 0 : 1;
+}
+
+static int showInfo(const char* path) {
+    MappedFile mapped;
+    FileView view;
+    if (!mapped.open(path) || !view.open(mapped.getData(), mapped.getSize())) {
+        fprintf(stderr, "session_tool: %s is not a session file\n", path);
+        return 1;
+    }
+    const SessionInfo& info = view.getInfo();
+    uint32_t bad = view.verify();
+    printf("session %lu: sensor 0x%02X, %u Hz, +-%u g, start sample %lu, start %lu ms, epoch %lu\n",
+           (unsigned long)info.sessionId, info.sensorId, info.odrHz, info.fullScaleG,
+           (unsigned long)info.startSample, (unsigned long)info.startMs, (unsigned long)info.startEpoch);
+    printf("%lu samples in %lu blocks (%.2f bytes/sample), %lu bad blocks\n",
+           (unsigned long)view.getSampleCount(), (unsigned long)view.getBlockCount(),
+           view.getSampleCount() > 0 ? (double)mapped.getSize() / view.getSampleCount() : 0.0,
+           (unsigned long)bad);
+    return bad == 0 ? 0 : 1;
+}
+
+static int benchmark(const char* path, const char* csvPath) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MappedFile mapped;
+    FileView view;
+    if (!mapped.open(path) || !view.open(mapped.getData(), mapped.getSize())) {
+        fprintf(stderr, "session_tool: %s is not a session file\n", path);
+        return 1;
+    }
+    double openSeconds = secondsSince(start);
+    uint32_t samples = view.getSampleCount();
+    if (samples < (uint32_t)WINDOW_SIZE) {
+        fprintf(stderr, "session_tool: too few samples\n");
+        return 1;
+    }
+
+    // 顺序扫描: 逐块解码全部列 (求和防止被优化掉)
+    static int16_t xyz[SAMPLES_PER_BLOCK * 3];
+    int64_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t k = 0; k < view.getBlockCount(); k++) {
+        int count = view.getBlockSamples(k);
+        readColumns(view.getBlock(k), 0, count, xyz);
+        for (int i = 0; i < count * 3; i++) {
+            checksum += xyz[i];
+        }
+    }
+    double scanSeconds = secondsSince(start);
+
+    // 顺序扫描 + CRC 校验
+    start = std::chrono::steady_clock::now();
+    uint32_t bad = view.verify();
+    double verifySeconds = secondsSince(start);
+
+    // 随机窗口访问: 随机起点，读取 WINDOW_SIZE 个样本
+    const int windows = 200000;
+    static int16_t window[WINDOW_SIZE * 3];
+    uint32_t first = view.getBlockFirstSample(0);
+    uint32_t span = view.getBlockFirstSample(view.getBlockCount() - 1) + view.getBlockSamples(view.getBlockCount() - 1)
+                  - first - WINDOW_SIZE;
+    uint32_t seed = 12345;
+    int complete = 0;
+    start = std::chrono::steady_clock::now();
+    for (int w = 0; w < windows; w++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t sample = first + (span > 0 ? (seed >> 1) % span : 0);
+        if (view.readSamples(sample, WINDOW_SIZE, window) == WINDOW_SIZE) {
+            complete++;
+        }
+        checksum += window[0];
+    }
+    double randomSeconds = secondsSince(start);
+
+    printf("file: %lu bytes, %lu samples, open %.1f us\n", (unsigned long)mapped.getSize(),
+           (unsigned long)samples, openSeconds * 1e6);
+    printf("sequential scan: %.1f ms, %.0f Msamples/s, %.0f MB/s\n", scanSeconds * 1e3,
+           samples / scanSeconds / 1e6, mapped.getSize() / scanSeconds / 1e6);
+    printf("scan + CRC verify: %.1f ms (%lu bad blocks)\n", verifySeconds * 1e3, (unsigned long)bad);
+    printf("random %d-sample window: %.0f ns/window (%d/%d complete)\n", WINDOW_SIZE,
+           randomSeconds * 1e9 / windows, complete, windows);
+
+    if (csvPath != nullptr) {
+        // 对比: 解析同一数据的 CSV
+        FILE* in = fopen(csvPath, "r");
+        if (in == nullptr) {
+            fprintf(stderr, "session_tool: cannot open %s\n", csvPath);
+            return 1;
+        }
+        char line[128];
+        uint32_t parsed = 0;
+        start = std::chrono::steady_clock::now();
+        while (fgets(line, sizeof(line), in) != nullptr) {
+            uint32_t index = parsed;
+            int16_t sample[3];
+            if (parseCsvSample(line, &index, sample) != 0) {
+                checksum += sample[0];
+                parsed++;
+            }
+        }
+        double csvSeconds = secondsSince(start);
+        fclose(in);
+        printf("csv parse: %.1f ms for %lu samples (%.1fx slower than scan)\n", csvSeconds * 1e3,
+               (unsigned long)parsed, csvSeconds / scanSeconds);
+    }
+    printf("checksum %lld\n", (long long)checksum);
+    return 0;
+}
+
+static void printUsage() {
+    printf("usage: session_tool csv2pds in.csv out.pds\n");
+    printf("       session_tool img2pds image.bin outdir\n");
+    printf("       session_tool pds2csv in.pds out.csv\n");
+    printf("       session_tool info in.pds\n");
+    printf("       session_tool bench in.pds [in.csv]\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "csv2pds") == 0) {
+        return csvToSession(argv[2], argv[3]);
+    }
+    if (argc >= 4 && strcmp(argv[1], "img2pds") == 0) {
+        return imageToSessions(argv[2], argv[3]);
+    }
+    if (argc >= 4 && strcmp(argv[1], "pds2csv") == 0) {
+        return sessionToCsv(argv[2], argv[3]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "info") == 0) {
+        return showInfo(argv[2]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "bench") == 0) {
+        return benchmark(argv[2], argc >= 4 ? argv[3] : nullptr);
+    }
+    printUsage();
+    return 2;
+}
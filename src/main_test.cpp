@@ -2,6 +2,26 @@
 #include "config.h"
 #include "fft_processor.h"
 #include "detector.h"
+#include "band_tracker.h"
+#include "fixed_fft.h"
+#include "lsm6dsl_sim.h"
+#include "mock_bus.h"
+#include "activity_stats.h"
+#include "window_queue.h"
+#include "detection_frame.h"
+#include "raw_stream.h"
+#include "publish_policy.h"
+#include "event_log.h"
+#include "heap_flash.h"
+#include "raw_recorder.h"
+#include "window_builder.h"
+#include "replay_engine.h"
+#include "session_file.h"
+#include "stage_timing.h"
+#include "tokenlog.h"
+#include "log_decoder.h"
+#include "uart_capture.h"
+#include "welch_psd.h"
 #include <cmath>
 
 #ifndef M_PI
@@ -18,31 +38,1740 @@ void generateSineWave(float* buffer, int size, float frequency, float amplitude)
     }
 }
 
+// 由测试信号计算活动统计 (整个数据作为一个窗口和一个步长)
+ActivitySnapshot activityOf(const float* data, int size) {
+    ActivityTracker tracker;
+    for (int i = 0; i < size; i++) {
+        tracker.update(data[i], fabsf(data[i]));
+    }
+    tracker.closeHop();
+    return tracker.getSnapshot();
+}
+
+// 测试信号 (m/s²) 转为检测器的窗口样本: 定点流水线量化为原始 LSB (饱和)，浮点流水线原样复制
+void toSamples(const float* data, sample_t* samples, int size) {
+    for (int i = 0; i < size; i++) {
+#if DSP_FIXED_POINT
+        long raw = lrintf(data[i] / ACC_LSB_TO_MS2);
+        samples[i] = (sample_t)(raw > 32767 ? 32767 : (raw < -32768 ? -32768 : raw));
+#else
+        samples[i] = data[i];
+#endif
+    }
+}
+
 // 测试 1: FFT 4Hz 震颤
 void test_tremor_detection() {
     printf("\n╔═══════════════════════════════════════╗\n");
-    printf("║  测试 1: 震颤检测 (4Hz)              ║\n");
+    printf("║  测试 1: 震颤检测 (4Hz)              ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    FFTProcessor fft;
+    Detector detector;
+    float testData[WINDOW_SIZE];
+    
+    // 生成 4Hz 信号
+    generateSineWave(testData, WINDOW_SIZE, 4.0f, 2.0f);
+    
+    // FFT 分析
+    FrequencyPeak peak = fft.process(testData);
+    printf("FFT 分析: 频率 = %.2f Hz, 幅值 = %.3f\n", peak.frequency, peak.magnitude);
+    
+    // 检测器分析
+    sample_t samples[WINDOW_SIZE];
+    toSamples(testData, samples, WINDOW_SIZE);
+    DetectionResult result = detector.analyze(samples, activityOf(testData, WINDOW_SIZE));
+    
+    printf("\n结果:\n");
+    printf("  震颤检测: %s\n", result.tremorDetected ? "✓ 是" : "✗ 否");
+    printf("  震颤强度: %.3f (阈值: %.2f)\n", result.tremorIntensity, TREMOR_THRESHOLD);
+    
+    if (result.tremorDetected && peak.frequency > 3.0f && peak.frequency < 5.0f) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 2: FFT 6Hz 运动障碍
+void test_dyskinesia_detection() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 2: 运动障碍检测 (6Hz)          ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    FFTProcessor fft;
+    Detector detector;
+    float testData[WINDOW_SIZE];
+    
+    // 生成 6Hz 信号
+    generateSineWave(testData, WINDOW_SIZE, 6.0f, 2.0f);
+    
+    // FFT 分析
+    FrequencyPeak peak = fft.process(testData);
+    printf("FFT 分析: 频率 = %.2f Hz, 幅值 = %.3f\n", peak.frequency, peak.magnitude);
+    
+    // 检测器分析
+    sample_t samples[WINDOW_SIZE];
+    toSamples(testData, samples, WINDOW_SIZE);
+    DetectionResult result = detector.analyze(samples, activityOf(testData, WINDOW_SIZE));
+    
+    printf("\n结果:\n");
+    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
+    printf("  运动障碍强度: %.3f (阈值: %.2f)\n", result.dyskinesiaIntensity, DYSKINESIA_THRESHOLD);
+    
+    if (result.dyskinesiaDetected && peak.frequency > 5.0f && peak.frequency < 7.0f) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 3: 低频拒绝
+void test_low_frequency_rejection() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 3: 低频拒绝 (1Hz)              ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    FFTProcessor fft;
+    Detector detector;
+    float testData[WINDOW_SIZE];
+    
+    // 生成 1Hz 信号
+    generateSineWave(testData, WINDOW_SIZE, 1.0f, 2.0f);
+    
+    // 检测器分析
+    sample_t samples[WINDOW_SIZE];
+    toSamples(testData, samples, WINDOW_SIZE);
+    DetectionResult result = detector.analyze(samples, activityOf(testData, WINDOW_SIZE));
+    
+    printf("\n结果:\n");
+    printf("  震颤检测: %s\n", result.tremorDetected ? "✓ 是" : "✗ 否");
+    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
+    
+    if (!result.tremorDetected && !result.dyskinesiaDetected) {
+        printf("\n✅ 测试通过！正确拒绝低频信号\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！误报\n");
+        led1 = 0;
+    }
+}
+
+// 测试 4: 高频拒绝
+void test_high_frequency_rejection() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 4: 高频拒绝 (10Hz)             ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    FFTProcessor fft;
+    Detector detector;
+    float testData[WINDOW_SIZE];
+    
+    // 生成 10Hz 信号
+    generateSineWave(testData, WINDOW_SIZE, 10.0f, 2.0f);
+    
+    // 检测器分析
+    sample_t samples[WINDOW_SIZE];
+    toSamples(testData, samples, WINDOW_SIZE);
+    DetectionResult result = detector.analyze(samples, activityOf(testData, WINDOW_SIZE));
+    
+    printf("\n结果:\n");
+    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
+    
+    if (!result.dyskinesiaDetected) {
+        printf("\n✅ 测试通过！正确拒绝高频信号\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！误报\n");
+        led1 = 0;
+    }
+}
+
+// 测试 5: 静止状态
+void test_idle_state() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 5: 静止状态                    ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    Detector detector;
+    float testData[WINDOW_SIZE];
+    
+    // 全零数据
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        testData[i] = 0.0f;
+    }
+    
+    // 检测器分析
+    sample_t samples[WINDOW_SIZE];
+    toSamples(testData, samples, WINDOW_SIZE);
+    DetectionResult result = detector.analyze(samples, activityOf(testData, WINDOW_SIZE));
+    
+    printf("\n结果:\n");
+    printf("  震颤检测: %s\n", result.tremorDetected ? "✓ 是" : "✗ 否");
+    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
+    printf("  运动状态: %d (0=IDLE)\n", result.motionState);
+    
+    if (!result.tremorDetected && !result.dyskinesiaDetected && result.motionState == MOTION_IDLE) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 6: 实数 FFT 与复数 DFT 等价性
+void test_real_fft_equivalence() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 6: 实数 FFT 等价性             ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    FFTProcessor fft;
+    float testData[WINDOW_SIZE];
+    
+    // 混合信号: 直流 + 4Hz + 6.5Hz + 伪随机噪声
+    uint32_t seed = 12345;
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        float noise = ((seed >> 16) & 0x7FFF) / 32768.0f - 0.5f;
+        testData[i] = 1.0f + 2.0f * sinf(2.0f * M_PI * 4.0f * i / SAMPLE_RATE)
+                    + 0.5f * sinf(2.0f * M_PI * 6.5f * i / SAMPLE_RATE) + 0.1f * noise;
+    }
+    
+    fft.process(testData);
+    
+    // 参考: 直接计算加窗信号的 N 点复数 DFT (双精度)
+    float maxError = 0.0f;
+    for (int k = 0; k < WINDOW_SIZE / 2; k++) {
+        double re = 0.0;
+        double im = 0.0;
+        for (int i = 0; i < WINDOW_SIZE; i++) {
+            double w = 0.5 * (1.0 - cos(2.0 * M_PI * i / (WINDOW_SIZE - 1)));
+            double angle = -2.0 * M_PI * k * i / WINDOW_SIZE;
+            re += testData[i] * w * cos(angle);
+            im += testData[i] * w * sin(angle);
+        }
+        float reference = (float)(sqrt(re * re + im * im) / (WINDOW_SIZE / 2.0));
+        float error = fabsf(fft.getMagnitude(k) - reference);
+        if (error > maxError) {
+            maxError = error;
+        }
+    }
+    
+    printf("\n结果:\n");
+    printf("  最大幅值误差: %.6f (容差: 0.0010)\n", maxError);
+    
+    if (maxError < 0.001f) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 7: 滑动 DFT 频带跟踪与 FFT 一致性
+void test_band_tracker() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 7: 滑动 DFT 频带跟踪           ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    FFTProcessor fft;
+    BandTracker tracker;
+    static float signal[4 * WINDOW_SIZE];
+    const int total = 4 * WINDOW_SIZE;
+    
+    // 4.3Hz 震颤在中途出现，叠加 6.1Hz 分量和直流
+    for (int i = 0; i < total; i++) {
+        float tremor = (i > total / 2) ? 2.0f * sinf(2.0f * M_PI * 4.3f * i / SAMPLE_RATE) : 0.0f;
+        signal[i] = 1.0f + tremor + 0.7f * sinf(2.0f * M_PI * 6.1f * i / SAMPLE_RATE);
+    }
+    
+    // 逐样本更新，每 17 个样本与同一窗口的 FFT 结果比较
+    float maxError = 0.0f;
+    for (int i = 0; i < total; i++) {
+        tracker.update(signal[i]);
+        if (!tracker.isReady() || (i % 17) != 0) {
+            continue;
+        }
+        
+        fft.process(&signal[i - WINDOW_SIZE + 1]);
+        for (int k = BandTracker::MIN_BIN; k <= BandTracker::MAX_BIN; k++) {
+            float error = fabsf(fft.getMagnitude(k) - tracker.getMagnitude(k));
+            if (error > maxError) {
+                maxError = error;
+            }
+        }
+    }
+    
+    FrequencyPeak peak = tracker.findPeakInRange(TREMOR_FREQ_MIN, DYSKINESIA_FREQ_MAX);
+    
+    // 检测器: 稳定的 4Hz 信号，频带估计 (逐样本更新，每个步长判定) 与 FFT 路径 (每个步长一个窗口) 的强度一致，
+    // 且窗口之间不衰减、不跳变
+    static Detector bandDetector;
+    static Detector fftDetector;
+    static float steady[WINDOW_SIZE + 40 * HOP_SIZE];
+    static sample_t window[WINDOW_SIZE];
+    const int steadyTotal = WINDOW_SIZE + 40 * HOP_SIZE;
+    for (int i = 0; i < steadyTotal; i++) {
+        steady[i] = 0.4f * sinf(2.0f * M_PI * 4.0f * i / SAMPLE_RATE);
+    }
+    bandDetector.reset();
+    fftDetector.reset();
+    ActivitySnapshot rest = activityOf(steady, 0);
+    float maxIntensityError = 0.0f;
+    float minBand = 1e9f;
+    float maxBand = 0.0f;
+    int bandDetections = 0;
+    int compared = 0;
+    int fed = 0;
+    for (int end = WINDOW_SIZE; end <= steadyTotal; end += HOP_SIZE) {
+        for (; fed < end; fed++) {
+            bandDetector.updateBands(steady[fed]);
+        }
+        DetectionResult band = bandDetector.analyzeBands(rest);
+        toSamples(&steady[end - WINDOW_SIZE], window, WINDOW_SIZE);
+        DetectionResult full = fftDetector.analyze(window, rest);
+        // 前几个窗口平滑/平均尚未稳定
+        if (end < WINDOW_SIZE + 8 * HOP_SIZE) {
+            continue;
+        }
+        float error = fabsf(band.tremorIntensity - full.tremorIntensity);
+        if (error > maxIntensityError) {
+            maxIntensityError = error;
+        }
+        if (band.tremorIntensity < minBand) {
+            minBand = band.tremorIntensity;
+        }
+        if (band.tremorIntensity > maxBand) {
+            maxBand = band.tremorIntensity;
+        }
+        bandDetections += band.tremorDetected ? 1 : 0;
+        compared++;
+    }
+    
+    // 步态: 2Hz 主分量 + 较弱的 4Hz 谐波，两条路径都取 1-10Hz 的主峰，都不应判为震颤
+    for (int i = 0; i < steadyTotal; i++) {
+        float t = (float)i / SAMPLE_RATE;
+        steady[i] = 1.0f * sinf(2.0f * M_PI * 2.0f * t) + 0.4f * sinf(2.0f * M_PI * 4.0f * t);
+    }
+    bandDetector.reset();
+    fftDetector.reset();
+    int gaitMismatches = 0;
+    int gaitTremor = 0;
+    fed = 0;
+    for (int end = WINDOW_SIZE; end <= steadyTotal; end += HOP_SIZE) {
+        for (; fed < end; fed++) {
+            bandDetector.updateBands(steady[fed]);
+        }
+        DetectionResult band = bandDetector.analyzeBands(rest);
+        toSamples(&steady[end - WINDOW_SIZE], window, WINDOW_SIZE);
+        DetectionResult full = fftDetector.analyze(window, rest);
+        if (band.tremorDetected != full.tremorDetected || band.dyskinesiaDetected != full.dyskinesiaDetected) {
+            gaitMismatches++;
+        }
+        gaitTremor += band.tremorDetected ? 1 : 0;
+    }
+    
+    // 跟踪器使用周期汉宁窗，FFT 使用对称汉宁窗，两者存在小的系统差异
+    printf("\n结果:\n");
+    printf("  频带峰值: %.2f Hz, 幅值 = %.3f\n", peak.frequency, peak.magnitude);
+    printf("  最大频点误差: %.4f (容差: 0.0200)\n", maxError);
+    printf("  检测器强度 (稳定 4Hz): 频带 %.3f .. %.3f, 与 FFT 路径最大差 %.4f, 检出 %d/%d 窗口\n",
+           minBand, maxBand, maxIntensityError, bandDetections, compared);
+    printf("  步态 2Hz + 4Hz 谐波: 频带判为震颤 %d 窗口, 与 FFT 路径不一致 %d 窗口\n", gaitTremor, gaitMismatches);
+    
+    bool detectorOk = maxIntensityError < 0.02f && minBand > 0.9f * maxBand && bandDetections == compared
+        && gaitTremor == 0 && gaitMismatches == 0;
+    if (maxError < 0.02f && peak.frequency > 3.0f && peak.frequency < 5.0f && detectorOk) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 8: Q15 定点 FFT 与浮点 FFT 一致性
+void test_fixed_point_fft() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 8: Q15 定点 FFT                ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    FFTProcessor fft;
+    FixedFFTProcessor fixedFft;
+    float floatData[WINDOW_SIZE];
+    int16_t rawData[WINDOW_SIZE];
+    
+    // 不同幅值 (0.02 .. 10 m/s²) 的 4Hz / 6Hz 信号，叠加 1 m/s² 直流
+    const float amplitudes[] = {0.02f, 0.1f, 0.5f, 2.0f, 10.0f};
+    const float frequencies[] = {4.0f, 6.0f};
+    float worstRatio = 0.0f;
+    bool binsMatch = true;
+    
+    for (int a = 0; a < 5; a++) {
+        for (int f = 0; f < 2; f++) {
+            // 量化为原始 LSB，两条流水线使用完全相同的输入
+            for (int i = 0; i < WINDOW_SIZE; i++) {
+                float value = 1.0f + amplitudes[a] * sinf(2.0f * M_PI * frequencies[f] * i / SAMPLE_RATE);
+                rawData[i] = (int16_t)lrintf(value / ACC_LSB_TO_MS2);
+                floatData[i] = rawData[i] * ACC_LSB_TO_MS2;
+            }
+            
+            fft.process(floatData);
+            fixedFft.process(rawData);
+            FrequencyPeak floatPeak = fft.findPeakInRange(TREMOR_FREQ_MIN, DYSKINESIA_FREQ_MAX);
+            FrequencyPeak fixedPeak = fixedFft.findPeakInRange(TREMOR_FREQ_MIN, DYSKINESIA_FREQ_MAX);
+            
+            // 误差界: 0.5% * 幅值 + 0.002 m/s²
+            float bound = 0.005f * floatPeak.magnitude + 0.002f;
+            float ratio = fabsf(fixedPeak.magnitude - floatPeak.magnitude) / bound;
+            if (ratio > worstRatio) {
+                worstRatio = ratio;
+            }
+            if (fixedPeak.frequency != floatPeak.frequency) {
+                binsMatch = false;
+            }
+            
+            printf("  %.2f m/s² @ %.0fHz: 浮点 %.4f, 定点 %.4f\n",
+                   amplitudes[a], frequencies[f], floatPeak.magnitude, fixedPeak.magnitude);
+        }
+    }
+    
+    printf("\n结果:\n");
+    printf("  最大误差 / 误差界: %.3f\n", worstRatio);
+    printf("  峰值频点一致: %s\n", binsMatch ? "✓ 是" : "✗ 否");
+    
+    if (worstRatio <= 1.0f && binsMatch) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 9: LSM6DSL FIFO 驱动 (寄存器级仿真)
+void test_fifo_driver() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 9: FIFO 水位批量读取 (仿真)    ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    Lsm6dslSim sim;
+    Lsm6dslFifo fifo(sim);
+    static int16_t batch[FIFO_WATERMARK * 2 * 3];
+    bool ok = fifo.configure(FIFO_WATERMARK);
+    
+    // 样本值编码序号，检查顺序和完整性
+    int produced = 0;
+    int consumed = 0;
+    int wakeups = 0;
+    for (int i = 0; i < 20 * FIFO_WATERMARK; i++) {
+        sim.pushSample((int16_t)produced, (int16_t)(produced + 1000), (int16_t)(-produced));
+        produced++;
+        
+        if (!sim.isInt1Asserted()) {
+            continue;
+        }
+        wakeups++;
+        int count = fifo.readBatch(batch, FIFO_WATERMARK * 2);
+        for (int n = 0; n < count; n++) {
+            if (batch[3 * n] != consumed || batch[3 * n + 1] != consumed + 1000 || batch[3 * n + 2] != -consumed) {
+                ok = false;
+            }
+            consumed++;
+        }
+    }
+    uint32_t readsPerSample = sim.getReadTransactions();
+    
+    // 溢出: 连续模式覆盖旧数据后仍应对齐到 x 轴
+    for (int i = 0; i < 1000; i++) {
+        sim.pushSample(7, 8, 9);
+    }
+    int count = fifo.readBatch(batch, FIFO_WATERMARK * 2);
+    bool aligned = count > 0 && batch[0] == 7 && batch[1] == 8 && batch[2] == 9;
+    
+    printf("\n结果:\n");
+    printf("  产生 %d 样本, 读出 %d 样本, 唤醒 %d 次\n", produced, consumed, wakeups);
+    printf("  读事务: %lu (逐样本轮询需要 %d)\n", (unsigned long)readsPerSample, produced);
+    printf("  溢出后对齐: %s, 溢出计数: %lu\n", aligned ? "✓ 是" : "✗ 否",
+           (unsigned long)fifo.getOverruns());
+    
+    if (ok && aligned && consumed == produced && wakeups * 10 < produced && readsPerSample * 10 < (uint32_t)produced) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 10: 异步批量读取 (带延迟的模拟总线)
+struct AsyncReadState {
+    volatile bool done;
+    bool success;
+};
+
+void onAsyncReadDone(void* context, bool success) {
+    AsyncReadState* state = (AsyncReadState*)context;
+    state->success = success;
+    state->done = true;
+}
+
+void test_async_fifo_read() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 10: 异步 FIFO 读取 (模拟延迟)  ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    // 4ms 传输延迟 (约为 400kHz I2C 读 26 个样本的耗时)
+    const uint32_t latencyUs = 4000;
+    Lsm6dslSim sim;
+    MockAsyncBus bus(sim, latencyUs);
+    Lsm6dslFifo fifo(bus);
+    static int16_t batch[FIFO_WATERMARK * 2 * 3];
+    bool ok = fifo.configure(FIFO_WATERMARK);
+    
+    AsyncReadState state = {false, false};
+    bool inFlight = false;
+    bool earlyUse = false;      // 完成前缓冲区内容已变化
+    int inFlightCount = 0;
+    int produced = 0;
+    int consumed = 0;
+    uint32_t freeUs = 0;        // 传输期间 CPU 可用于分析的时间
+    
+    // 1ms 步进，每 19ms 产生一个样本 (约 52Hz)
+    for (int t = 0; t < 20 * FIFO_WATERMARK * 19; t++) {
+        if (t % 19 == 0) {
+            sim.pushSample((int16_t)produced, (int16_t)(produced + 1000), (int16_t)(-produced));
+            produced++;
+        }
+        
+        if (!inFlight && sim.isInt1Asserted()) {
+            inFlightCount = fifo.prepareBatch(FIFO_WATERMARK * 2);
+            if (inFlightCount > 0) {
+                state.done = false;
+                inFlight = fifo.startBatchRead(batch, inFlightCount, onAsyncReadDone, &state);
+            }
+        }
+        
+        bus.advance(1000);
+        
+        if (inFlight && !state.done) {
+            freeUs += 1000;
+            if (batch[0] != (int16_t)0xA5A5) {
+                earlyUse = true;
+            }
+            continue;
+        }
+        if (inFlight) {
+            inFlight = false;
+            ok = ok && state.success;
+            fifo.finishBatch(batch, inFlightCount);
+            for (int n = 0; n < inFlightCount; n++) {
+                if (batch[3 * n] != consumed || batch[3 * n + 1] != consumed + 1000 || batch[3 * n + 2] != -consumed) {
+                    ok = false;
+                }
+                consumed++;
+            }
+        }
+    }
+    
+    printf("\n结果:\n");
+    printf("  产生 %d 样本, 读出 %d 样本, 传输 %lu 次\n", produced, consumed,
+           (unsigned long)bus.getCompletedTransfers());
+    printf("  总线忙 %lu us, 期间 CPU 空闲 %lu us\n", (unsigned long)bus.getBusyTime(), (unsigned long)freeUs);
+    printf("  完成前使用数据: %s\n", earlyUse ? "✗ 是" : "✓ 否");
+    
+    // 最后一批可能仍在传输中
+    if (ok && !earlyUse && consumed > 0 && produced - consumed <= FIFO_WATERMARK * 2 && freeUs > 0) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 11: 流式活动统计 (Welford)
+void test_activity_stats() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 11: 流式活动统计               ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    // 与两遍法 (双精度) 比较: 长时间运行后滑动窗口统计不应漂移
+    ActivityTracker tracker;
+    static float samples[WINDOW_SIZE * 200];
+    const int total = WINDOW_SIZE * 200;
+    const int hop = HOP_SIZE;
+    unsigned int seed = 12345;
+    for (int i = 0; i < total; i++) {
+        seed = seed * 1103515245u + 12345u;
+        float noise = ((seed >> 16) & 0x7FFF) / 32768.0f - 0.5f;
+        // 静止段与步行段交替，幅值偏置模拟重力残差
+        float walking = ((i / 500) % 2) ? 2.0f * sinf(2.0f * M_PI * 1.8f * i / SAMPLE_RATE) : 0.0f;
+        samples[i] = 9.5f + walking + 0.05f * noise;
+    }
+    
+    float maxMeanError = 0;
+    float maxStdError = 0;
+    float maxSmaError = 0;
+    float maxHopStdError = 0;
+    for (int i = 0; i < total; i++) {
+        tracker.update(samples[i], fabsf(samples[i] - 9.5f));
+        if (i + 1 < WINDOW_SIZE || (i + 1) % hop != 0) {
+            continue;
+        }
+        tracker.closeHop();
+        ActivitySnapshot snapshot = tracker.getSnapshot();
+        
+        // 两遍法参考值
+        const float* window = &samples[i + 1 - WINDOW_SIZE];
+        double mean = 0, sma = 0;
+        for (int n = 0; n < WINDOW_SIZE; n++) {
+            mean += window[n];
+            sma += fabs(window[n] - 9.5);
+        }
+        mean /= WINDOW_SIZE;
+        sma /= WINDOW_SIZE;
+        double variance = 0;
+        for (int n = 0; n < WINDOW_SIZE; n++) {
+            variance += (window[n] - mean) * (window[n] - mean);
+        }
+        variance /= WINDOW_SIZE;
+        
+        // 首个步长包含填充第一个窗口的全部样本
+        int hopCount = (i + 1 == WINDOW_SIZE) ? WINDOW_SIZE : hop;
+        const float* hopData = &samples[i + 1 - hopCount];
+        double hopMean = 0, hopVariance = 0;
+        for (int n = 0; n < hopCount; n++) {
+            hopMean += hopData[n];
+        }
+        hopMean /= hopCount;
+        for (int n = 0; n < hopCount; n++) {
+            hopVariance += (hopData[n] - hopMean) * (hopData[n] - hopMean);
+        }
+        hopVariance /= hopCount;
+        
+        float meanError = fabsf(snapshot.window.mean - (float)mean);
+        float stdError = fabsf(sqrtf(snapshot.window.variance) - (float)sqrt(variance));
+        float smaError = fabsf(snapshot.window.sma - (float)sma);
+        float hopStdError = fabsf(sqrtf(snapshot.hop.variance) - (float)sqrt(hopVariance));
+        if (meanError > maxMeanError) maxMeanError = meanError;
+        if (stdError > maxStdError) maxStdError = stdError;
+        if (smaError > maxSmaError) maxSmaError = smaError;
+        if (hopStdError > maxHopStdError) maxHopStdError = hopStdError;
+        
+        if (snapshot.window.count != WINDOW_SIZE || snapshot.hop.count != hopCount) {
+            maxMeanError = 1.0f;
+        }
+    }
+    
+    printf("\n结果:\n");
+    printf("  %d 样本, 窗口 %d, 步长 %d\n", total, WINDOW_SIZE, hop);
+    printf("  窗口均值最大误差: %.6f\n", maxMeanError);
+    printf("  窗口标准差最大误差: %.6f\n", maxStdError);
+    printf("  窗口 SMA 最大误差: %.6f\n", maxSmaError);
+    printf("  步长标准差最大误差: %.6f\n", maxHopStdError);
+    
+    if (maxMeanError < 1e-3f && maxStdError < 1e-3f && maxSmaError < 1e-3f && maxHopStdError < 1e-3f) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 12: 采集/分析窗口队列 (单生产者/单消费者)
+void test_window_queue() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 12: 窗口队列 (SPSC)            ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    static WindowQueue queue;
+    queue.reset();
+    
+    // 生产者每步产出一个窗口 (内容全部等于序号)；
+    // 消费者在前半段每步分析一个，后半段每 4 步才分析完一个 (期间一直占用槽)
+    const int steps = 400;
+    uint32_t produced = 0;
+    uint32_t consumed = 0;
+    uint32_t lastSequence = 0;
+    bool torn = false;
+    bool ordered = true;
+    AnalysisWindow* reading = nullptr;
+    int readingSteps = 0;
+    
+    for (int step = 0; step < steps; step++) {
+        AnalysisWindow* window = queue.beginWrite();
+        if (window != nullptr) {
+            window->sequence = produced;
+            for (int i = 0; i < WINDOW_SIZE; i++) {
+#if WINDOW_AXES
+                window->axes[0][i] = (float)(produced % 1000);
+#else
+                window->samples[i] = (sample_t)(produced % 1000);
+#endif
+            }
+            queue.commitWrite();
+        }
+        produced++;
+        
+        if (reading == nullptr) {
+            reading = queue.beginRead();
+            readingSteps = 0;
+            if (reading != nullptr && consumed > 0 && reading->sequence <= lastSequence) {
+                ordered = false;
+            }
+        }
+        if (reading == nullptr) {
+            continue;
+        }
+        
+        // 占用期间窗口内容不能被生产者改写
+        for (int i = 0; i < WINDOW_SIZE; i++) {
+#if WINDOW_AXES
+            if (reading->axes[0][i] != (float)(reading->sequence % 1000)) {
+#else
+            if (reading->samples[i] != (sample_t)(reading->sequence % 1000)) {
+#endif
+                torn = true;
+            }
+        }
+        readingSteps++;
+        if (step < steps / 2 || readingSteps >= 4) {
+            lastSequence = reading->sequence;
+            queue.commitRead();
+            consumed++;
+            reading = nullptr;
+        }
+    }
+    
+    uint32_t pending = (uint32_t)queue.getPending();
+    
+    printf("\n结果:\n");
+    printf("  产出 %lu 窗口, 分析 %lu, 待处理 %lu, 丢弃 %lu\n", (unsigned long)produced,
+           (unsigned long)consumed, (unsigned long)pending, (unsigned long)queue.getOverruns());
+    printf("  窗口被改写: %s, 顺序正确: %s\n", torn ? "✗ 是" : "✓ 否", ordered ? "✓ 是" : "✗ 否");
+    
+    if (!torn && ordered && queue.getOverruns() > 0 &&
+        produced == consumed + pending + queue.getOverruns()) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 13: BLE 检测帧编码/解码往返
+void test_detection_frame() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 13: BLE 检测帧往返             ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    bool ok = true;
+    float maxError = 0;
+    
+    // 批量大小由 MTU 决定: 默认 23 字节 MTU 每次通知 1 条，247 字节 22 条
+    int perDefault = frame::recordsPerPayload(23 - 3);
+    int perMax = frame::recordsPerPayload(247 - 3);
+    
+    // 逐条往返: 覆盖所有标志组合、状态、主轴和强度范围
+    static DetectionRecord input[64];
+    static DetectionRecord output[64];
+    static uint8_t payload[247];
+    for (int i = 0; i < 64; i++) {
+        DetectionRecord& r = input[i];
+        r.sequence = (uint16_t)(65530 + i);     // 跨越 16 位回绕
+        r.timestampMs = 4000000000u + i * 615u;
+        r.tremorDetected = (i & 1) != 0;
+        r.dyskinesiaDetected = (i & 2) != 0;
+        r.fogDetected = (i & 4) != 0;
+        r.motionState = (uint8_t)(i % 3);
+        r.dominantAxis = (int8_t)(i % 4 - 1);
+        r.tremorIntensity = i * 0.6f;          // 末尾超出量程 (饱和)
+        r.dyskinesiaIntensity = 0.05f + i * 0.0013f;
+    }
+    
+    for (int start = 0; start < 64; start += perMax) {
+        int count = (64 - start < perMax) ? 64 - start : perMax;
+        int length = frame::encodeBatch(&input[start], count, payload);
+        if (length > 247 - 3 || frame::decodeBatch(payload, length, &output[start], count) != count) {
+            ok = false;
+        }
+    }
+    
+    for (int i = 0; i < 64; i++) {
+        const DetectionRecord& a = input[i];
+        const DetectionRecord& b = output[i];
+        if (a.sequence != b.sequence || a.timestampMs != b.timestampMs ||
+            a.tremorDetected != b.tremorDetected || a.dyskinesiaDetected != b.dyskinesiaDetected ||
+            a.fogDetected != b.fogDetected || a.motionState != b.motionState || a.dominantAxis != b.dominantAxis) {
+            ok = false;
+        }
+        // 量程内误差不超过半个量化步长，超出量程饱和
+        float expected = (a.tremorIntensity < 65535.0f / frame::INTENSITY_SCALE) ? a.tremorIntensity
+                                                                              : 65535.0f / frame::INTENSITY_SCALE;
+        float error = fabsf(b.tremorIntensity - expected);
+        float error2 = fabsf(b.dyskinesiaIntensity - a.dyskinesiaIntensity);
+        if (error > maxError) maxError = error;
+        if (error2 > maxError) maxError = error2;
+    }
+    
+    // 版本或长度不符时拒绝
+    int length = frame::encodeBatch(input, 2, payload);
+    bool lengthRejected = frame::decodeBatch(payload, length - 1, output, 64) < 0;
+    payload[0] = frame::FRAME_VERSION + 1;
+    bool versionRejected = frame::decodeBatch(payload, length, output, 64) < 0;
+    
+    // 断开期间入队超过容量: 丢弃最旧的，其余按顺序补发
+    static DetectionFrameQueue queue;
+    queue.clear();
+    for (int i = 0; i < DetectionFrameQueue::CAPACITY + 5; i++) {
+        DetectionRecord r = input[0];
+        r.sequence = (uint16_t)i;
+        queue.push(r);
+    }
+    uint16_t expectedSequence = 5;
+    bool queueOrdered = queue.getDropped() == 5;
+    int notifications = 0;
+    while (queue.getPending() > 0) {
+        int records = 0;
+        int bytes = queue.encodePending(payload, 247 - 3, 4, &records);
+        int decoded = frame::decodeBatch(payload, bytes, output, 64);
+        for (int n = 0; n < decoded; n++) {
+            if (output[n].sequence != expectedSequence++) {
+                queueOrdered = false;
+            }
+        }
+        queue.markSent(records);
+        notifications++;
+    }
+    
+    printf("\n结果:\n");
+    printf("  每次通知记录数: MTU 23 -> %d, MTU 247 -> %d (记录 %d 字节)\n", perDefault, perMax, frame::RECORD_SIZE);
+    printf("  强度最大误差: %.6f (半步长 %.6f)\n", maxError, 0.5f / frame::INTENSITY_SCALE);
+    printf("  拒绝错误长度/版本: %s / %s\n", lengthRejected ? "✓" : "✗", versionRejected ? "✓" : "✗");
+    printf("  补发: %d 次通知, 顺序 %s, 丢弃 %lu\n", notifications, queueOrdered ? "✓ 正确" : "✗ 错误",
+           (unsigned long)queue.getDropped());
+    
+    if (ok && perDefault == 1 && perMax == 22 && maxError <= 0.5f / frame::INTENSITY_SCALE + 1e-6f &&
+        lengthRejected && versionRejected && queueOrdered && notifications == 8) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 14: 原始数据流压缩 (差分 + zigzag/varint)
+void test_raw_stream() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 14: 原始数据流压缩             ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    // 模拟佩戴数据 (原始 LSB): z 轴重力 + 4Hz 震颤 (~0.3 m/s²) + 噪声
+    const int total = 52 * 60;
+    static int16_t trace[52 * 60 * 3];
+    unsigned int seed = 777;
+    for (int i = 0; i < total; i++) {
+        float tremor = 500.0f * sinf(2.0f * M_PI * 4.2f * i / SAMPLE_RATE);
+        for (int a = 0; a < 3; a++) {
+            seed = seed * 1103515245u + 12345u;
+            int noise = (int)((seed >> 16) % 41) - 20;
+            trace[3 * i + a] = (int16_t)((a == 2 ? GRAVITY_LSB : 0) + (a == 0 ? tremor : 0.3f * tremor) + noise);
+        }
+    }
+    
+    static RawStreamer streamer;
+    static int16_t decoded[rawstream::MAX_SAMPLES_PER_PACKET * 3];
+    streamer.reset();
+    streamer.setPayloadLimit(rawstream::MAX_PACKET_SIZE);
+    streamer.setEnabled(true);
+    
+    // 链路正常: 每个包完成后立即取走并解码校验
+    bool ok = true;
+    int received = 0;
+    Timer timer;
+    timer.start();
+    int length;
+    const uint8_t* packet;
+    for (int i = 0; i < total; i++) {
+        streamer.push(trace[3 * i], trace[3 * i + 1], trace[3 * i + 2], (uint32_t)i);
+        while ((packet = streamer.peek(&length)) != nullptr) {
+            uint32_t first = 0;
+            int count = rawstream::decodePacket(packet, length, decoded, rawstream::MAX_SAMPLES_PER_PACKET, &first);
+            if (count <= 0 || length > rawstream::MAX_PACKET_SIZE || (int)first != received) {
+                ok = false;
+            }
+            for (int n = 0; n < count * 3 && received + n / 3 < total; n++) {
+                if (decoded[n] != trace[3 * received + n]) {
+                    ok = false;
+                }
+            }
+            received += count > 0 ? count : 0;
+            streamer.pop();
+        }
+    }
+    int64_t elapsedUs = timer.elapsed_time().count();
+    float bytesPerSample = (float)streamer.getBytesProduced() / streamer.getSamplesEncoded();
+    
+    // 链路阻塞: 不发送，队列满后采集端丢弃样本而不等待，恢复后从新包继续 (序号显示缺口)
+    streamer.reset();
+    streamer.setEnabled(true);
+    for (int i = 0; i < total; i++) {
+        streamer.push(trace[3 * i], trace[3 * i + 1], trace[3 * i + 2], (uint32_t)i);
+    }
+    bool dropped = streamer.getSamplesDropped() > 0 && streamer.getPendingPackets() == RAW_STREAM_PACKET_SLOTS;
+    uint32_t lastFirst = 0;
+    bool gapVisible = false;
+    while ((packet = streamer.peek(&length)) != nullptr) {
+        int count = rawstream::decodePacket(packet, length, decoded, rawstream::MAX_SAMPLES_PER_PACKET, &lastFirst);
+        streamer.pop();
+        if (count <= 0) {
+            ok = false;
+        }
+    }
+    streamer.push(1, 2, 3, (uint32_t)total);
+    streamer.setEnabled(false);     // 丢弃未完成的包
+    gapVisible = lastFirst < (uint32_t)total - rawstream::MAX_SAMPLES_PER_PACKET;
+    
+    printf("\n结果:\n");
+    printf("  %d 样本, %.2f 字节/样本 (原始 6 字节), 收到 %d\n", total, bytesPerSample, received);
+    printf("  编码+解码耗时: %.2f us/样本\n", (float)elapsedUs / total);
+    printf("  链路阻塞: 丢弃 %lu 样本, 缺口可见: %s\n", (unsigned long)streamer.getSamplesDropped(),
+           gapVisible ? "✓ 是" : "✗ 否");
+    
+    if (ok && received + rawstream::MAX_SAMPLES_PER_PACKET > total && bytesPerSample < 5.0f && dropped && gapVisible) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 15: BLE 发布策略 (变化驱动 + 心跳 + 最大速率)
+void test_publish_policy() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 15: BLE 发布策略               ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    // 10 分钟的窗口结果: 平静 → 第 3-5 分钟震颤发作 (强度先升后稳) → 平静，
+    // 第 6 分钟运动障碍强度逐窗口剧烈波动 (每个结果都要发布，只有强度变化，在队列中合并)
+    // 分别按 600 ms 和 150 ms 一个结果 (结果速率 4 倍) 运行，通知速率应保持不变;
+    // 结果间隔显式给定 (都短于 BLE_MIN_NOTIFY_INTERVAL_MS，速率限制必然推迟通知)，与 HOP_SIZE 配置无关。
+    // 发送端同 BLEService: 真实的 DetectionFrameQueue，默认 MTU 23 (负载 20 字节，每次通知 1 条记录)，
+    // 速率受限时安排一次定时发送; 接收端解码每次通知，检查没有记录被覆盖、每次翻转都送达
+    const uint32_t durationMs = 10 * 60 * 1000;
+    const int payloadLimit = 20;
+    bool ok = true;
+    const uint32_t resultIntervalMs[2] = {600, 150};
+    uint32_t notificationsByRate[2] = {0, 0};
+    
+    for (int run = 0; run < 2; run++) {
+        uint32_t intervalMs = resultIntervalMs[run];
+        PublishPolicy policy;
+        static DetectionFrameQueue queue;
+        queue.clear();
+        unsigned int seed = 99;
+        uint32_t notifications = 0;
+        uint32_t lastNotifyMs = 0;
+        uint32_t lastPublishMs = 0;
+        uint32_t maxGapMs = 0;
+        uint32_t minNotifyGapMs = durationMs;
+        bool flushScheduled = false;
+        uint32_t flushAtMs = 0;
+        int maxPending = 0;
+        bool lastTremor = false;
+        uint32_t flips = 0;
+        uint32_t flipsPublished = 0;
+        uint32_t results = 0;
+        
+        // 接收端: 解码后的翻转 (时间戳须与发送端翻转的窗口一致)
+        bool receivedTremor = false;
+        uint32_t flipsReceived = 0;
+        uint32_t flipMs[4] = {0, 0, 0, 0};
+        uint32_t receivedFlipMs[4] = {0, 0, 0, 0};
+        bool decodeOk = true;
+        
+        auto schedule = [&](uint32_t atMs) {
+            if (!flushScheduled) {
+                flushScheduled = true;
+                flushAtMs = atMs;
+                policy.countDeferral();
+            }
+        };
+        auto flush = [&](uint32_t nowMs) {
+            if (queue.getPending() == 0) {
+                return;
+            }
+            uint32_t delay = policy.notifyDelay(nowMs);
+            if (delay > 0) {
+                schedule(nowMs + delay);
+                return;
+            }
+            uint8_t value[frame::HEADER_SIZE + 4 * frame::RECORD_SIZE];
+            DetectionRecord received[4];
+            int sent = 0;
+            int length = queue.encodePending(value, payloadLimit, frame::recordsPerPayload(payloadLimit), &sent);
+            int count = frame::decodeBatch(value, length, received, 4);
+            decodeOk = decodeOk && length <= payloadLimit && count == sent && count > 0;
+            for (int i = 0; i < count; i++) {
+                if (received[i].tremorDetected != receivedTremor) {
+                    if (flipsReceived < 4) {
+                        receivedFlipMs[flipsReceived] = received[i].timestampMs;
+                    }
+                    flipsReceived++;
+                    receivedTremor = received[i].tremorDetected;
+                }
+            }
+            queue.markSent(sent);
+            if (notifications > 0 && nowMs - lastNotifyMs < minNotifyGapMs) {
+                minNotifyGapMs = nowMs - lastNotifyMs;
+            }
+            policy.notified(nowMs);
+            lastNotifyMs = nowMs;
+            notifications++;
+            if (queue.getPending() > 0) {
+                schedule(nowMs + BLE_MIN_NOTIFY_INTERVAL_MS);
+            }
+        };
+        
+        for (uint32_t ms = (uint32_t)(WINDOW_SIZE * 1000 / SAMPLE_RATE); ms <= durationMs; ms += intervalMs) {
+            // 定时发送先于本窗口的结果到期
+            while (flushScheduled && flushAtMs <= ms) {
+                flushScheduled = false;
+                flush(flushAtMs);
+            }
+            
+            seed = seed * 1103515245u + 12345u;
+            float noise = ((seed >> 16) % 1000) / 1000.0f * 0.02f;
+            
+            DetectionRecord record;
+            record.sequence = (uint16_t)results;
+            record.timestampMs = ms;
+            record.tremorDetected = ms >= 180000 && ms < 300000;
+            float ramp = (ms - 180000) / 20000.0f;
+            record.tremorIntensity = noise + (record.tremorDetected ? (ramp < 1.0f ? 0.3f + ramp * 0.5f : 0.8f) : 0.05f);
+            record.dyskinesiaDetected = false;
+            bool fluctuating = ms >= 360000 && ms < 420000;
+            record.dyskinesiaIntensity = noise + (fluctuating ? ((results & 1) ? 0.4f : 0.1f) : 0.0f);
+            record.fogDetected = false;
+            record.motionState = record.tremorDetected ? 1 : 0;
+            record.dominantAxis = -1;
+            results++;
+            
+            bool flip = record.tremorDetected != lastTremor;
+            lastTremor = record.tremorDetected;
+            if (flip && flips < 4) {
+                flipMs[flips] = ms;
+            }
+            flips += flip ? 1 : 0;
+            
+            if (policy.offer(record)) {
+                flipsPublished += flip ? 1 : 0;
+                if (results > 1 && ms - lastPublishMs > maxGapMs) {
+                    maxGapMs = ms - lastPublishMs;
+                }
+                lastPublishMs = ms;
+                queue.pushLatest(record);
+                if (queue.getPending() > maxPending) {
+                    maxPending = queue.getPending();
+                }
+                flush(ms);
+            }
+        }
+        while (flushScheduled) {
+            flushScheduled = false;
+            flush(flushAtMs);
+        }
+        notificationsByRate[run] = notifications;
+        
+        bool flipTimesOk = flipsReceived == flips;
+        for (uint32_t f = 0; f < flips && f < 4; f++) {
+            flipTimesOk = flipTimesOk && receivedFlipMs[f] == flipMs[f];
+        }
+        
+        printf("\n每 %lu ms 一个结果: %lu 个结果, 发布 %lu, 抑制 %lu, 通知 %lu, 推迟 %lu\n", (unsigned long)intervalMs,
+               (unsigned long)results, (unsigned long)policy.getPublished(), (unsigned long)policy.getSuppressed(),
+               (unsigned long)notifications, (unsigned long)policy.getDeferred());
+        printf("  队列: 最多积压 %d, 合并 %lu, 覆盖 %lu\n", maxPending,
+               (unsigned long)queue.getMerged(), (unsigned long)queue.getDropped());
+        printf("  标志翻转 %lu/%lu 已发布, %lu 已送达 (时间戳一致: %s), 最长发布间隔 %lu ms, 最短通知间隔 %lu ms\n",
+               (unsigned long)flipsPublished, (unsigned long)flips, (unsigned long)flipsReceived,
+               flipTimesOk ? "✓" : "✗", (unsigned long)maxGapMs, (unsigned long)minNotifyGapMs);
+        
+        if (flipsPublished != flips || flips != 2 || !flipTimesOk || !decodeOk
+            || queue.getDropped() != 0 || queue.getPending() != 0
+            || maxGapMs > BLE_PUBLISH_HEARTBEAT_MS + intervalMs
+            || minNotifyGapMs < BLE_MIN_NOTIFY_INTERVAL_MS
+            || policy.getPublished() + policy.getSuppressed() != results
+            || policy.getSuppressed() < results / 2
+            || policy.getDeferred() == 0 || policy.getDeferred() > notifications) {
+            ok = false;
+        }
+    }
+    
+    // 结果速率提高 4 倍，通知数只随变化量增长 (不应接近 4 倍)
+    bool flat = notificationsByRate[1] < notificationsByRate[0] * 2;
+    printf("\n通知数 (600 ms / 150 ms 一个结果): %lu / %lu, 基本持平: %s\n",
+           (unsigned long)notificationsByRate[0], (unsigned long)notificationsByRate[1], flat ? "✓ 是" : "✗ 否");
+    
+    if (ok && flat) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 16: flash 事件日志 (追加、掉电恢复、断点续传下载)
+static DetectionRecord makeLogRecord(uint32_t i) {
+    DetectionRecord record;
+    record.sequence = (uint16_t)i;
+    record.timestampMs = i * 615;
+    record.tremorDetected = (i % 7) == 0;
+    record.tremorIntensity = (i % 100) * 0.01f;
+    record.dyskinesiaDetected = false;
+    record.dyskinesiaIntensity = 0.0f;
+    record.fogDetected = (i % 11) == 0;
+    record.motionState = (uint8_t)(i % 3);
+    record.dominantAxis = (int8_t)(i % 4) - 1;
+    return record;
+}
+
+// 从 cursor 下载到日志末尾，校验记录内容和序号连续，返回收到的记录数
+static int drainLog(EventLog& log, uint32_t* cursor, int payloadLimit, int maxChunks, bool* ok) {
+    static uint8_t chunk[eventlog::MAX_CHUNK_SIZE];
+    static DetectionRecord records[eventlog::CHUNK_MAX_RECORDS];
+    int received = 0;
+    for (int n = 0; n < maxChunks; n++) {
+        uint32_t next;
+        int length = log.encodeChunk(*cursor, chunk, payloadLimit, &next);
+        uint32_t first = 0;
+        int count = eventlog::decodeChunk(chunk, length, records, eventlog::CHUNK_MAX_RECORDS, &first);
+        if (count < 0 || length > payloadLimit || first < *cursor || first + count != next) {
+            *ok = false;
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            if (records[i].sequence != (uint16_t)(first + i) || records[i].timestampMs != (first + i) * 615
+                || records[i].motionState != (first + i) % 3) {
+                *ok = false;
+            }
+        }
+        *cursor = next;
+        received += count;
+        if (count == 0) {
+            break;
+        }
+    }
+    return received;
+}
+
+void test_event_log() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 16: flash 事件日志             ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    // 64KB = 16 个 4KB 扇区 (QSPI NOR: 编程单位 1 字节)
+    HeapFlash flash(64 * 1024, 4096, 1);
+    EventLog log(flash);
+    bool ok = log.mount() && log.getNextIndex() == 0;
+    
+    // 追加: 写满约 4 圈
+    const uint32_t total = log.getCapacity() * 4;
+    Timer timer;
+    timer.start();
+    for (uint32_t i = 0; i < total; i++) {
+        ok = log.append(makeLogRecord(i)) && ok;
+    }
+    int64_t appendUs = timer.elapsed_time().count();
+    
+    uint32_t minErase = 0xFFFFFFFF;
+    uint32_t maxErase = 0;
+    for (uint32_t sector = 0; sector < 16; sector++) {
+        uint32_t count = flash.getEraseCount(sector);
+        minErase = count < minErase ? count : minErase;
+        maxErase = count > maxErase ? count : maxErase;
+    }
+    
+    // 重新挂载 (模拟复位) 恢复写入位置
+    EventLog remounted(flash);
+    bool recovered = remounted.mount() && remounted.getNextIndex() == total
+                     && remounted.getFirstIndex() == log.getFirstIndex();
+    
+    // 掉电: 一条记录只写了一半，复位后继续追加
+    remounted.append(makeLogRecord(total));
+    flash.tearNextProgram(5);
+    remounted.append(makeLogRecord(total + 1));
+    EventLog afterCut(flash);
+    recovered = afterCut.mount() && afterCut.getNextIndex() == total + 2 && recovered;
+    for (uint32_t i = total + 2; i < total + 40; i++) {
+        afterCut.append(makeLogRecord(i));
+    }
+    
+    // 下载: 从 0 请求 (已被覆盖，从最旧的开始)，中途断开后从续传位置继续
+    uint32_t cursor = 0;
+    timer.start();
+    int received = drainLog(afterCut, &cursor, eventlog::MAX_CHUNK_SIZE, 100, &ok);
+    EventLog reconnected(flash);
+    reconnected.mount();
+    received += drainLog(reconnected, &cursor, eventlog::MAX_CHUNK_SIZE, 1000000, &ok);
+    int64_t drainUs = timer.elapsed_time().count();
+    uint32_t expected = total + 40 - afterCut.getFirstIndex() - 1;     // 写了一半的记录被跳过
+    
+    // 默认 MTU (每块 1 条) 同样可用
+    uint32_t smallCursor = reconnected.getNextIndex() - 5;
+    bool smallOk = true;
+    int smallReceived = drainLog(reconnected, &smallCursor, 20, 100, &smallOk);
+    
+    // 片内 flash: 编程单位 8 字节，条目补齐
+    HeapFlash internal(16 * 1024, 2048, 8);
+    EventLog aligned(internal);
+    bool alignedOk = aligned.mount();
+    for (uint32_t i = 0; i < 500; i++) {
+        alignedOk = aligned.append(makeLogRecord(i)) && alignedOk;
+    }
+    uint32_t alignedCursor = 0;
+    int alignedReceived = drainLog(aligned, &alignedCursor, eventlog::MAX_CHUNK_SIZE, 1000, &alignedOk);
+    
+    // 写线程队列: 发布端 (BLE 事件线程) 只入队，写线程擦除扇区期间记录积压在队列中;
+    // 写线程停顿超过 EVENT_LOG_QUEUE_SLOTS 条时丢弃新记录并计数，已入队的按顺序写入
+    static EventLogQueue queue;
+    queue.reset();
+    int wakeups = 0;
+    queue.setReadyCallback([](void* context) { (*(int*)context)++; }, &wakeups);
+    HeapFlash queueFlash(16 * 1024, 4096, 1);
+    EventLog queued(queueFlash);
+    bool queueOk = queued.mount();
+    uint32_t next = 0;
+    for (int i = 0; i < 2 * EVENT_LOG_QUEUE_SLOTS; i++) {
+        if (queue.push(makeLogRecord(next))) {
+            next++;
+        }
+    }
+    queueOk = queueOk && queue.getDropped() == EVENT_LOG_QUEUE_SLOTS && queue.getPending() == EVENT_LOG_QUEUE_SLOTS;
+    int maxQueued = 0;
+    DetectionRecord record;
+    for (int i = 0; i < 1000; i++) {
+        // 写线程每 EVENT_LOG_QUEUE_SLOTS - 1 条记录才运行一次 (模拟擦除期间的积压)
+        if (i % (EVENT_LOG_QUEUE_SLOTS - 1) == 0) {
+            while (queue.pop(&record)) {
+                queueOk = queued.append(record) && queueOk;
+            }
+        }
+        queueOk = queue.push(makeLogRecord(next++)) && queueOk;
+        maxQueued = queue.getPending() > maxQueued ? queue.getPending() : maxQueued;
+    }
+    while (queue.pop(&record)) {
+        queueOk = queued.append(record) && queueOk;
+    }
+    uint32_t queueCursor = 0;
+    int queueReceived = drainLog(queued, &queueCursor, eventlog::MAX_CHUNK_SIZE, 1000, &queueOk);
+    queueOk = queueOk && (uint32_t)queueReceived == next && queue.getDropped() == EVENT_LOG_QUEUE_SLOTS
+              && wakeups == (int)next;
+    
+    float drainBytes = received * (float)frame::RECORD_SIZE;
+    printf("\n结果:\n");
+    printf("  追加 %lu 条: %.2f us/条, 擦除 %lu 次, 扇区擦除次数 %lu..%lu\n", (unsigned long)total,
+           (float)appendUs / total, (unsigned long)log.getErases(), (unsigned long)minErase, (unsigned long)maxErase);
+    printf("  复位/掉电恢复: %s, 跳过损坏条目 %lu\n", recovered ? "✓" : "✗",
+           (unsigned long)(afterCut.getCorruptEntries() + reconnected.getCorruptEntries()));
+    printf("  下载 %d/%lu 条 (断开续传), %.1f MB/s, %.1f 条/ms\n", received, (unsigned long)expected,
+           drainBytes / (drainUs > 0 ? drainUs : 1), received / ((drainUs > 0 ? drainUs : 1) / 1000.0f));
+    printf("  小 MTU: %d 条, 8 字节编程单位: %d 条, 非法访问 %lu\n", smallReceived, alignedReceived,
+           (unsigned long)(flash.getViolations() + internal.getViolations()));
+    printf("  写线程队列: 写入 %d/%lu 条, 最多积压 %d, 丢弃 %lu (写线程停顿时): %s\n", queueReceived,
+           (unsigned long)next, maxQueued, (unsigned long)queue.getDropped(), queueOk ? "✓" : "✗");
+    
+    if (ok && recovered && queueOk && (uint32_t)received == expected && maxErase - minErase <= 1
+        && smallOk && smallReceived == 5 && alignedOk && alignedReceived == 500
+        && flash.getViolations() == 0 && internal.getViolations() == 0) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 17: QSPI 原始数据记录器 (双缓冲，模拟 NOR 编程/擦除延迟)
+static uint32_t recorderNowMs = 0;
+
+static uint32_t recorderClock() {
+    return recorderNowMs;
+}
+
+// 按 FIFO 水位中断的节奏突发写入样本，写线程按 flash 延迟异步完成 (块写完才释放缓冲区)
+static void runRecorder(RawRecorder& rec, HeapFlash& flash, const int16_t* trace, int samples,
+                            uint32_t programPageUs, uint32_t eraseSectorUs) {
+    const uint64_t sampleUs = 1000000 / SAMPLE_RATE;
+    const uint32_t pagesPerBlock = RECORDER_BLOCK_SIZE / 256;
+    const uint32_t blocksPerSector = flash.getEraseSize() / RECORDER_BLOCK_SIZE;
+    bool writing = false;
+    uint64_t doneAtUs = 0;
+    
+    for (int i = 0; i <= samples + FIFO_WATERMARK; i++) {
+        uint64_t nowUs = (uint64_t)i * sampleUs;
+        recorderNowMs = (uint32_t)(nowUs / 1000);
+        
+        // 写线程: 当前块编程完成后才释放缓冲区 (service 在完成时刻调用)
+        if (writing && nowUs >= doneAtUs) {
+            rec.service();
+            writing = false;
+        }
+        if (!writing && rec.hasPendingBlock()) {
+            uint64_t cost = (uint64_t)pagesPerBlock * programPageUs;
+            if (rec.getNextBlock() % blocksPerSector == 0) {
+                cost += eraseSectorUs;
+            }
+            writing = true;
+            doneAtUs = nowUs + cost;
+        }
+        
+        // 采集线程: 每 FIFO_WATERMARK 个样本一批
+        if (i > 0 && i % FIFO_WATERMARK == 0) {
+            for (int n = i - FIFO_WATERMARK; n < i && n < samples; n++) {
+                rec.push(trace[3 * n], trace[3 * n + 1], trace[3 * n + 2], (uint32_t)n);
+            }
+        }
+    }
+    rec.stop();
+    while (writing || rec.hasPendingBlock()) {
+        rec.service();
+        writing = false;
+    }
+}
+
+// 读回所有块，校验会话头和样本; 返回数据样本数
+static int verifyRecording(HeapFlash& flash, uint32_t blocks, const int16_t* trace, int* sessions, bool* ok) {
+    static uint8_t block[RECORDER_BLOCK_SIZE];
+    static int16_t xyz[sessionfile::SAMPLES_PER_BLOCK * 3];
+    sessionfile::SessionInfo session;
+    sessionfile::BlockInfo info;
+    int samples = 0;
+    uint32_t currentSession = 0xFFFFFFFF;
+    *sessions = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        flash.read(b * RECORDER_BLOCK_SIZE, block, RECORDER_BLOCK_SIZE);
+        int type = sessionfile::decodeBlock(block, &session, &info, xyz);
+        if (type == 1) {
+            (*sessions)++;
+            currentSession = session.sessionId;
+            if (session.sessionId != b || session.odrHz != SAMPLE_RATE || session.sensorId != lsm6dsl::WHO_AM_I_VALUE) {
+                *ok = false;
+            }
+        } else if (type == 2) {
+            if (info.sessionId != currentSession) {
+                *ok = false;
+            }
+            for (int i = 0; i < info.count * 3; i++) {
+                if (xyz[i] != trace[3 * info.firstSample + i]) {
+                    *ok = false;
+                }
+            }
+            samples += info.count;
+        } else {
+            *ok = false;
+        }
+    }
+    return samples;
+}
+
+void test_raw_recorder() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 17: QSPI 原始数据记录器        ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    // 10 分钟数据
+    const int samples = SAMPLE_RATE * 600;
+    static int16_t trace[SAMPLE_RATE * 600 * 3];
+    unsigned int seed = 4242;
+    for (int i = 0; i < samples * 3; i++) {
+        seed = seed * 1103515245u + 12345u;
+        trace[i] = (int16_t)(((i % 3) == 2 ? GRAVITY_LSB : 0) + (int)((seed >> 16) % 2001) - 1000);
+    }
+    
+    // MX25R6435F 典型值: 页编程 0.85 ms，4KB 扇区擦除 40 ms (最大 4 ms / 240 ms)
+    HeapFlash flash(512 * 1024, 4096, 1);
+    flash.setLatency(256, 850, 40000);
+    static RawRecorder rec(flash);
+    rec.setClock(recorderClock);
+    bool ok = rec.mount() && rec.getNextBlock() == 0;
+    ok = rec.startSession(lsm6dsl::WHO_AM_I_VALUE, 0, 0, 0) && ok;
+    
+    Timer timer;
+    timer.start();
+    runRecorder(rec, flash, trace, samples, 850, 40000);
+    int64_t hostUs = timer.elapsed_time().count();
+    uint64_t busyUs = flash.getElapsedUs();
+    bool typicalNoDrop = rec.getSamplesDropped() == 0 && rec.getSamplesRecorded() == (uint32_t)samples;
+    
+    // 最坏延迟同样不丢样本
+    flash.setLatency(256, 4000, 240000);
+    rec.mount();
+    ok = rec.startSession(lsm6dsl::WHO_AM_I_VALUE, 0, 0, 0) && ok;
+    uint32_t secondSession = rec.getSessionId();
+    uint32_t recordedBefore = rec.getSamplesRecorded();
+    runRecorder(rec, flash, trace, samples, 4000, 240000);
+    uint64_t worstBusyUs = flash.getElapsedUs() - busyUs;
+    bool worstNoDrop = rec.getSamplesDropped() == 0 && rec.getSamplesRecorded() - recordedBefore == (uint32_t)samples;
+    
+    int sessions = 0;
+    int readBack = verifyRecording(flash, rec.getNextBlock(), trace, &sessions, &ok);
+    
+    // flash 严重过慢 (擦除 5 秒): 采集端不等待，丢弃样本并计数，读回的数据仍然正确
+    HeapFlash slow(128 * 1024, 4096, 1);
+    RawRecorder* slowRec = new RawRecorder(slow);
+    slowRec->mount();
+    slowRec->startSession(lsm6dsl::WHO_AM_I_VALUE, 0, 0, 0);
+    runRecorder(*slowRec, slow, trace, samples / 4, 850, 5000000);
+    int slowSessions = 0;
+    bool slowOk = true;
+    int slowRead = verifyRecording(slow, slowRec->getNextBlock(), trace, &slowSessions, &slowOk);
+    bool slowAccounted = slowRec->getSamplesDropped() > 0
+        && slowRec->getSamplesRecorded() + slowRec->getSamplesDropped() == (uint32_t)(samples / 4)
+        && (uint32_t)slowRead == slowRec->getSamplesRecorded();
+    
+    // 容量: 8 MB QSPI 减去事件日志分区
+    float hours = (8.0f * 1024 * 1024 - EVENT_LOG_SIZE) / RECORDER_BLOCK_SIZE * sessionfile::SAMPLES_PER_BLOCK
+                  / SAMPLE_RATE / 3600.0f;
+    
+    printf("\n结果:\n");
+    printf("  每块 %d 样本, flash 忙碌占比: 典型延迟 %.2f%%, 最坏延迟 %.2f%%\n", sessionfile::SAMPLES_PER_BLOCK,
+           100.0f * busyUs / ((uint64_t)samples * 1000000 / SAMPLE_RATE),
+           100.0f * worstBusyUs / ((uint64_t)samples * 1000000 / SAMPLE_RATE));
+    printf("  丢弃: 典型 %s, 最坏 %s; 会话 %d (第二个 ID %lu), 读回 %d 样本\n",
+           typicalNoDrop ? "无" : "有", worstNoDrop ? "无" : "有", sessions, (unsigned long)secondSession, readBack);
+    printf("  过慢 flash: 记录 %lu, 丢弃 %lu, 读回 %d, 计数一致: %s\n",
+           (unsigned long)slowRec->getSamplesRecorded(), (unsigned long)slowRec->getSamplesDropped(), slowRead,
+           slowAccounted ? "✓" : "✗");
+    printf("  主机模拟 10 分钟 x2: %.1f ms; 8MB QSPI 可记录 %.1f 小时\n", hostUs / 1000.0f, hours);
+    
+    bool passed = ok && typicalNoDrop && worstNoDrop && sessions == 2 && readBack == 2 * samples
+        && slowOk && slowAccounted && flash.getViolations() == 0 && slow.getViolations() == 0;
+    delete slowRec;
+    
+    if (passed) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 18: 离线回放 (与板上相同的窗口组装，样本时钟驱动 FOG 计时)
+// 静止 10 秒 -> 行走 10 秒 -> 停住 6 秒 -> 震颤 19 秒 (原始 LSB)
+static void makeReplayTrace(replay::Session* session) {
+    const int samples = SAMPLE_RATE * 45;
+    session->name = "synthetic";
+    session->firstSample = 0;
+    session->xyz.resize(samples * 3);
+    unsigned int seed = 777;
+    for (int i = 0; i < samples; i++) {
+        float t = (float)i / SAMPLE_RATE;
+        float walk = (t >= 10.0f && t < 20.0f) ? 3000.0f * sinf(2.0f * M_PI * 1.8f * t) : 0.0f;
+        // 震颤叠加在手腕倾斜的静态分量上，合成幅值不被整流 (单轴合成模式下仍为 4.3Hz)
+        float tremor = (t >= 26.0f) ? 4000.0f + 2500.0f * sinf(2.0f * M_PI * 4.3f * t) : 0.0f;
+        int noise[3];
+        for (int a = 0; a < 3; a++) {
+            seed = seed * 1103515245u + 12345u;
+            noise[a] = (int)((seed >> 16) % 81) - 40;
+        }
+        session->xyz[3 * i] = (int16_t)(walk + noise[0]);
+        session->xyz[3 * i + 1] = (int16_t)(tremor + noise[1]);
+        session->xyz[3 * i + 2] = (int16_t)(GRAVITY_LSB + noise[2]);
+    }
+}
+
+static uint32_t replayTestTime = 0;
+
+static uint32_t replayTestClock(void* context) {
+    return replayTestTime;
+}
+
+void test_replay_engine() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 18: 离线回放引擎               ║\n");
+    printf("╚═══════════════════════════════════════╝\n");
+    
+    static replay::Session session;
+    makeReplayTrace(&session);
+    int samples = (int)session.getSampleCount();
+    
+    // 逐窗口检查: 序号、起始样本和窗口内容与原始样本一致，FOG 时间来自样本时钟
+    static WindowBuilder builder;
+    static AnalysisWindow window;
+    static Detector detector;
+    builder.reset();
+    detector.reset();
+    detector.setClock(replayTestClock, nullptr);
+    
+    int windows = 0;
+    bool windowsOk = true;
+    uint32_t firstFogMs = 0;
+    int tremorWindows = 0;
+    for (int n = 0; n < samples; n++) {
+        const int16_t* xyz = &session.xyz[3 * n];
+        if (!builder.addSample(xyz[0], xyz[1], xyz[2])) {
+            continue;
+        }
+        builder.fillWindow(&window);
+        if (window.sequence != (uint32_t)windows || window.firstSample != (uint32_t)(windows * HOP_SIZE)) {
+            windowsOk = false;
+        }
+        for (int i = 0; i < WINDOW_SIZE; i += 17) {
+            const int16_t* raw = &session.xyz[3 * (window.firstSample + i)];
+            float ax = raw[0] * ACC_LSB_TO_MS2;
+            float ay = raw[1] * ACC_LSB_TO_MS2;
+            float az = raw[2] * ACC_LSB_TO_MS2 - 9.81f;
+            if (fabsf(windowMagnitude(window, i) - sqrtf(ax * ax + ay * ay + az * az)) > 0.01f) {
+                windowsOk = false;
+            }
+        }
+        
+        replayTestTime = (uint32_t)((uint64_t)(window.firstSample + WINDOW_SIZE - 1) * 1000 / SAMPLE_RATE);
+        DetectionResult result = detector.analyzeWindow(window);
+        if (result.timestampMs != replayTestTime || result.sequence != window.sequence) {
+            windowsOk = false;
+        }
+        if (result.fogDetected && firstFogMs == 0) {
+            firstFogMs = result.timestampMs;
+        }
+        if (result.tremorDetected && result.timestampMs >= 26000 + WINDOW_SIZE * 1000 / SAMPLE_RATE) {
+            tremorWindows++;
+        }
+        windows++;
+    }
+    int expectedWindows = (samples - WINDOW_SIZE) / HOP_SIZE + 1;
+    
+    // 同一回放器依次处理两段，结果与单独处理相同 (每段从头开始)
+    static replay::SessionReplayer replayer;
+    static replay::Session shortSession;
+    shortSession = session;
+    shortSession.xyz.resize(SAMPLE_RATE * 15 * 3);
+    
+    Timer timer;
+    timer.start();
+    replay::Summary first = replayer.run(session, nullptr);
+    replayer.run(shortSession, nullptr);
+    replay::Summary again = replayer.run(session, nullptr);
+    int64_t elapsedUs = timer.elapsed_time().count();
+    
+    bool deterministic = first.windows == again.windows && first.tremorWindows == again.tremorWindows
+        && first.fogWindows == again.fogWindows && first.dyskinesiaWindows == again.dyskinesiaWindows;
+    bool matchesManual = first.windows == (uint32_t)windows && first.fogWindows > 0;
+    uint32_t totalSamples = 2 * session.getSampleCount() + shortSession.getSampleCount();
+    
+    // 会话文件边读边回放 (按块从映射中读取样本)，结果与内存中的回放相同
+    bool fileReplayOk = false;
+    char path[] = "/tmp/replay_test_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file = (fd >= 0) ? fdopen(fd, "wb") : nullptr;
+    if (file != nullptr) {
+        sessionfile::SessionInfo info;
+        memset(&info, 0, sizeof(info));
+        info.sensorId = lsm6dsl::WHO_AM_I_VALUE;
+        info.odrHz = SAMPLE_RATE;
+        info.fullScaleG = 2;
+        static sessionfile::FileWriter writer;
+        bool written = writer.open(file, info);
+        for (int n = 0; n < samples && written; n++) {
+            written = writer.append(session.xyz[3 * n], session.xyz[3 * n + 1], session.xyz[3 * n + 2], n);
+        }
+        written = written && writer.close();
+        written = (fclose(file) == 0) && written;
+        
+        std::vector<replay::SegmentSummary> segments;
+        replay::LoadStats stats;
+        memset(&stats, 0, sizeof(stats));
+        if (written && replay::replaySessionFile(path, &replayer, nullptr, &segments, &stats)) {
+            const replay::Summary& fromFile = segments.empty() ? first : segments[0].summary;
+            fileReplayOk = segments.size() == 1 && stats.sessions == 1 && stats.gaps == 0
+                && fromFile.samples == (uint32_t)samples && fromFile.windows == first.windows
+                && fromFile.tremorWindows == first.tremorWindows && fromFile.fogWindows == first.fogWindows
+                && fromFile.dyskinesiaWindows == first.dyskinesiaWindows;
+        }
+        remove(path);
+    }
+    
+    printf("\n结果:\n");
+    printf("  %d 样本, 窗口 %d (应为 %d), 内容一致: %s\n", samples, windows, expectedWindows,
+           windowsOk ? "✓" : "✗");
+    printf("  首个 FOG 窗口: %lu ms (行走在 20000 ms 停止), 震颤窗口 %d\n",
+           (unsigned long)firstFogMs, tremorWindows);
+    printf("  回放: 震颤 %lu, FOG %lu 窗口; 重复回放一致: %s\n",
+           (unsigned long)first.tremorWindows, (unsigned long)first.fogWindows, deterministic ? "✓" : "✗");
+    printf("  会话文件回放与内存回放一致: %s\n", fileReplayOk ? "✓" : "✗");
+    printf("  吞吐: %.0f 样本/秒 (%.0f 倍实时)\n", totalSamples * 1e6f / elapsedUs,
+           (float)totalSamples / SAMPLE_RATE * 1e6f / elapsedUs);
+    
+    bool passed = windowsOk && windows == expectedWindows
+        && firstFogMs >= 20000 + FREEZE_TIME_MS && firstFogMs <= 26000
+        && tremorWindows > 0 && deterministic && matchesManual && fileReplayOk;
+    
+    if (passed) {
+        printf("\n✅ 测试通过！\n");
+        led1 = 1;
+    } else {
+        printf("\n❌ 测试失败！\n");
+        led1 = 0;
+    }
+}
+
+// 测试 19: 会话文件 (列式块 + 稀疏索引，按样本序号随机访问窗口)
+void test_session_file() {
+    printf("\n╔═══════════════════════════════════════╗\n");
+    printf("║  测试 19: 会话文件格式               ║\n");
     printf("╚═══════════════════════════════════════╝\n");
     
-    FFTProcessor fft;
-    Detector detector;
-    float testData[WINDOW_SIZE];
+    // 20000 个样本，样本 9000 之后缺 300 个 (记录端丢弃)
+    const int samples = 20000;
+    const uint32_t gapAt = 9000;
+    const uint32_t gapLength = 300;
+    static int16_t trace[20000 * 3];
+    unsigned int seed = 2024;
+    for (int i = 0; i < samples * 3; i++) {
+        seed = seed * 1103515245u + 12345u;
+        trace[i] = (int16_t)(((i % 3) == 2 ? GRAVITY_LSB : 0) + (int)((seed >> 16) % 4001) - 2000);
+    }
     
-    // 生成 4Hz 信号
-    generateSineWave(testData, WINDOW_SIZE, 4.0f, 2.0f);
+    sessionfile::SessionInfo info;
+    memset(&info, 0, sizeof(info));
+    info.sensorId = lsm6dsl::WHO_AM_I_VALUE;
+    info.odrHz = SAMPLE_RATE;
+    info.fullScaleG = 2;
     
-    // FFT 分析
-    FrequencyPeak peak = fft.process(testData);
-    printf("FFT 分析: 频率 = %.2f Hz, 幅值 = %.3f\n", peak.frequency, peak.magnitude);
+    FILE* file = tmpfile();
+    if (file == nullptr) {
+        printf("\n❌ 测试失败！(无法创建临时文件)\n");
+        led1 = 0;
+        return;
+    }
+    static sessionfile::FileWriter writer;
+    bool ok = writer.open(file, info);
+    for (int i = 0; i < samples; i++) {
+        uint32_t index = (uint32_t)i < gapAt ? (uint32_t)i : (uint32_t)i + gapLength;
+        ok = writer.append(trace[3 * i], trace[3 * i + 1], trace[3 * i + 2], index) && ok;
+    }
+    ok = writer.close() && ok;
     
-    // 检测器分析
-    DetectionResult result = detector.analyze(testData, 1.0f);
+    // 读回整个文件 (主机工具用 mmap，这里读到内存)
+    long length = ftell(file);
+    uint8_t* image = new uint8_t[length];
+    rewind(file);
+    ok = fread(image, 1, length, file) == (size_t)length && ok;
+    fclose(file);
+    
+    Timer timer;
+    timer.start();
+    sessionfile::FileView view;
+    bool opened = view.open(image, (uint32_t)length);
+    int64_t openUs = timer.elapsed_time().count();
+    bool countsOk = opened && view.getSampleCount() == (uint32_t)samples && view.verify() == 0;
+    
+    // 顺序扫描
+    static int16_t xyz[sessionfile::SAMPLES_PER_BLOCK * 3];
+    int scanned = 0;
+    bool scanOk = opened;
+    timer.start();
+    for (uint32_t k = 0; opened && k < view.getBlockCount(); k++) {
+        int count = view.getBlockSamples(k);
+        sessionfile::readColumns(view.getBlock(k), 0, count, xyz);
+        uint32_t first = view.getBlockFirstSample(k);
+        int position = first < gapAt ? (int)first : (int)(first - gapLength);
+        if (memcmp(xyz, &trace[3 * position], count * 3 * sizeof(int16_t)) != 0) {
+            scanOk = false;
+        }
+        scanned += count;
+    }
+    int64_t scanUs = timer.elapsed_time().count();
+    scanOk = scanOk && scanned == samples;
+    
+    // 随机窗口: 不跨缺口的窗口完整读出，跨缺口的读到缺口为止
+    const int windows = 2000;
+    static int16_t window[WINDOW_SIZE * 3];
+    bool randomOk = opened;
+    int partial = 0;
+    timer.start();
+    for (int w = 0; w < windows && opened; w++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t position = (seed >> 8) % (uint32_t)(samples - WINDOW_SIZE);
+        uint32_t sample = position < gapAt ? position : position + gapLength;
+        int expected = WINDOW_SIZE;
+        if (sample < gapAt && sample + WINDOW_SIZE > gapAt) {
+            expected = (int)(gapAt - sample);
+            partial++;
+        }
+        int got = view.readSamples(sample, WINDOW_SIZE, window);
+        if (got != expected || memcmp(window, &trace[3 * position], got * 3 * sizeof(int16_t)) != 0) {
+            randomOk = false;
+        }
+    }
+    int64_t randomUs = timer.elapsed_time().count();
+    bool gapOk = opened && view.findBlock(gapAt + 10) < 0 && view.findBlock(samples + gapLength) < 0
+        && view.findBlock(gapAt + gapLength) >= 0;
+    
+    // 损坏: 块数据翻转一位时校验发现，尾部损坏时拒绝打开
+    image[sessionfile::BLOCK_SIZE * 3 + 100] ^= 0x04;
+    bool corruptFound = view.verify() == 1;
+    image[length - sessionfile::TRAILER_SIZE + 8] ^= 0x01;
+    sessionfile::FileView broken;
+    bool trailerRejected = !broken.open(image, (uint32_t)length);
+    delete[] image;
+    
+    // 记录器写入 flash 的数据块与主机写入的块编码相同 (只有采集时间可能不同)
+    HeapFlash flash(64 * 1024, 4096, 1);
+    static RawRecorder rec(flash);
+    rec.mount();
+    rec.startSession(lsm6dsl::WHO_AM_I_VALUE, 0, 0, 0);
+    const int recorded = sessionfile::SAMPLES_PER_BLOCK * 4;
+    for (int i = 0; i < recorded; i++) {
+        rec.push(trace[3 * i], trace[3 * i + 1], trace[3 * i + 2], (uint32_t)i);
+        rec.service();
+    }
+    rec.stop();
+    rec.service();
+    
+    static uint8_t flashBlock[sessionfile::BLOCK_SIZE];
+    static uint8_t hostBlock[sessionfile::BLOCK_SIZE];
+    bool sameEncoding = rec.getNextBlock() == 5;
+    for (int k = 0; k < 4 && sameEncoding; k++) {
+        flash.read((k + 1) * sessionfile::BLOCK_SIZE, flashBlock, sessionfile::BLOCK_SIZE);
+        uint32_t first = (uint32_t)(k * sessionfile::SAMPLES_PER_BLOCK);
+        sessionfile::beginDataBlock(hostBlock, 0, first, sessionfile::getU32(&flashBlock[12]));
+        for (int i = 0; i < sessionfile::SAMPLES_PER_BLOCK; i++) {
+            const int16_t* sample = &trace[3 * (first + i)];
+            sessionfile::putSample(hostBlock, i, sample[0], sample[1], sample[2]);
+        }
+        sessionfile::sealDataBlock(hostBlock, sessionfile::SAMPLES_PER_BLOCK);
+        sessionfile::finishDataBlock(hostBlock);
+        sameEncoding = memcmp(flashBlock, hostBlock, sessionfile::BLOCK_SIZE) == 0;
+    }
     
     printf("\n结果:\n");
-    printf("  震颤检测: %s\n", result.tremorDetected ? "✓ 是" : "✗ 否");
-    printf("  震颤强度: %.3f (阈值: %.2f)\n", result.tremorIntensity, TREMOR_THRESHOLD);
+    printf("  %d 样本 -> %ld 字节 (%.2f 字节/样本), %lu 块, 打开 %lld us\n", samples, length,
+           (float)length / samples, (unsigned long)writer.getBlockCount(), (long long)openUs);
+    printf("  顺序扫描: %s, %.1f us (%.1f M样本/秒)\n", scanOk ? "✓" : "✗", (float)scanUs,
+           scanUs > 0 ? (float)samples / scanUs : 0.0f);
+    printf("  随机窗口 x%d: %s (跨缺口 %d 个), %.0f ns/窗口; 缺口定位: %s\n", windows, randomOk ? "✓" : "✗",
+           partial, randomUs * 1000.0f / windows, gapOk ? "✓" : "✗");
+    printf("  损坏块检出: %s, 损坏尾部拒绝: %s, 记录器块编码一致: %s\n", corruptFound ? "✓" : "✗",
+           trailerRejected ? "✓" : "✗", sameEncoding ? "✓" : "✗");
     
-    if (result.tremorDetected && peak.frequency > 3.0f && peak.frequency < 5.0f) {
+    bool passed = ok && countsOk && scanOk && randomOk && gapOk && corruptFound && trailerRejected && sameEncoding;
+    
+    if (passed) {
         printf("\n✅ 测试通过！\n");
         led1 = 1;
     } else {
@@ -51,31 +1780,81 @@ void test_tremor_detection() {
     }
 }
 
-// 测试 2: FFT 6Hz 运动障碍
-void test_dyskinesia_detection() {
+// 测试 20: 阶段计时 (统计、直方图分桶、清零、BLE 诊断编码)
+void test_stage_timing() {
     printf("\n╔═══════════════════════════════════════╗\n");
-    printf("║  测试 2: 运动障碍检测 (6Hz)          ║\n");
+    printf("║  测试 20: 阶段计时计数器             ║\n");
     printf("╚═══════════════════════════════════════╝\n");
     
-    FFTProcessor fft;
-    Detector detector;
-    float testData[WINDOW_SIZE];
+    timing::reset();
     
-    // 生成 6Hz 信号
-    generateSineWave(testData, WINDOW_SIZE, 6.0f, 2.0f);
+    // 分桶边界: < 8us 为桶 0，之后每个桶翻倍，超出范围的归入最后一个桶
+    bool bucketsOk = timing::bucketOf(0) == 0 && timing::bucketOf(7) == 0 && timing::bucketOf(8) == 1
+        && timing::bucketOf(15) == 1 && timing::bucketOf(16) == 2 && timing::bucketOf(100) == 4
+        && timing::bucketOf(3000) == 9 && timing::bucketOf(1UL << 20) == timing::HISTOGRAM_BUCKETS - 1
+        && timing::bucketOf(0xFFFFFFFFUL) == timing::HISTOGRAM_BUCKETS - 1
+        && timing::bucketLowerUs(4) == 64 && timing::bucketOf(timing::bucketLowerUs(9)) == 9;
     
-    // FFT 分析
-    FrequencyPeak peak = fft.process(testData);
-    printf("FFT 分析: 频率 = %.2f Hz, 幅值 = %.3f\n", peak.frequency, peak.magnitude);
+    // 最小/平均/最大和直方图
+    timing::record(timing::STAGE_FFT, 5);
+    timing::record(timing::STAGE_FFT, 100);
+    timing::record(timing::STAGE_FFT, 3000);
+    timing::StageStats stats;
+    bool statsOk = timing::getStats(timing::STAGE_FFT, &stats) && stats.count == 3 && stats.minUs == 5
+        && stats.maxUs == 3000 && timing::meanUs(stats) == 1035
+        && stats.histogram[0] == 1 && stats.histogram[4] == 1 && stats.histogram[9] == 1;
     
-    // 检测器分析
-    DetectionResult result = detector.analyze(testData, 1.0f);
+    // 未记录的阶段为空统计
+    timing::StageStats empty;
+    bool emptyOk = timing::getStats(timing::STAGE_PUBLISH, &empty) && empty.count == 0 && empty.minUs == 0
+        && empty.maxUs == 0;
+    
+    // 编码往返; 直方图计数在编码时饱和到 u16
+    for (int i = 0; i < 70000; i++) {
+        timing::record(timing::STAGE_CONVERT, 1);
+    }
+    static uint8_t encoded[timing::ENCODED_SIZE];
+    int length = timing::encodeStats(encoded);
+    timing::StageStats decoded[timing::NUM_STAGES];
+    int stages = timing::decodeStats(encoded, length, decoded, timing::NUM_STAGES);
+    bool encodeOk = length == timing::ENCODED_SIZE && stages == timing::NUM_STAGES
+        && decoded[timing::STAGE_FFT].count == 3 && decoded[timing::STAGE_FFT].minUs == 5
+        && decoded[timing::STAGE_FFT].maxUs == 3000 && timing::meanUs(decoded[timing::STAGE_FFT]) == 1035
+        && decoded[timing::STAGE_FFT].histogram[9] == 1
+        && decoded[timing::STAGE_CONVERT].count == 70000 && decoded[timing::STAGE_CONVERT].histogram[0] == 0xFFFF
+        && decoded[timing::STAGE_CAPTURE].count == 0;
+    encoded[0] ^= 0xFF;
+    bool badVersion = timing::decodeStats(encoded, length, decoded, timing::NUM_STAGES) < 0;
+    encoded[0] ^= 0xFF;
+    bool truncated = timing::decodeStats(encoded, length - 1, decoded, timing::NUM_STAGES) < 0;
+    
+    // 清零: 读取端立即看到空统计，下一次记录重新开始
+    timing::reset();
+    bool resetOk = timing::getStats(timing::STAGE_FFT, &stats) && stats.count == 0;
+    timing::record(timing::STAGE_FFT, 50);
+    resetOk = resetOk && timing::getStats(timing::STAGE_FFT, &stats) && stats.count == 1 && stats.minUs == 50
+        && stats.maxUs == 50 && stats.histogram[timing::bucketOf(50)] == 1;
+    
+    // 记录开销 (含读两次时钟)
+    const int rounds = 100000;
+    Timer timer;
+    timer.start();
+    for (int i = 0; i < rounds; i++) {
+        uint32_t start = timing::now();
+        timing::record(timing::STAGE_DETECT, timing::now() - start);
+    }
+    int64_t elapsedUs = timer.elapsed_time().count();
+    timing::reset();
     
     printf("\n结果:\n");
-    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
-    printf("  运动障碍强度: %.3f (阈值: %.2f)\n", result.dyskinesiaIntensity, DYSKINESIA_THRESHOLD);
+    printf("  分桶: %s, 统计: %s, 空阶段: %s\n", bucketsOk ? "✓" : "✗", statsOk ? "✓" : "✗", emptyOk ? "✓" : "✗");
+    printf("  编码 %d 字节: %s, 版本/长度错误拒绝: %s\n", length, encodeOk ? "✓" : "✗",
+           (badVersion && truncated) ? "✓" : "✗");
+    printf("  清零: %s\n", resetOk ? "✓" : "✗");
+    printf("  记录开销: %.1f ns/次 (含两次读时钟)\n", elapsedUs * 1000.0f / rounds);
     
-    if (result.dyskinesiaDetected && peak.frequency > 5.0f && peak.frequency < 7.0f) {
+    bool passed = bucketsOk && statsOk && emptyOk && encodeOk && badVersion && truncated && resetOk;
+    if (passed) {
         printf("\n✅ 测试通过！\n");
         led1 = 1;
     } else {
@@ -84,86 +1863,435 @@ void test_dyskinesia_detection() {
     }
 }
 
-// 测试 3: 低频拒绝
-void test_low_frequency_rejection() {
+// 检测器日志输出: 写入测试用的令牌缓冲区
+static tokenlog::LogRing detectorLogRing;
+
+static void ringLogSink(void* context, uint16_t id, const uint32_t* args, int count) {
+    detectorLogRing.push((tokenlog::MessageId)id, args, count);
+}
+
+// 测试 21: 令牌化日志 (缓冲区满丢弃、格式还原、字节流重新同步、检测器日志、写入开销)
+void test_token_log() {
     printf("\n╔═══════════════════════════════════════╗\n");
-    printf("║  测试 3: 低频拒绝 (1Hz)              ║\n");
+    printf("║  测试 21: 令牌化日志                 ║\n");
     printf("╚═══════════════════════════════════════╝\n");
     
-    FFTProcessor fft;
-    Detector detector;
-    float testData[WINDOW_SIZE];
+    // 写满后丢弃并计数，取出顺序和参数 (浮点数按位) 不变
+    static tokenlog::LogRing ring;
+    for (int i = 0; i < LOG_RING_ENTRIES; i++) {
+        ring.write<tokenlog::OVERRUNS>(i, 2 * i, 3 * i);
+    }
+    ring.write<tokenlog::DETECTOR_PEAK>(4.0f, 0.5f);
+    bool ringOk = ring.getDropped() == 1;
+    tokenlog::MessageId id;
+    uint32_t args[tokenlog::MAX_ARGS];
+    int count;
+    for (int i = 0; i < LOG_RING_ENTRIES; i++) {
+        ringOk = ringOk && ring.pop(&id, args, &count) && id == tokenlog::OVERRUNS && count == 3
+            && args[0] == (uint32_t)i && args[2] == (uint32_t)(3 * i);
+    }
+    ringOk = ringOk && !ring.pop(&id, args, &count);
+    ring.write<tokenlog::DETECTOR_STOPPED>(1600UL, 4000UL, 0.125f);
+    ringOk = ringOk && ring.pop(&id, args, &count) && id == tokenlog::DETECTOR_STOPPED && count == 3
+        && args[1] == 4000 && tokenlog::wordToFloat(args[2]) == 0.125f;
     
-    // 生成 1Hz 信号
-    generateSineWave(testData, WINDOW_SIZE, 1.0f, 2.0f);
+    // 按消息表还原文本
+    char text[128];
+    uint32_t peakArgs[3] = {tokenlog::toWord(4.0f), tokenlog::toWord(0.5f), tokenlog::toWord('Y')};
+    bool formatOk = logdecode::formatRecord(text, sizeof(text), tokenlog::DETECTOR_AXIS_PEAK, peakArgs, 3) > 0
+        && strcmp(text, "Peak: 4.00 Hz, Magnitude: 0.500 (axis Y)") == 0;
+    uint32_t summaryArgs[6] = {1, tokenlog::toWord(0.25f), 0, tokenlog::toWord(0.0f), 0, 2};
+    formatOk = formatOk
+        && logdecode::formatRecord(text, sizeof(text), tokenlog::DETECTION_SUMMARY, summaryArgs, 6) > 0
+        && strcmp(text, "Tremor 1 (0.25), dyskinesia 0 (0.00), FOG 0 (state 2)") == 0;
+    uint32_t sleepArgs[3] = {10, tokenlog::toWord(87.5f), 3};
+    formatOk = formatOk
+        && logdecode::formatRecord(text, sizeof(text), tokenlog::SLEEP_STATS, sleepArgs, 3) > 0
+        && strcmp(text, "Sleep: stop 10 entries (87.5%), sleep 3 entries") == 0;
+    bool rejectOk = logdecode::formatRecord(text, sizeof(text), tokenlog::DETECTOR_AXIS_PEAK, peakArgs, 2) < 0
+        && logdecode::formatRecord(text, sizeof(text), tokenlog::NUM_MESSAGES, peakArgs, 3) < 0;
     
-    // 检测器分析
-    DetectionResult result = detector.analyze(testData, 1.0f);
+    // 字节流: 文本 + 帧 + CRC 错误的帧 + 截断的帧 (吞掉下一帧的开头) + 帧，
+    // 解码器丢弃坏帧并从其中的下一个起始字节重新同步
+    uint8_t stream[256];
+    int length = 0;
+    const char* banner = "START\r\nSystem ready!\r\n";
+    memcpy(stream, banner, strlen(banner));
+    length += (int)strlen(banner);
+    length += tokenlog::encodeFrame(stream + length, tokenlog::DETECTOR_AXIS_PEAK, peakArgs, 3);
+    int corrupt = length;
+    length += tokenlog::encodeFrame(stream + length, tokenlog::DETECTOR_PEAK, peakArgs, 2);
+    stream[corrupt + 6] ^= 0x10;
+    length += tokenlog::encodeFrame(stream + length, tokenlog::DETECTOR_AXIS_PEAK, peakArgs, 3) - 4;
+    uint32_t overrunArgs[3] = {1, 2, 3};
+    length += tokenlog::encodeFrame(stream + length, tokenlog::OVERRUNS, overrunArgs, 3);
+    
+    FILE* out = tmpfile();
+    bool streamOk = out != nullptr;
+    if (streamOk) {
+        logdecode::StreamDecoder decoder(out);
+        // 分成不规则的小块送入 (串口读取的边界任意)
+        for (int pos = 0; pos < length; pos += 7) {
+            decoder.feed(stream + pos, length - pos < 7 ? length - pos : 7);
+        }
+        decoder.finish();
+        // 文本去掉 '\r'; 坏帧中的字节不输出
+        const char* expected = "START\nSystem ready!\nPeak: 4.00 Hz, Magnitude: 0.500 (axis Y)\n"
+                               "Overruns: window 1, FIFO 2, BLE 3\n";
+        static char decoded[512];
+        rewind(out);
+        size_t n = fread(decoded, 1, sizeof(decoded) - 1, out);
+        decoded[n] = '\0';
+        fclose(out);
+        streamOk = decoder.getFrames() == 2 && decoder.getBadFrames() == 2 && strcmp(decoded, expected) == 0;
+        printf("  解码输出:\n%s", decoded);
+    }
+    
+    // 检测器日志: 4Hz 信号产生峰值和震颤消息 (调试级消息受 LOG_LEVEL 和 DETECTOR_VERBOSE 控制)
+    static Detector detector;
+    float testData[WINDOW_SIZE];
+    generateSineWave(testData, WINDOW_SIZE, 4.0f, 2.0f);
+    detector.setLogSink(ringLogSink, nullptr);
+    sample_t samples[WINDOW_SIZE];
+    toSamples(testData, samples, WINDOW_SIZE);
+    detector.analyze(samples, activityOf(testData, WINDOW_SIZE));
+    bool sawPeak = false;
+    bool sawTremor = false;
+    while (detectorLogRing.pop(&id, args, &count)) {
+        if (id == tokenlog::DETECTOR_PEAK && count == 2) {
+            float frequency = tokenlog::wordToFloat(args[0]);
+            sawPeak = frequency > 3.0f && frequency < 5.0f;
+        }
+        sawTremor = sawTremor || id == tokenlog::DETECTOR_TREMOR;
+    }
+    bool detectorOk = !DETECTOR_VERBOSE
+        || (sawPeak == tokenlog::isEnabled(tokenlog::DETECTOR_PEAK)
+            && sawTremor == tokenlog::isEnabled(tokenlog::DETECTOR_TREMOR));
+    
+    // 写入开销: 两个浮点参数的调试消息 (写入后立即取出，缓冲区不满)
+    const int rounds = 100000;
+    Timer timer;
+    timer.start();
+    for (int i = 0; i < rounds; i++) {
+        ring.write<tokenlog::DETECTOR_PEAK>((float)i, 0.5f);
+        ring.pop(&id, args, &count);
+    }
+    int64_t elapsedUs = timer.elapsed_time().count();
     
     printf("\n结果:\n");
-    printf("  震颤检测: %s\n", result.tremorDetected ? "✓ 是" : "✗ 否");
-    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
+    printf("  环形缓冲区 (满时丢弃): %s\n", ringOk ? "✓" : "✗");
+    printf("  格式还原: %s, 非法记录拒绝: %s\n", formatOk ? "✓" : "✗", rejectOk ? "✓" : "✗");
+    printf("  字节流解码与重新同步: %s\n", streamOk ? "✓" : "✗");
+    printf("  检测器日志 (峰值 %s, 震颤 %s): %s\n", sawPeak ? "有" : "无", sawTremor ? "有" : "无",
+           detectorOk ? "✓" : "✗");
+    printf("  写入+取出开销: %.1f ns/条\n", elapsedUs * 1000.0f / rounds);
     
-    if (!result.tremorDetected && !result.dyskinesiaDetected) {
-        printf("\n✅ 测试通过！正确拒绝低频信号\n");
+    bool passed = ringOk && formatOk && rejectOk && streamOk && detectorOk;
+    if (passed) {
+        printf("\n✅ 测试通过！\n");
         led1 = 1;
     } else {
-        printf("\n❌ 测试失败！误报\n");
+        printf("\n❌ 测试失败！\n");
         led1 = 0;
     }
 }
 
-// 测试 4: 高频拒绝
-void test_high_frequency_rejection() {
+// 测试 22: 有线采集链路 (COBS 边界情况、坏包重新同步、样本流写入会话文件、链路余量)
+void test_uart_capture() {
     printf("\n╔═══════════════════════════════════════╗\n");
-    printf("║  测试 4: 高频拒绝 (10Hz)             ║\n");
+    printf("║  测试 22: 有线采集链路               ║\n");
     printf("╚═══════════════════════════════════════╝\n");
     
-    FFTProcessor fft;
-    Detector detector;
-    float testData[WINDOW_SIZE];
+    // COBS 往返: 空、全 0、254/255 个非零字节 (段长度边界)、随机数据; 编码结果不含 0
+    static uint8_t data[300];
+    static uint8_t encoded[310];
+    static uint8_t decoded[310];
+    const int lengths[6] = {0, 1, 254, 255, 300, 100};
+    bool cobsOk = true;
+    unsigned int seed = 77;
+    for (int c = 0; c < 6; c++) {
+        int len = lengths[c];
+        for (int i = 0; i < len; i++) {
+            seed = seed * 1103515245u + 12345u;
+            data[i] = c == 1 ? 0 : c == 5 ? (uint8_t)((seed >> 16) % 3) : (uint8_t)(1 + (seed >> 16) % 255);
+        }
+        int n = capture::cobsEncode(data, len, encoded);
+        cobsOk = cobsOk && n <= len + len / 254 + 1 && memchr(encoded, 0, n) == nullptr
+            && capture::cobsDecode(encoded, n, decoded) == len && memcmp(decoded, data, len) == 0;
+    }
     
-    // 生成 10Hz 信号
-    generateSineWave(testData, WINDOW_SIZE, 10.0f, 2.0f);
+    // 会话信息往返
+    sessionfile::SessionInfo info;
+    memset(&info, 0, sizeof(info));
+    info.sensorId = lsm6dsl::WHO_AM_I_VALUE;
+    info.odrHz = SAMPLE_RATE;
+    info.fullScaleG = 2;
+    info.startMs = 1234;
+    uint8_t sessionPayload[capture::SESSION_PAYLOAD_SIZE];
+    sessionfile::SessionInfo decodedInfo;
+    bool sessionOk = capture::decodeSession(sessionPayload, capture::encodeSession(info, sessionPayload), &decodedInfo)
+        && decodedInfo.odrHz == SAMPLE_RATE && decodedInfo.startMs == 1234 && decodedInfo.sensorId == info.sensorId;
     
-    // 检测器分析
-    DetectionResult result = detector.analyze(testData, 1.0f);
+    // 发送端: 1 分钟 52Hz 样本，按 FIFO 批次组包 (同 CaptureLink)，中间插入检测记录、控制台输出和一个损坏的包，
+    // 另有一个样本包模拟发送缓冲区满被丢弃
+    const int samples = 52 * 60;
+    static int16_t trace[52 * 60 * 3];
+    for (int i = 0; i < samples * 3; i++) {
+        seed = seed * 1103515245u + 12345u;
+        trace[i] = (int16_t)(((i % 3) == 2 ? GRAVITY_LSB : 0) + (int)((seed >> 16) % 2001) - 1000);
+    }
+    static uint8_t stream[64 * 1024];
+    int length = 0;
+    // 接收端在一个包的中途接入: 残缺的包到 0x00 为止算一个坏包
+    const uint8_t partial[6] = {0x05, 0x12, 0x34, 0x01, 0x7F, 0x00};
+    memcpy(stream, partial, sizeof(partial));
+    length += (int)sizeof(partial);
+    length += capture::encodePacket(capture::PACKET_SESSION, sessionPayload, capture::SESSION_PAYLOAD_SIZE,
+                                    stream + length);
+    RawStreamEncoder encoder;
+    static uint8_t payload[capture::MAX_PAYLOAD];
+    int samplePackets = 0;
+    int droppedPacket = 5;
+    uint32_t droppedFirst = 0;
+    int droppedCount = 0;
+    for (int start = 0; start < samples; ) {
+        encoder.begin(payload, capture::MAX_PAYLOAD, (uint32_t)start);
+        int n = 0;
+        while (start + n < samples && n < FIFO_WATERMARK && !encoder.isFull()) {
+            const int16_t* xyz = &trace[3 * (start + n)];
+            encoder.add(xyz[0], xyz[1], xyz[2]);
+            n++;
+        }
+        int len = encoder.finish();
+        if (samplePackets == droppedPacket) {
+            droppedFirst = (uint32_t)start;
+            droppedCount = n;
+        } else {
+            length += capture::encodePacket(capture::PACKET_SAMPLES, payload, len, stream + length);
+        }
+        if (samplePackets == 10) {
+            // 损坏的包: 接收端丢弃，下一个 0x00 处重新同步
+            int at = length;
+            length += capture::encodePacket(capture::PACKET_SAMPLES, payload, len, stream + length);
+            stream[at + 7] ^= 0x40;
+            if (stream[at + 7] == 0) {
+                stream[at + 7] = 0x41;
+            }
+        }
+        if (samplePackets % 4 == 3) {
+            DetectionRecord record;
+            memset(&record, 0, sizeof(record));
+            record.sequence = (uint16_t)(samplePackets / 4);
+            record.tremorDetected = true;
+            record.tremorIntensity = 0.5f;
+            record.dominantAxis = -1;
+            uint8_t recordBytes[frame::RECORD_SIZE];
+            frame::encodeRecord(record, recordBytes);
+            length += capture::encodePacket(capture::PACKET_DETECTION, recordBytes, frame::RECORD_SIZE, stream + length);
+        }
+        start += n;
+        samplePackets++;
+    }
+    uint8_t logFrame[tokenlog::MAX_FRAME_SIZE];
+    uint32_t overrunArgs[3] = {0, 1, 2};
+    int logLength = tokenlog::encodeFrame(logFrame, tokenlog::OVERRUNS, overrunArgs, 3);
+    length += capture::encodePacket(capture::PACKET_CONSOLE, logFrame, logLength, stream + length);
+    
+    // 接收端: 解包、样本写入会话文件、控制台字节经日志解码器
+    FILE* file = tmpfile();
+    FILE* consoleOut = tmpfile();
+    if (file == nullptr || consoleOut == nullptr) {
+        printf("\n❌ 测试失败！(无法创建临时文件)\n");
+        led1 = 0;
+        return;
+    }
+    capture::PacketReceiver receiver;
+    logdecode::StreamDecoder console(consoleOut);
+    static sessionfile::FileWriter writer;
+    bool writerOk = false;
+    int detections = 0;
+    int sessionPackets = 0;
+    uint32_t received = 0;
+    static int16_t xyz[rawstream::MAX_SAMPLES_PER_PACKET * 3];
+    for (int i = 0; i < length; i++) {
+        if (!receiver.feed(stream[i])) {
+            continue;
+        }
+        if (receiver.getType() == capture::PACKET_SESSION) {
+            sessionPackets++;
+            writerOk = capture::decodeSession(receiver.getPayload(), receiver.getPayloadLength(), &decodedInfo)
+                && writer.open(file, decodedInfo);
+        } else if (receiver.getType() == capture::PACKET_SAMPLES) {
+            uint32_t first;
+            int count = rawstream::decodePacket(receiver.getPayload(), receiver.getPayloadLength(), xyz,
+                                                rawstream::MAX_SAMPLES_PER_PACKET, &first);
+            for (int k = 0; k < count; k++) {
+                writerOk = writer.append(xyz[3 * k], xyz[3 * k + 1], xyz[3 * k + 2], first + k) && writerOk;
+            }
+            received += count > 0 ? count : 0;
+        } else if (receiver.getType() == capture::PACKET_DETECTION) {
+            detections++;
+        } else if (receiver.getType() == capture::PACKET_CONSOLE) {
+            console.feed(receiver.getPayload(), receiver.getPayloadLength());
+        }
+    }
+    console.finish();
+    writerOk = writer.close() && writerOk;
+    
+    // 会话文件读回: 缺口只在丢弃的包处
+    long fileLength = ftell(file);
+    uint8_t* image = new uint8_t[fileLength];
+    rewind(file);
+    bool fileOk = writerOk && fread(image, 1, fileLength, file) == (size_t)fileLength;
+    fclose(file);
+    sessionfile::FileView view;
+    fileOk = fileOk && view.open(image, (uint32_t)fileLength) && view.verify() == 0
+        && view.getSampleCount() == (uint32_t)(samples - droppedCount)
+        && view.getInfo().startMs == 1234;
+    static int16_t readBack[52 * 60 * 3];
+    fileOk = fileOk && view.readSamples(0, samples, readBack) == (int)droppedFirst
+        && memcmp(readBack, trace, droppedFirst * 3 * sizeof(int16_t)) == 0
+        && view.findBlock(droppedFirst) < 0
+        && view.readSamples(droppedFirst + droppedCount, samples, readBack)
+            == samples - (int)droppedFirst - droppedCount
+        && memcmp(readBack, &trace[3 * (droppedFirst + droppedCount)],
+                  (samples - droppedFirst - droppedCount) * 3 * sizeof(int16_t)) == 0;
+    delete[] image;
+    
+    char consoleText[128];
+    rewind(consoleOut);
+    size_t consoleLength = fread(consoleText, 1, sizeof(consoleText) - 1, consoleOut);
+    consoleText[consoleLength] = '\0';
+    fclose(consoleOut);
+    bool consoleOk = strcmp(consoleText, "Overruns: window 0, FIFO 1, BLE 2\n") == 0;
+    
+    // 开头残缺的包和损坏的包各算一个坏包
+    bool streamOk = receiver.getBadPackets() == 2 && sessionPackets == 1 && detections == samplePackets / 4
+        && received == (uint32_t)(samples - droppedCount);
+    
+    // 链路余量: 每样本字节数 (含 COBS/CRC/包头) 与 921600 波特 (每字节 10 位) 的容量比较
+    double bytesPerSample = (double)length / samples;
+    double linkSamplesPerSecond = 92160.0 / bytesPerSample;
     
     printf("\n结果:\n");
-    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
+    printf("  COBS 边界情况: %s, 会话信息: %s\n", cobsOk ? "✓" : "✗", sessionOk ? "✓" : "✗");
+    printf("  %d 字节, %lu 个包, %lu 个坏包 (残缺和损坏的包): %s\n", length,
+           (unsigned long)receiver.getPackets(), (unsigned long)receiver.getBadPackets(), streamOk ? "✓" : "✗");
+    printf("  会话文件 %lu 个样本 (丢弃的包 %d 个样本为缺口): %s\n", (unsigned long)received, droppedCount,
+           fileOk ? "✓" : "✗");
+    printf("  控制台日志: %s\n", consoleOk ? "✓" : "✗");
+    printf("  %.2f 字节/样本, %d 波特可承载约 %.0f 样本/秒 (%dHz 的 %.0f 倍)\n", bytesPerSample,
+           UART_CAPTURE_BAUD, linkSamplesPerSecond, SAMPLE_RATE, linkSamplesPerSecond / SAMPLE_RATE);
     
-    if (!result.dyskinesiaDetected) {
-        printf("\n✅ 测试通过！正确拒绝高频信号\n");
+    bool passed = cobsOk && sessionOk && streamOk && fileOk && consoleOk;
+    if (passed) {
+        printf("\n✅ 测试通过！\n");
         led1 = 1;
     } else {
-        printf("\n❌ 测试失败！误报\n");
+        printf("\n❌ 测试失败！\n");
         led1 = 0;
     }
 }
 
-// 测试 5: 静止状态
-void test_idle_state() {
+// 测试 23 的信号: 4Hz 震颤 (0.08 m/s²) 叠加宽带噪声，按样本序号确定，不需要整段缓冲区
+static float welchSignal(uint32_t n) {
+    uint32_t hash = (n + 1) * 2654435761u;
+    hash ^= hash >> 15;
+    hash *= 2246822519u;
+    hash ^= hash >> 13;
+    float noise = (float)(hash & 0xFFFF) / 32768.0f - 1.0f;
+    return 0.08f * sinf(2.0f * M_PI * 4.0f * n / SAMPLE_RATE) + 0.3f * noise;
+}
+
+// 测试 23: Welch 平均功率谱 (累加和与直接平均一致、估计方差降低、每步长代价固定)
+void test_welch_psd() {
     printf("\n╔═══════════════════════════════════════╗\n");
-    printf("║  测试 5: 静止状态                    ║\n");
+    printf("║  测试 23: Welch 平均功率谱           ║\n");
     printf("╚═══════════════════════════════════════╝\n");
     
-    Detector detector;
-    float testData[WINDOW_SIZE];
+    static FFTProcessor fft;
+    static WelchPsd welch;
+    static float history[WelchPsd::SEGMENTS][WelchPsd::NUM_BINS];
+    static float window[WINDOW_SIZE];
+    const int hops = 600;
     
-    // 全零数据
-    for (int i = 0; i < WINDOW_SIZE; i++) {
-        testData[i] = 0.0f;
+    // 每个步长一个窗口 (同检测器): 震颤频带峰值取自 Welch 平均谱;
+    // 估计方差比较纯噪声频点 (8Hz) 的功率，单窗口周期图的变异系数约为 1
+    const int noiseBin = (int)(8.0f * WINDOW_SIZE / SAMPLE_RATE);
+    float maxError = 0.0f;
+    double singleSum = 0, singleSquares = 0;
+    double welchSum = 0, welchSquares = 0;
+    int counted = 0;
+    int peakAt4Hz = 0;
+    int64_t welchUs = 0;
+    Timer timer;
+    timer.start();
+    for (int h = 0; h < hops; h++) {
+        uint32_t first = (uint32_t)h * HOP_SIZE;
+        for (int i = 0; i < WINDOW_SIZE; i++) {
+            window[i] = welchSignal(first + i);
+        }
+        fft.process(window);
+        float singlePower = fft.getMagnitude(noiseBin) * fft.getMagnitude(noiseBin);
+        
+        int64_t segmentStart = timer.elapsed_time().count();
+        welch.beginSegment();
+        for (int k = 0; k < WelchPsd::NUM_BINS; k++) {
+            float magnitude = fft.getMagnitude(k);
+            welch.setPower(0, k, magnitude * magnitude);
+        }
+        welch.endSegment();
+        FrequencyPeak averaged = welch.findPeakInRange(0, TREMOR_FREQ_MIN, TREMOR_FREQ_MAX);
+        welchUs += timer.elapsed_time().count() - segmentStart;
+        
+        // 直接对最近 SEGMENTS 段求平均，与累加和比较 (检查加减的舍入误差不会累积)
+        for (int k = 0; k < WelchPsd::NUM_BINS; k++) {
+            float magnitude = fft.getMagnitude(k);
+            history[h % WelchPsd::SEGMENTS][k] = magnitude * magnitude;
+        }
+        int segments = h + 1 < WelchPsd::SEGMENTS ? h + 1 : WelchPsd::SEGMENTS;
+        for (int k = 0; k < WelchPsd::NUM_BINS; k++) {
+            float total = 0;
+            for (int s = 0; s < segments; s++) {
+                total += history[s][k];
+            }
+            float error = fabsf(welch.getMagnitude(0, k) - sqrtf(total / segments));
+            if (error > maxError) {
+                maxError = error;
+            }
+        }
+        
+        if (h >= WelchPsd::SEGMENTS) {
+            float welchPower = welch.getMagnitude(0, noiseBin) * welch.getMagnitude(0, noiseBin);
+            singleSum += singlePower;
+            singleSquares += (double)singlePower * singlePower;
+            welchSum += welchPower;
+            welchSquares += (double)welchPower * welchPower;
+            counted++;
+            if (fabsf(averaged.frequency - 4.0f) < (float)SAMPLE_RATE / WINDOW_SIZE) {
+                peakAt4Hz++;
+            }
+        }
     }
     
-    // 检测器分析
-    DetectionResult result = detector.analyze(testData, 0.0f);
+    // 噪声功率的变异系数 (标准差 / 均值)
+    double singleMean = singleSum / counted;
+    double welchMean = welchSum / counted;
+    double singleCv = sqrt(singleSquares / counted - singleMean * singleMean) / singleMean;
+    double welchCv = sqrt(welchSquares / counted - welchMean * welchMean) / welchMean;
     
     printf("\n结果:\n");
-    printf("  震颤检测: %s\n", result.tremorDetected ? "✓ 是" : "✗ 否");
-    printf("  运动障碍检测: %s\n", result.dyskinesiaDetected ? "✓ 是" : "✗ 否");
-    printf("  运动状态: %d (0=IDLE)\n", result.motionState);
+    printf("  平均 %d 段 (跨度 %d 样本)，%d 个步长\n", WelchPsd::SEGMENTS,
+           WINDOW_SIZE + (WelchPsd::SEGMENTS - 1) * HOP_SIZE, hops);
+    printf("  累加和与直接平均的最大误差: %.6f\n", maxError);
+    printf("  8Hz 噪声功率变异系数: 单窗口 %.3f, Welch %.3f (均值 %.5f / %.5f)\n",
+           singleCv, welchCv, singleMean, welchMean);
+    printf("  Welch 峰值在 4Hz 频点: %d/%d\n", peakAt4Hz, counted);
+    printf("  每步长加入一段并找峰值: %.2f us\n", (double)welchUs / hops);
     
-    if (!result.tremorDetected && !result.dyskinesiaDetected && result.motionState == MOTION_IDLE) {
+    bool passed = maxError < 1e-4f && (WelchPsd::SEGMENTS == 1 || welchCv < 0.75 * singleCv)
+        && peakAt4Hz > counted * 9 / 10;
+    if (passed) {
         printf("\n✅ 测试通过！\n");
         led1 = 1;
     } else {
@@ -181,7 +2309,7 @@ void run_all_tests() {
     printf("\n开始测试...\n");
     
     int passed = 0;
-    int total = 5;
+    int total = 23;
     
     // 测试 1
     test_tremor_detection();
@@ -203,6 +2331,78 @@ void run_all_tests() {
     test_idle_state();
     thread_sleep_for(1000);
     
+    // 测试 6
+    test_real_fft_equivalence();
+    thread_sleep_for(1000);
+    
+    // 测试 7
+    test_band_tracker();
+    thread_sleep_for(1000);
+    
+    // 测试 8
+    test_fixed_point_fft();
+    thread_sleep_for(1000);
+    
+    // 测试 9
+    test_fifo_driver();
+    thread_sleep_for(1000);
+    
+    // 测试 10
+    test_async_fifo_read();
+    thread_sleep_for(1000);
+    
+    // 测试 11
+    test_activity_stats();
+    thread_sleep_for(1000);
+    
+    // 测试 12
+    test_window_queue();
+    thread_sleep_for(1000);
+    
+    // 测试 13
+    test_detection_frame();
+    thread_sleep_for(1000);
+    
+    // 测试 14
+    test_raw_stream();
+    thread_sleep_for(1000);
+    
+    // 测试 15
+    test_publish_policy();
+    thread_sleep_for(1000);
+    
+    // 测试 16
+    test_event_log();
+    thread_sleep_for(1000);
+    
+    // 测试 17
+    test_raw_recorder();
+    thread_sleep_for(1000);
+    
+    // 测试 18
+    test_replay_engine();
+    thread_sleep_for(1000);
+    
+    // 测试 19
+    test_session_file();
+    thread_sleep_for(1000);
+    
+    // 测试 20
+    test_stage_timing();
+    thread_sleep_for(1000);
+    
+    // 测试 21
+    test_token_log();
+    thread_sleep_for(1000);
+    
+    // 测试 22
+    test_uart_capture();
+    thread_sleep_for(1000);
+    
+    // 测试 23
+    test_welch_psd();
+    thread_sleep_for(1000);
+    
     printf("\n");
     printf("╔════════════════════════════════════════════╗\n");
     printf("║            测试完成                        ║\n");
@@ -224,6 +2424,24 @@ void show_menu() {
     printf("  3 - 测试低频拒绝 (1Hz)\n");
     printf("  4 - 测试高频拒绝 (10Hz)\n");
     printf("  5 - 测试静止状态\n");
+    printf("  6 - 测试实数 FFT 等价性\n");
+    printf("  7 - 测试滑动 DFT 频带跟踪\n");
+    printf("  8 - 测试 Q15 定点 FFT\n");
+    printf("  9 - 测试 FIFO 水位批量读取 (仿真)\n");
+    printf("  0 - 测试异步 FIFO 读取 (模拟延迟)\n");
+    printf("  s - 测试流式活动统计\n");
+    printf("  w - 测试窗口队列 (SPSC)\n");
+    printf("  f - 测试 BLE 检测帧往返\n");
+    printf("  r - 测试原始数据流压缩\n");
+    printf("  p - 测试 BLE 发布策略\n");
+    printf("  l - 测试 flash 事件日志\n");
+    printf("  q - 测试 QSPI 原始数据记录器\n");
+    printf("  y - 测试离线回放引擎\n");
+    printf("  m - 测试会话文件格式\n");
+    printf("  t - 测试阶段计时计数器\n");
+    printf("  g - 测试令牌化日志\n");
+    printf("  u - 测试有线采集链路\n");
+    printf("  e - 测试 Welch 平均功率谱\n");
     printf("  a - 运行所有测试\n");
     printf("  h - 显示此菜单\n");
     printf("\n输入命令: ");
@@ -250,8 +2468,12 @@ int main() {
     show_menu();
     
     while (1) {
-        char cmd = getchar();
+        int cmd = getchar();
         
+        // 输入结束 (主机上从管道读取命令，例如 echo a | program)
+        if (cmd == EOF) {
+            break;
+        }
         if (cmd == '\n' || cmd == '\r') {
             continue;
         }
@@ -284,6 +2506,109 @@ int main() {
                 show_menu();
                 break;
                 
+            case '6':
+                test_real_fft_equivalence();
+                show_menu();
+                break;
+                
+            case '7':
+                test_band_tracker();
+                show_menu();
+                break;
+                
+            case '8':
+                test_fixed_point_fft();
+                show_menu();
+                break;
+                
+            case '9':
+                test_fifo_driver();
+                show_menu();
+                break;
+                
+            case '0':
+                test_async_fifo_read();
+                show_menu();
+                break;
+                
+            case 's':
+            case 'S':
+                test_activity_stats();
+                show_menu();
+                break;
+                
+            case 'w':
+            case 'W':
+                test_window_queue();
+                show_menu();
+                break;
+                
+            case 'f':
+            case 'F':
+                test_detection_frame();
+                show_menu();
+                break;
+                
+            case 'r':
+            case 'R':
+                test_raw_stream();
+                show_menu();
+                break;
+                
+            case 'p':
+            case 'P':
+                test_publish_policy();
+                show_menu();
+                break;
+                
+            case 'l':
+            case 'L':
+                test_event_log();
+                show_menu();
+                break;
+                
+            case 'q':
+            case 'Q':
+                test_raw_recorder();
+                show_menu();
+                break;
+                
+            case 'y':
+            case 'Y':
+                test_replay_engine();
+                show_menu();
+                break;
+                
+            case 'm':
+            case 'M':
+                test_session_file();
+                show_menu();
+                break;
+                
+            case 't':
+            case 'T':
+                test_stage_timing();
+                show_menu();
+                break;
+                
+            case 'g':
+            case 'G':
+                test_token_log();
+                show_menu();
+                break;
+                
+            case 'u':
+            case 'U':
+                test_uart_capture();
+                show_menu();
+                break;
+                
+            case 'e':
+            case 'E':
+                test_welch_psd();
+                show_menu();
+                break;
+                
             case 'a':
             case 'A':
                 run_all_tests();
@@ -302,4 +2627,5 @@ int main() {
                 break;
         }
     }
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() {
+    data = nullptr;
+    size = 0;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0 || (uint64_t)info.st_size > 0xFFFFFFFFu) {
+        ::close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后文件描述符不再需要
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    data = (const uint8_t*)mapping;
+    size = (uint32_t)info.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        munmap((void*)data, size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+const uint8_t* MappedFile::getData() {
+    return data;
+}
+
+uint32_t MappedFile::getSize() {
+    return size;
+}
@@ -0,0 +1,87 @@
+#include "mock_bus.h"
+#include <cstring>
+
+MockAsyncBus::MockAsyncBus(SensorBus& targetBus, uint32_t latency) : target(targetBus) {
+    latencyUs = latency;
+    nowUs = 0;
+    busy = false;
+    completeAtUs = 0;
+    destination = nullptr;
+    pendingLen = 0;
+    pendingSuccess = false;
+    pendingDone = nullptr;
+    pendingContext = nullptr;
+    completedTransfers = 0;
+    busyUs = 0;
+}
+
+void MockAsyncBus::setLatency(uint32_t latency) {
+    latencyUs = latency;
+}
+
+void MockAsyncBus::advance(uint32_t us) {
+    for (uint32_t t = 0; t < us; t++) {
+        nowUs++;
+        if (!busy) {
+            continue;
+        }
+        busyUs++;
+        if (nowUs >= completeAtUs) {
+            // 交付数据并回调
+            memcpy(destination, pending, pendingLen);
+            busy = false;
+            completedTransfers++;
+            pendingDone(pendingContext, pendingSuccess);
+        }
+    }
+}
+
+bool MockAsyncBus::isBusy() {
+    return busy;
+}
+
+uint32_t MockAsyncBus::getCompletedTransfers() {
+    return completedTransfers;
+}
+
+uint32_t MockAsyncBus::getBusyTime() {
+    return busyUs;
+}
+
+bool MockAsyncBus::writeReg(uint8_t reg, uint8_t value) {
+    if (busy) {
+        return false;
+    }
+    return target.writeReg(reg, value);
+}
+
+bool MockAsyncBus::readRegs(uint8_t reg, uint8_t* data, int len) {
+    if (busy) {
+        return false;
+    }
+    return target.readRegs(reg, data, len);
+}
+
+bool MockAsyncBus::readRegsAsync(uint8_t reg, uint8_t* data, int len, BusCompletion done, void* context) {
+    if (busy || len > MAX_TRANSFER) {
+        return false;
+    }
+
+    // 总线事务在发起时执行 (寄存器状态按此刻采样)，数据延迟交付
+    pendingSuccess = target.readRegs(reg, pending, len);
+    destination = data;
+    pendingLen = len;
+    pendingDone = done;
+    pendingContext = context;
+    memset(destination, 0xA5, len);
+
+    busy = true;
+    completeAtUs = nowUs + latencyUs;
+    if (latencyUs == 0) {
+        memcpy(destination, pending, pendingLen);
+        busy = false;
+        completedTransfers++;
+        done(context, pendingSuccess);
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#include "mbed.h"
+#include "power_stats.h"
+#include "hal/lp_ticker_api.h"
+
+// 通过链接器 --wrap 截获 sleep manager 对 hal_sleep/hal_deepsleep 的调用 (见 platformio.ini)，
+// 统计进入次数和驻留时间。两者都在 sleep_manager_sleep_auto 的临界区内被调用，唤醒中断在返回后才执行
+static uint32_t sleepEntries = 0;
+static uint32_t deepSleepEntries = 0;
+static uint64_t sleepTimeUs = 0;
+static uint64_t deepSleepTimeUs = 0;
+
+extern "C" {
+
+void __real_hal_sleep(void);
+void __real_hal_deepsleep(void);
+
+void __wrap_hal_sleep(void) {
+    us_timestamp_t start = ticker_read_us(get_lp_ticker_data());
+    __real_hal_sleep();
+    sleepTimeUs += ticker_read_us(get_lp_ticker_data()) - start;
+    sleepEntries++;
+}
+
+void __wrap_hal_deepsleep(void) {
+    us_timestamp_t start = ticker_read_us(get_lp_ticker_data());
+    __real_hal_deepsleep();
+    deepSleepTimeUs += ticker_read_us(get_lp_ticker_data()) - start;
+    deepSleepEntries++;
+}
+
+}
+
+namespace power {
+
+void getSleepStats(SleepStats* stats) {
+    core_util_critical_section_enter();
+    stats->sleepEntries = sleepEntries;
+    stats->deepSleepEntries = deepSleepEntries;
+    stats->sleepTimeUs = sleepTimeUs;
+    stats->deepSleepTimeUs = deepSleepTimeUs;
+    stats->uptimeUs = ticker_read_us(get_lp_ticker_data());
+    core_util_critical_section_exit();
+}
+
+float deepSleepPercent(const SleepStats& stats) {
+    if (stats.uptimeUs == 0) {
+        return 0.0f;
+    }
+    return 100.0f * (float)stats.deepSleepTimeUs / (float)stats.uptimeUs;
+}
+
+}  // namespace power
@@ -0,0 +1,84 @@
+#include "publish_policy.h"
+#include <math.h>
+
+PublishPolicy::PublishPolicy() {
+    configure(BLE_PUBLISH_INTENSITY_DELTA, BLE_PUBLISH_HEARTBEAT_MS, BLE_MIN_NOTIFY_INTERVAL_MS);
+    hasNotified = false;
+    lastNotifyMs = 0;
+    published = 0;
+    suppressed = 0;
+    deferred = 0;
+    reset();
+}
+
+void PublishPolicy::configure(float delta, uint32_t heartbeat, uint32_t minInterval) {
+    intensityDelta = delta;
+    heartbeatMs = heartbeat;
+    minIntervalMs = minInterval;
+}
+
+void PublishPolicy::reset() {
+    hasPublished = false;
+}
+
+bool PublishPolicy::flagsChanged(const DetectionRecord& record) {
+    return record.tremorDetected != lastPublished.tremorDetected
+        || record.dyskinesiaDetected != lastPublished.dyskinesiaDetected
+        || record.fogDetected != lastPublished.fogDetected
+        || record.motionState != lastPublished.motionState;
+}
+
+bool PublishPolicy::intensityChanged(const DetectionRecord& record) {
+    return fabsf(record.tremorIntensity - lastPublished.tremorIntensity) >= intensityDelta
+        || fabsf(record.dyskinesiaIntensity - lastPublished.dyskinesiaIntensity) >= intensityDelta;
+}
+
+bool PublishPolicy::offer(const DetectionRecord& record) {
+    bool publish = !hasPublished
+        || flagsChanged(record)
+        || intensityChanged(record)
+        || record.timestampMs - lastPublished.timestampMs >= heartbeatMs;
+
+    if (!publish) {
+        suppressed++;
+        return false;
+    }
+
+    // 死区以上次发布的值为基准，缓慢漂移累计超过 delta 时也会发布
+    lastPublished = record;
+    hasPublished = true;
+    published++;
+    return true;
+}
+
+uint32_t PublishPolicy::notifyDelay(uint32_t nowMs) {
+    if (!hasNotified) {
+        return 0;
+    }
+    uint32_t elapsed = nowMs - lastNotifyMs;    // 无符号减法，时钟回卷也正确
+    if (elapsed >= minIntervalMs) {
+        return 0;
+    }
+    return minIntervalMs - elapsed;
+}
+
+void PublishPolicy::countDeferral() {
+    deferred++;
+}
+
+void PublishPolicy::notified(uint32_t nowMs) {
+    hasNotified = true;
+    lastNotifyMs = nowMs;
+}
+
+uint32_t PublishPolicy::getPublished() {
+    return published;
+}
+
+uint32_t PublishPolicy::getSuppressed() {
+    return suppressed;
+}
+
+uint32_t PublishPolicy::getDeferred() {
+    return deferred;
+}
@@ -0,0 +1,253 @@
+#include "raw_recorder.h"
+#include <cstring>
+
+using namespace sessionfile;
+
+RawRecorder::RawRecorder(FlashDevice& device) : flash(device) {
+    blockCount = 0;
+    blocksPerSector = 1;
+    nextBlock = 0;
+    fillIndex = 0;
+    fillCount = 0;
+    fillFirstSample = 0;
+    sealed = false;
+    pendingIndex = 0;
+    pending.store(false);
+    recording.store(false);
+    full.store(false);
+    memset(&session, 0, sizeof(session));
+    clock = nullptr;
+    readyCallback = nullptr;
+    readyContext = nullptr;
+    samplesRecorded = 0;
+    samplesDropped = 0;
+    blocksWritten = 0;
+    writeErrors = 0;
+}
+
+bool RawRecorder::isBlockErased(uint32_t block) {
+    uint8_t header[DATA_HEADER_SIZE];
+    if (!flash.read(block * RECORDER_BLOCK_SIZE, header, DATA_HEADER_SIZE)) {
+        return false;
+    }
+    for (int i = 0; i < DATA_HEADER_SIZE; i++) {
+        if (header[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RawRecorder::mount() {
+    uint32_t eraseSize = flash.getEraseSize();
+    if (eraseSize == 0 || eraseSize % RECORDER_BLOCK_SIZE != 0
+        || RECORDER_BLOCK_SIZE % flash.getProgramSize() != 0) {
+        return false;
+    }
+    blocksPerSector = eraseSize / RECORDER_BLOCK_SIZE;
+    blockCount = flash.getSize() / RECORDER_BLOCK_SIZE;
+
+    // 块按顺序写入: 二分查找第一个空块 (写了一半的块不为空，视为已用)
+    uint32_t low = 0;
+    uint32_t high = blockCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (isBlockErased(mid)) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    nextBlock = low;
+    full.store(nextBlock >= blockCount);
+    return true;
+}
+
+bool RawRecorder::eraseAll() {
+    if (recording.load() || !flash.erase(0, blockCount * RECORDER_BLOCK_SIZE)) {
+        return false;
+    }
+    nextBlock = 0;
+    full.store(false);
+    return true;
+}
+
+bool RawRecorder::writeBlock(const uint8_t* data) {
+    if (nextBlock >= blockCount) {
+        full.store(true);
+        recording.store(false);
+        return false;
+    }
+
+    // 进入新扇区时先擦除 (同一扇区内后面的块在顺序写入下必然为空)
+    uint32_t addr = nextBlock * RECORDER_BLOCK_SIZE;
+    if (nextBlock % blocksPerSector == 0 && !flash.erase(addr, blocksPerSector * RECORDER_BLOCK_SIZE)) {
+        writeErrors++;
+        return false;
+    }
+    nextBlock++;
+    if (!flash.program(addr, data, RECORDER_BLOCK_SIZE)) {
+        writeErrors++;
+        return false;
+    }
+    blocksWritten++;
+    return true;
+}
+
+bool RawRecorder::startSession(uint8_t sensorId, uint32_t startSample, uint32_t startMs, uint32_t startEpoch) {
+    if (recording.load() || pending.load() || full.load() || blockCount == 0) {
+        return false;
+    }
+
+    session.sessionId = nextBlock;
+    session.sensorId = sensorId;
+    session.odrHz = SAMPLE_RATE;
+    session.fullScaleG = 2;
+    session.startSample = startSample;
+    session.startMs = startMs;
+    session.startEpoch = startEpoch;
+
+    // 会话块直接写入 (采集尚未开始，两个缓冲区都空闲)
+    encodeSessionHeader(session, buffers[fillIndex]);
+    if (!writeBlock(buffers[fillIndex])) {
+        return false;
+    }
+    fillCount = 0;
+    sealed = false;
+    recording.store(true);
+    return true;
+}
+
+void RawRecorder::stop() {
+    if (!recording.exchange(false)) {
+        return;
+    }
+    // 未满的块也交给写线程; 写线程还在忙时只能丢弃
+    if (fillCount > 0 && !sealed) {
+        sealBlock();
+    }
+    if (sealed && !handOff()) {
+        samplesDropped += fillCount;
+        fillCount = 0;
+        sealed = false;
+    }
+}
+
+void RawRecorder::beginBlock(uint32_t sampleIndex) {
+    fillFirstSample = sampleIndex;
+    beginDataBlock(buffers[fillIndex], session.sessionId, sampleIndex, clock != nullptr ? clock() : 0);
+}
+
+void RawRecorder::sealBlock() {
+    // CRC 由写线程计算
+    sealDataBlock(buffers[fillIndex], fillCount);
+    sealed = true;
+}
+
+bool RawRecorder::handOff() {
+    if (pending.load(std::memory_order_acquire)) {
+        return false;
+    }
+    pendingIndex = fillIndex;
+    samplesRecorded += fillCount;
+    pending.store(true, std::memory_order_release);
+    fillIndex ^= 1;
+    fillCount = 0;
+    sealed = false;
+    if (readyCallback != nullptr) {
+        readyCallback(readyContext);
+    }
+    return true;
+}
+
+void RawRecorder::push(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex) {
+    if (!recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // 上一块已满而写线程还没取走另一块: 丢弃样本，不等待
+    if (sealed && !handOff()) {
+        samplesDropped++;
+        return;
+    }
+
+    // 块内样本序号必须连续，出现缺口时提前结束当前块
+    if (fillCount > 0 && sampleIndex != fillFirstSample + (uint32_t)fillCount) {
+        sealBlock();
+        if (!handOff()) {
+            samplesDropped++;
+            return;
+        }
+    }
+    if (fillCount == 0) {
+        beginBlock(sampleIndex);
+    }
+
+    putSample(buffers[fillIndex], fillCount, x, y, z);
+    fillCount++;
+
+    if (fillCount == SAMPLES_PER_BLOCK) {
+        sealBlock();
+        handOff();
+    }
+}
+
+bool RawRecorder::service() {
+    if (!pending.load(std::memory_order_acquire)) {
+        return false;
+    }
+    uint8_t* block = buffers[pendingIndex];
+    finishDataBlock(block);
+    writeBlock(block);
+    pending.store(false, std::memory_order_release);
+    return true;
+}
+
+void RawRecorder::setClock(ClockFunction function) {
+    clock = function;
+}
+
+void RawRecorder::setReadyCallback(BlockReadyCallback callback, void* context) {
+    readyCallback = callback;
+    readyContext = context;
+}
+
+bool RawRecorder::isRecording() {
+    return recording.load();
+}
+
+bool RawRecorder::hasPendingBlock() {
+    return pending.load(std::memory_order_acquire);
+}
+
+bool RawRecorder::isFull() {
+    return full.load();
+}
+
+uint32_t RawRecorder::getNextBlock() {
+    return nextBlock;
+}
+
+uint32_t RawRecorder::getBlockCount() {
+    return blockCount;
+}
+
+uint32_t RawRecorder::getSessionId() {
+    return session.sessionId;
+}
+
+uint32_t RawRecorder::getSamplesRecorded() {
+    return samplesRecorded;
+}
+
+uint32_t RawRecorder::getSamplesDropped() {
+    return samplesDropped;
+}
+
+uint32_t RawRecorder::getBlocksWritten() {
+    return blocksWritten;
+}
+
+uint32_t RawRecorder::getWriteErrors() {
+    return writeErrors;
+}
@@ -0,0 +1,224 @@
+#include "raw_stream.h"
+
+namespace rawstream {
+
+static bool getVarint(const uint8_t* in, int len, int* pos, uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 21; shift += 7) {
+        if (*pos >= len) {
+            return false;
+        }
+        uint8_t byte = in[(*pos)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+int decodePacket(const uint8_t* in, int len, int16_t* xyz, int maxSamples, uint32_t* firstSample) {
+    if (len < HEADER_SIZE || in[0] != STREAM_VERSION) {
+        return -1;
+    }
+    int count = in[1];
+    if (count > maxSamples) {
+        return -1;
+    }
+    *firstSample = in[2] | (in[3] << 8) | (in[4] << 16) | ((uint32_t)in[5] << 24);
+
+    int pos = HEADER_SIZE;
+    int32_t previous[3] = {0, 0, 0};
+    for (int n = 0; n < count; n++) {
+        for (int a = 0; a < 3; a++) {
+            uint32_t value;
+            if (!getVarint(in, len, &pos, &value)) {
+                return -1;
+            }
+            previous[a] = (int16_t)(previous[a] + unzigzag(value));
+            xyz[3 * n + a] = (int16_t)previous[a];
+        }
+    }
+    return (pos == len) ? count : -1;
+}
+
+}  // namespace rawstream
+
+RawStreamEncoder::RawStreamEncoder() {
+    out = nullptr;
+    capacity = 0;
+    length = 0;
+    count = 0;
+}
+
+void RawStreamEncoder::begin(uint8_t* buffer, int bufferCapacity, uint32_t firstSample) {
+    out = buffer;
+    capacity = bufferCapacity;
+    out[0] = rawstream::STREAM_VERSION;
+    out[1] = 0;
+    out[2] = (uint8_t)(firstSample & 0xFF);
+    out[3] = (uint8_t)((firstSample >> 8) & 0xFF);
+    out[4] = (uint8_t)((firstSample >> 16) & 0xFF);
+    out[5] = (uint8_t)(firstSample >> 24);
+    length = rawstream::HEADER_SIZE;
+    count = 0;
+    previous[0] = 0;
+    previous[1] = 0;
+    previous[2] = 0;
+}
+
+void RawStreamEncoder::putVarint(uint32_t value) {
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+}
+
+void RawStreamEncoder::add(int16_t x, int16_t y, int16_t z) {
+    // 相邻样本差值通常很小 (52Hz 采样)，zigzag 后多为 1 字节
+    putVarint(rawstream::zigzag((int32_t)x - previous[0]));
+    putVarint(rawstream::zigzag((int32_t)y - previous[1]));
+    putVarint(rawstream::zigzag((int32_t)z - previous[2]));
+    previous[0] = x;
+    previous[1] = y;
+    previous[2] = z;
+    count++;
+}
+
+bool RawStreamEncoder::isFull() {
+    return length + rawstream::MAX_SAMPLE_BYTES > capacity || count >= rawstream::MAX_SAMPLES_PER_PACKET;
+}
+
+int RawStreamEncoder::finish() {
+    out[1] = (uint8_t)count;
+    return length;
+}
+
+int RawStreamEncoder::getCount() {
+    return count;
+}
+
+RawStreamer::RawStreamer() {
+    readyCallback = nullptr;
+    readyContext = nullptr;
+    enabled.store(false);
+    payloadLimit.store(rawstream::MAX_PACKET_SIZE);
+    reset();
+}
+
+void RawStreamer::reset() {
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    packetOpen = false;
+    samplesEncoded = 0;
+    samplesDropped = 0;
+    packetsProduced = 0;
+    bytesProduced = 0;
+}
+
+bool RawStreamer::openPacket(uint32_t sampleIndex) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= RAW_STREAM_PACKET_SLOTS) {
+        return false;
+    }
+
+    int limit = payloadLimit.load(std::memory_order_relaxed);
+    if (limit > rawstream::MAX_PACKET_SIZE) {
+        limit = rawstream::MAX_PACKET_SIZE;
+    }
+    if (limit < rawstream::HEADER_SIZE + rawstream::MAX_SAMPLE_BYTES) {
+        limit = rawstream::HEADER_SIZE + rawstream::MAX_SAMPLE_BYTES;
+    }
+    // 直接在队列槽中编码，无额外复制
+    encoder.begin(packets[h % RAW_STREAM_PACKET_SLOTS].data, limit, sampleIndex);
+    packetOpen = true;
+    return true;
+}
+
+void RawStreamer::closePacket() {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    Packet& packet = packets[h % RAW_STREAM_PACKET_SLOTS];
+    packet.length = (uint16_t)encoder.finish();
+    bytesProduced += packet.length;
+    packetsProduced++;
+    packetOpen = false;
+    head.store(h + 1, std::memory_order_release);
+
+    if (readyCallback != nullptr) {
+        readyCallback(readyContext);
+    }
+}
+
+void RawStreamer::push(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex) {
+    if (!enabled.load(std::memory_order_relaxed)) {
+        // 停止时丢弃未完成的包
+        packetOpen = false;
+        return;
+    }
+
+    if (!packetOpen && !openPacket(sampleIndex)) {
+        samplesDropped++;
+        return;
+    }
+
+    encoder.add(x, y, z);
+    samplesEncoded++;
+
+    // 包满立即交给 BLE 线程，不等下一个样本
+    if (encoder.isFull()) {
+        closePacket();
+    }
+}
+
+const uint8_t* RawStreamer::peek(int* length) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t) {
+        return nullptr;
+    }
+    const Packet& packet = packets[t % RAW_STREAM_PACKET_SLOTS];
+    *length = packet.length;
+    return packet.data;
+}
+
+void RawStreamer::pop() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void RawStreamer::setEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool RawStreamer::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void RawStreamer::setPayloadLimit(int limit) {
+    payloadLimit.store(limit, std::memory_order_relaxed);
+}
+
+void RawStreamer::setReadyCallback(PacketReadyCallback callback, void* context) {
+    readyCallback = callback;
+    readyContext = context;
+}
+
+uint32_t RawStreamer::getSamplesEncoded() {
+    return samplesEncoded;
+}
+
+uint32_t RawStreamer::getSamplesDropped() {
+    return samplesDropped;
+}
+
+uint32_t RawStreamer::getPacketsProduced() {
+    return packetsProduced;
+}
+
+uint32_t RawStreamer::getBytesProduced() {
+    return bytesProduced;
+}
+
+int RawStreamer::getPendingPackets() {
+    return (int)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
@@ -0,0 +1,306 @@
+#include "replay_engine.h"
+#include "session_file.h"
+#include "mapped_file.h"
+#include <chrono>
+#include <cstring>
+
+namespace replay {
+
+// 把按序号到来的样本拆成连续的段并直接回放: 序号不连续时结束当前段，
+// 同一会话的后续段加 "#n" 后缀; 每段的结果写入各自的输出文件
+class SegmentRunner {
+private:
+    SessionReplayer* replayer;
+    const char* outDir;
+    std::vector<SegmentSummary>* segments;
+    LoadStats* stats;
+    std::string name;
+    int part;
+    bool open;
+    bool replaying;                 // 当前段的输出文件已打开 (或不需要输出)
+    uint32_t nextSample;
+    FILE* out;
+
+    void start(uint32_t index) {
+        SegmentSummary segment;
+        segment.name = name;
+        if (part > 0) {
+            char suffix[16];
+            snprintf(suffix, sizeof(suffix), "#%d", part);
+            segment.name += suffix;
+        }
+        memset(&segment.summary, 0, sizeof(segment.summary));
+        segment.openFailed = false;
+        part++;
+        open = true;
+        nextSample = index;
+
+        out = nullptr;
+        if (outDir != nullptr) {
+            std::string path = std::string(outDir) + "/" + segment.name + ".csv";
+            out = fopen(path.c_str(), "w");
+            if (out == nullptr) {
+                segment.openFailed = true;
+            } else {
+                writeResultHeader(out);
+            }
+        }
+        replaying = !segment.openFailed;
+        if (replaying) {
+            replayer->begin(out);
+        }
+        segments->push_back(segment);
+    }
+
+public:
+    SegmentRunner(SessionReplayer* sessionReplayer, const char* outputDir,
+                  std::vector<SegmentSummary>* output, LoadStats* loadStats)
+        : replayer(sessionReplayer), outDir(outputDir), segments(output), stats(loadStats),
+          part(0), open(false), replaying(false), nextSample(0), out(nullptr) {}
+
+    ~SegmentRunner() {
+        close();
+    }
+
+    void beginSession(const std::string& sessionName) {
+        close();
+        name = sessionName;
+        part = 0;
+        stats->sessions++;
+    }
+
+    void append(uint32_t index, int16_t x, int16_t y, int16_t z) {
+        if (open && index != nextSample) {
+            stats->gaps++;
+            close();
+        }
+        if (!open) {
+            start(index);
+        }
+        nextSample = index + 1;
+        if (replaying) {
+            replayer->addSample(x, y, z);
+        }
+    }
+
+    // 结束当前段 (没有打开的段时不做任何事)
+    void close() {
+        if (!open) {
+            return;
+        }
+        open = false;
+        if (!replaying) {
+            return;
+        }
+        Summary summary = replayer->finish();
+        if (out != nullptr && fclose(out) != 0) {
+            summary.outputError = true;
+        }
+        out = nullptr;
+        segments->back().summary = summary;
+    }
+};
+
+static std::string baseNameOf(const char* path) {
+    std::string name(path);
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        name = name.substr(slash + 1);
+    }
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) {
+        name = name.substr(0, dot);
+    }
+    return name;
+}
+
+bool replayCsv(const char* path, SessionReplayer* replayer, const char* outDir,
+               std::vector<SegmentSummary>* segments, LoadStats* stats) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        return false;
+    }
+
+    SegmentRunner runner(replayer, outDir, segments, stats);
+    runner.beginSession(baseNameOf(path));
+
+    char line[128];
+    uint32_t nextIndex = 0;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        uint32_t index = nextIndex;
+        int16_t xyz[3];
+        if (sessionfile::parseCsvSample(line, &index, xyz) == 0) {
+            continue;
+        }
+        runner.append(index, xyz[0], xyz[1], xyz[2]);
+        nextIndex = index + 1;
+    }
+    runner.close();
+    fclose(file);
+    return true;
+}
+
+bool replayRecorderImage(const char* path, SessionReplayer* replayer, const char* outDir,
+                         std::vector<SegmentSummary>* segments, LoadStats* stats) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::string baseName = baseNameOf(path);
+    SegmentRunner runner(replayer, outDir, segments, stats);
+    bool inSession = false;
+    uint32_t sessionId = 0;
+    uint8_t block[RECORDER_BLOCK_SIZE];
+    int16_t xyz[sessionfile::SAMPLES_PER_BLOCK * 3];
+
+    while (fread(block, 1, sizeof(block), file) == sizeof(block)) {
+        sessionfile::SessionInfo session;
+        sessionfile::BlockInfo info;
+        int type = sessionfile::decodeBlock(block, &session, &info, xyz);
+
+        if (type == 0) {
+            // 第一个空块之后没有数据 (记录按块顺序写入)
+            break;
+        }
+        if (type < 0) {
+            // 损坏的块: 跳过，随后的数据块会因序号缺口开始新的一段
+            stats->badBlocks++;
+            continue;
+        }
+
+        // 会话块丢失时以数据块中的会话 ID 开始会话
+        uint32_t id = (type == 1) ? session.sessionId : info.sessionId;
+        if (!inSession || id != sessionId) {
+            char suffix[24];
+            snprintf(suffix, sizeof(suffix), "-s%lu", (unsigned long)id);
+            runner.beginSession(baseName + suffix);
+            inSession = true;
+            sessionId = id;
+        }
+        if (type == 1) {
+            continue;
+        }
+        for (int i = 0; i < info.count; i++) {
+            runner.append(info.firstSample + i, xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+        }
+    }
+    runner.close();
+    fclose(file);
+    return true;
+}
+
+bool replaySessionFile(const char* path, SessionReplayer* replayer, const char* outDir,
+                       std::vector<SegmentSummary>* segments, LoadStats* stats) {
+    MappedFile mapped;
+    sessionfile::FileView view;
+    if (!mapped.open(path) || !view.open(mapped.getData(), mapped.getSize())) {
+        return false;
+    }
+
+    // 一个会话文件只有一个会话，以文件名命名
+    SegmentRunner runner(replayer, outDir, segments, stats);
+    runner.beginSession(baseNameOf(path));
+
+    // 逐块校验 CRC 后从映射中读出样本 (CRC 错误的块跳过，形成缺口)
+    int16_t xyz[sessionfile::SAMPLES_PER_BLOCK * 3];
+    for (uint32_t k = 0; k < view.getBlockCount(); k++) {
+        sessionfile::SessionInfo session;
+        sessionfile::BlockInfo info;
+        if (sessionfile::decodeBlock(view.getBlock(k), &session, &info, nullptr) != 2) {
+            stats->badBlocks++;
+            continue;
+        }
+        int count = view.readSamples(info.firstSample, info.count, xyz);
+        for (int i = 0; i < count; i++) {
+            runner.append(info.firstSample + i, xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+        }
+    }
+    runner.close();
+    return true;
+}
+
+void writeResultHeader(FILE* out) {
+    fprintf(out, "sequence,timestamp_ms,tremor,tremor_intensity,dyskinesia,dyskinesia_intensity,"
+                 "fog,motion_state,dominant_axis\n");
+}
+
+void writeResult(FILE* out, const DetectionResult& result) {
+    fprintf(out, "%lu,%lu,%d,%.4f,%d,%.4f,%d,%d,%d\n",
+            (unsigned long)result.sequence, (unsigned long)result.timestampMs,
+            result.tremorDetected ? 1 : 0, result.tremorIntensity,
+            result.dyskinesiaDetected ? 1 : 0, result.dyskinesiaIntensity,
+            result.fogDetected ? 1 : 0, (int)result.motionState, result.dominantAxis);
+}
+
+SessionReplayer::SessionReplayer() {
+    sampleTimeMs = 0;
+    output = nullptr;
+    memset(&current, 0, sizeof(current));
+    detector.setClock(sampleClock, this);
+}
+
+uint32_t SessionReplayer::sampleClock(void* context) {
+    return ((SessionReplayer*)context)->sampleTimeMs;
+}
+
+void SessionReplayer::setHopSize(int hop) {
+    builder.setHopSize(hop);
+}
+
+void SessionReplayer::begin(FILE* out) {
+    memset(&current, 0, sizeof(current));
+    output = out;
+
+    // 每段从头开始，与板上重新开始采样相同
+    builder.reset();
+    detector.reset();
+    sampleTimeMs = 0;
+    started = std::chrono::steady_clock::now();
+}
+
+void SessionReplayer::addSample(int16_t x, int16_t y, int16_t z) {
+    current.samples++;
+    if (!builder.addSample(x, y, z)) {
+        return;
+    }
+    builder.fillWindow(&window);
+    sampleTimeMs = (uint32_t)((uint64_t)(window.firstSample + WINDOW_SIZE - 1) * 1000 / SAMPLE_RATE);
+
+    DetectionResult result = detector.analyzeWindow(window);
+    current.windows++;
+    if (result.tremorDetected) {
+        current.tremorWindows++;
+    }
+    if (result.dyskinesiaDetected) {
+        current.dyskinesiaWindows++;
+    }
+    if (result.fogDetected) {
+        current.fogWindows++;
+    }
+    if (output != nullptr) {
+        writeResult(output, result);
+    }
+}
+
+Summary SessionReplayer::finish() {
+    if (output != nullptr && ferror(output)) {
+        current.outputError = true;
+    }
+    output = nullptr;
+    current.elapsedUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    return current;
+}
+
+Summary SessionReplayer::run(const Session& session, FILE* out) {
+    begin(out);
+    const int16_t* xyz = session.xyz.data();
+    uint32_t samples = session.getSampleCount();
+    for (uint32_t n = 0; n < samples; n++) {
+        addSample(xyz[3 * n], xyz[3 * n + 1], xyz[3 * n + 2]);
+    }
+    return finish();
+}
+
+}  // namespace replay
@@ -1,12 +1,25 @@
 #include "sensor.h"
-#include <cmath>
 
-SensorManager::SensorManager() {
+SensorManager::SensorManager() : int1(SENSOR_INT1_PIN), fifo(*this) {
     i2c = new I2C(SENSOR_I2C_SDA, SENSOR_I2C_SCL);
     i2c->frequency(400000); // 400kHz
-    bufferIndex = 0;
-    bufferFull = false;
-    sampleReady = false;
+    activeBatch = 0;
+    batchCount = 0;
+    batchPos = 0;
+    transferState = TRANSFER_IDLE;
+    transferSuccess = false;
+    transferCount = 0;
+#if STAGE_TIMING_ENABLED
+    transferStartUs = 0;
+    transferEndUs = 0;
+    convertUs = 0;
+#endif
+    asyncRegAddr = 0;
+    asyncDone = nullptr;
+    asyncContext = nullptr;
+    rawStream = nullptr;
+    captureLink = nullptr;
+    rawRecorder = nullptr;
 }
 
 SensorManager::~SensorManager() {
@@ -15,12 +28,19 @@ SensorManager::~SensorManager() {
 }
 
 bool SensorManager::writeReg(uint8_t reg, uint8_t value) {
+    waitTransferIdle();
+    DeepSleepLock lock;     // 事务期间不进入 Stop 模式
+    
     char data[2] = {(char)reg, (char)value};
     int result = i2c->write(LSM6DSL_ADDR, data, 2);
     return (result == 0);
 }
 
 bool SensorManager::readRegs(uint8_t reg, uint8_t* data, int len) {
+    // 同步访问前等待进行中的异步传输结束
+    waitTransferIdle();
+    DeepSleepLock lock;
+    
     char reg_addr = (char)reg;
     if (i2c->write(LSM6DSL_ADDR, &reg_addr, 1, true) != 0) {
         return false;
@@ -29,6 +49,27 @@ bool SensorManager::readRegs(uint8_t reg, uint8_t* data, int len) {
     return (result == 0);
 }
 
+#if DEVICE_I2C_ASYNCH
+bool SensorManager::readRegsAsync(uint8_t reg, uint8_t* data, int len, BusCompletion done, void* context) {
+    asyncRegAddr = (char)reg;
+    asyncDone = done;
+    asyncContext = context;
+    
+    // 写寄存器地址 + 重复起始读，DMA/中断驱动，立即返回
+    int result = i2c->transfer(LSM6DSL_ADDR, &asyncRegAddr, 1, (char*)data, len,
+                               event_callback_t(this, &SensorManager::onI2CEvent),
+                               I2C_EVENT_ALL, false);
+    return (result == 0);
+}
+
+void SensorManager::onI2CEvent(int event) {
+    // I2C 中断上下文
+    bool success = (event & I2C_EVENT_TRANSFER_COMPLETE) && !(event & I2C_EVENT_ERROR)
+                   && !(event & I2C_EVENT_ERROR_NO_SLAVE) && !(event & I2C_EVENT_TRANSFER_EARLY_NACK);
+    asyncDone(asyncContext, success);
+}
+#endif
+
 bool SensorManager::begin() {
     printf("Initializing LSM6DSL sensor...\r\n");
     
@@ -53,95 +94,239 @@ bool SensorManager::begin() {
         return false;
     }
     
+    // CTRL3_C: BDU=1 (块更新), IF_INC=1 (突发读取地址自增)
+    if (!writeReg(lsm6dsl::CTRL3_C, lsm6dsl::CTRL3_C_BDU_IF_INC)) {
+        printf("Failed to configure CTRL3_C\r\n");
+        return false;
+    }
+    
     thread_sleep_for(100); // 等待传感器稳定
     
     printf("LSM6DSL initialized successfully\r\n");
     return true;
 }
 
-void SensorManager::sampleISR() {
+void SensorManager::fifoISR() {
     // ISR 中不能使用 I2C（需要互斥锁）
-    // 只设置标志，数据读取在 update() 中进行
-    sampleReady = true;
+    // 只唤醒等待线程，数据读取在 update() 中进行
+    dataFlags.set(FLAG_FIFO_WATERMARK);
 }
 
 void SensorManager::startSampling() {
-    printf("Starting sampling at 52Hz...\r\n");
-    bufferIndex = 0;
-    bufferFull = false;
-    // 19ms = 19000us
-    sampler.attach(callback(this, &SensorManager::sampleISR), 
-                   std::chrono::microseconds(SAMPLE_PERIOD_MS * 1000));
+    printf("Starting FIFO sampling at 52Hz (window %d, hop %d, watermark %d)...\r\n",
+           WINDOW_SIZE, builder.getHopSize(), FIFO_WATERMARK);
+    activeBatch = 0;
+    batchCount = 0;
+    batchPos = 0;
+    builder.reset();
+    windows.reset();
+    
+    // FIFO 连续模式，按传感器自身 ODR 采样，水位到达时 INT1 拉高
+    if (!fifo.configure(FIFO_WATERMARK)) {
+        printf("Failed to configure FIFO\r\n");
+        return;
+    }
+    int1.rise(callback(this, &SensorManager::fifoISR));
 }
 
 void SensorManager::stopSampling() {
-    sampler.detach();
+    int1.rise(nullptr);
+    fifo.stop();
 }
 
-void SensorManager::update() {
-    // 检查是否需要采样
-    if (!sampleReady) {
-        return;
+void SensorManager::onTransferComplete(void* context, bool success) {
+    // I2C 中断上下文: 只记录结果并唤醒等待线程
+    SensorManager* self = (SensorManager*)context;
+#if STAGE_TIMING_ENABLED
+    self->transferEndUs = timing::now();
+#endif
+    sleep_manager_unlock_deep_sleep();
+    self->transferSuccess = success;
+    self->transferState = TRANSFER_DONE;
+    self->dataFlags.set(FLAG_TRANSFER_DONE);
+}
+
+void SensorManager::waitTransferIdle() {
+#if DEVICE_I2C_ASYNCH
+    // I2C 外设同一时刻只能执行一个传输
+    while (transferState == TRANSFER_BUSY) {
+        dataFlags.wait_any(FLAG_TRANSFER_DONE);
     }
-    sampleReady = false;
+#endif
+}
 
-    // 读取加速度计数据
-    uint8_t data[6];
-    if (!readRegs(OUTX_L_XL, data, 6)) {
+void SensorManager::startTransfer() {
+    // 已有传输或已填好的批次未取走，或水位未到达
+    if (transferState != TRANSFER_IDLE || !int1.read()) {
+        return;
+    }
+    
+#if STAGE_TIMING_ENABLED
+    // 采集阶段: 状态读取 + 突发读取直到完成中断，期间持有深度睡眠锁，us ticker 不停止
+    transferStartUs = timing::now();
+#endif
+    
+    // 状态读取是短事务 (同步)，整批数据读取异步进行
+    int count = fifo.prepareBatch(FIFO_BATCH_MAX);
+    if (count <= 0) {
         return;
     }
+    
+    transferCount = count;
+    transferState = TRANSFER_BUSY;
+    
+    // 传输期间保持深度睡眠锁 (Stop 模式会停止 I2C 时钟)，完成回调中释放；
+    // 传输之间线程阻塞等待 INT1，MCU 可进入 Stop 模式
+    sleep_manager_lock_deep_sleep();
+    if (!fifo.startBatchRead(fifoBatch[1 - activeBatch], count, &SensorManager::onTransferComplete, this)) {
+        sleep_manager_unlock_deep_sleep();
+        transferState = TRANSFER_IDLE;
+    }
+}
 
-    // 转换为 int16_t
-    int16_t ax_raw = (int16_t)((data[1] << 8) | data[0]);
-    int16_t ay_raw = (int16_t)((data[3] << 8) | data[2]);
-    int16_t az_raw = (int16_t)((data[5] << 8) | data[4]);
+void SensorManager::waitForData() {
+    // 还有未处理的样本，或已有完成的批次，无需等待
+    while (batchPos >= batchCount && transferState != TRANSFER_DONE) {
+        startTransfer();
+        if (transferState == TRANSFER_DONE) {
+            break;
+        }
+        dataFlags.wait_any(FLAG_FIFO_WATERMARK | FLAG_TRANSFER_DONE);
+    }
+}
 
-    // 转换为 m/s² (±2g, 灵敏度 0.061 mg/LSB)
-    float ax = ax_raw * 0.061f / 1000.0f * 9.81f;
-    float ay = ay_raw * 0.061f / 1000.0f * 9.81f;
-    float az = az_raw * 0.061f / 1000.0f * 9.81f;
+bool SensorManager::update() {
+    if (batchPos >= batchCount) {
+        if (transferState != TRANSFER_DONE) {
+            // 数据尚未到达: 水位到达时发起异步读取，不阻塞调用者
+            startTransfer();
+            return false;
+        }
+        
+        // 切换到刚填好的批次
+        bool success = transferSuccess;
+#if STAGE_TIMING_ENABLED
+        timing::record(timing::STAGE_CAPTURE, transferEndUs - transferStartUs);
+        uint32_t convertStart = timing::now();
+#endif
+        activeBatch = 1 - activeBatch;
+        batchCount = success ? transferCount : 0;
+        batchPos = 0;
+        transferState = TRANSFER_IDLE;
+        if (!success) {
+            return false;
+        }
+        fifo.finishBatch(fifoBatch[activeBatch], batchCount);
+#if STAGE_TIMING_ENABLED
+        convertUs = timing::now() - convertStart;
+#endif
+        
+        // 流水线: 消费本批样本 (以及随后的 FFT) 期间读取下一批
+        startTransfer();
+    }
+    
+    const int16_t* xyz = &fifoBatch[activeBatch][3 * batchPos];
+    batchPos++;
+#if STAGE_TIMING_ENABLED
+    // 转换阶段按批次记录: 字节序转换 + 本批每个样本的压缩/记录/窗口组装 (不含流水线中的状态读取)
+    uint32_t sampleStart = timing::now();
+    storeSample(xyz[0], xyz[1], xyz[2]);
+    convertUs += timing::now() - sampleStart;
+    if (batchPos >= batchCount) {
+        timing::record(timing::STAGE_CONVERT, convertUs);
+    }
+#else
+    storeSample(xyz[0], xyz[1], xyz[2]);
+#endif
+    // 有线采集: 每批样本 (一个 FIFO 水位，约 0.5 秒) 至少发送一个包
+    if (captureLink != nullptr && batchPos >= batchCount) {
+        captureLink->flushSamples();
+    }
+    return true;
+}
 
-    // 减去重力
-    az -= 9.81f;
+void SensorManager::storeSample(int16_t ax_raw, int16_t ay_raw, int16_t az_raw) {
+    uint32_t sampleIndex = builder.getTotalSamples();
 
-    // 计算合成加速度
-    float magnitude = sqrtf(ax*ax + ay*ay + az*az);
+    // 原始数据流: 差分 + varint，每样本常数时间
+    if (rawStream != nullptr) {
+        rawStream->push(ax_raw, ay_raw, az_raw, sampleIndex);
+    }
+    // 原始数据记录: 只复制到 RAM 块，从不等待 flash
+    if (rawRecorder != nullptr) {
+        rawRecorder->push(ax_raw, ay_raw, az_raw, sampleIndex);
+    }
+    // 有线采集: 同样的差分压缩，包满时复制到发送缓冲区，从不等待串口
+    if (captureLink != nullptr) {
+        captureLink->pushSample(ax_raw, ay_raw, az_raw, sampleIndex);
+    }
 
-    // 存入缓冲区
-    dataBuffer[bufferIndex] = magnitude;
-    bufferIndex++;
+    // 首个窗口填满后，每 hopSize 个样本产出一个新窗口
+    if (builder.addSample(ax_raw, ay_raw, az_raw)) {
+        publishWindow();
+    }
+}
 
-    if (bufferIndex >= WINDOW_SIZE) {
-        bufferIndex = 0;
-        bufferFull = true;
+void SensorManager::publishWindow() {
+    // 分析端来不及时丢弃本窗口 (计入溢出，序号照常递增)，采样继续
+    AnalysisWindow* window = windows.beginWrite();
+    if (window == nullptr) {
+        return;
     }
+    
+    builder.fillWindow(window);
+    windows.commitWrite();
+    dataFlags.set(FLAG_WINDOW_READY);
+}
+
+float SensorManager::getLatestSample() {
+    return builder.getLatestSample();
+}
+
+void SensorManager::setRawStream(RawStreamer* streamer) {
+    rawStream = streamer;
 }
 
-bool SensorManager::isBufferReady() {
-    return bufferFull;
+void SensorManager::setRecorder(RawRecorder* recorder) {
+    rawRecorder = recorder;
 }
 
-float* SensorManager::getDataBuffer() {
-    return dataBuffer;
+void SensorManager::setCaptureLink(CaptureLink* link) {
+    captureLink = link;
 }
 
-void SensorManager::clearBuffer() {
-    bufferFull = false;
+void SensorManager::setHopSize(int hop) {
+    builder.setHopSize(hop);
 }
 
-float SensorManager::getCurrentMagnitude() {
-    uint8_t data[6];
-    if (!readRegs(OUTX_L_XL, data, 6)) {
-        return 0.0f;
+int SensorManager::getHopSize() {
+    return builder.getHopSize();
+}
+
+AnalysisWindow* SensorManager::acquireWindow() {
+    return windows.beginRead();
+}
+
+AnalysisWindow* SensorManager::waitForWindow() {
+    AnalysisWindow* window;
+    while ((window = windows.beginRead()) == nullptr) {
+        dataFlags.wait_any(FLAG_WINDOW_READY);
     }
-    
-    int16_t ax_raw = (int16_t)((data[1] << 8) | data[0]);
-    int16_t ay_raw = (int16_t)((data[3] << 8) | data[2]);
-    int16_t az_raw = (int16_t)((data[5] << 8) | data[4]);
-    
-    float ax = ax_raw * 0.061f / 1000.0f * 9.81f;
-    float ay = ay_raw * 0.061f / 1000.0f * 9.81f;
-    float az = az_raw * 0.061f / 1000.0f * 9.81f - 9.81f;
-    
-    return sqrtf(ax*ax + ay*ay + az*az);
+    return window;
+}
+
+void SensorManager::releaseWindow() {
+    windows.commitRead();
+}
+
+uint32_t SensorManager::getWindowOverruns() {
+    return windows.getOverruns();
+}
+
+uint32_t SensorManager::getFifoOverruns() {
+    return fifo.getOverruns();
+}
+
+uint32_t SensorManager::getBusTransactions() {
+    return fifo.getTransactions();
 }
\ No newline at end of file
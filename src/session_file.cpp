@@ -0,0 +1,287 @@
+#include "session_file.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace sessionfile {
+
+FileWriter::FileWriter() {
+    file = nullptr;
+    memset(&info, 0, sizeof(info));
+    fillCount = 0;
+    fillFirstSample = 0;
+    offset = 0;
+    sampleCount = 0;
+    failed = false;
+}
+
+bool FileWriter::open(FILE* output, const SessionInfo& session) {
+    file = output;
+    info = session;
+    fillCount = 0;
+    offset = 0;
+    sampleCount = 0;
+    index.clear();
+    failed = false;
+
+    encodeSessionHeader(info, block);
+    if (fwrite(block, 1, BLOCK_SIZE, file) != (size_t)BLOCK_SIZE) {
+        failed = true;
+        return false;
+    }
+    offset = BLOCK_SIZE;
+    return true;
+}
+
+bool FileWriter::writeBlock(const uint8_t* data, uint32_t firstSample, int count) {
+    if (fwrite(data, 1, BLOCK_SIZE, file) != (size_t)BLOCK_SIZE) {
+        failed = true;
+        return false;
+    }
+    index.push_back(firstSample);
+    index.push_back(offset);
+    offset += BLOCK_SIZE;
+    sampleCount += count;
+    return true;
+}
+
+bool FileWriter::flushBlock() {
+    if (fillCount == 0) {
+        return true;
+    }
+    sealDataBlock(block, fillCount);
+    finishDataBlock(block);
+    int count = fillCount;
+    fillCount = 0;
+    return writeBlock(block, fillFirstSample, count);
+}
+
+bool FileWriter::append(int16_t x, int16_t y, int16_t z, uint32_t sampleIndex) {
+    if (file == nullptr || failed) {
+        return false;
+    }
+    // 块内样本序号必须连续
+    if (fillCount > 0 && sampleIndex != fillFirstSample + (uint32_t)fillCount && !flushBlock()) {
+        return false;
+    }
+    if (fillCount == 0) {
+        // 没有采集时间时按 ODR 从起始时间推算
+        uint32_t timestampMs = info.startMs;
+        if (info.odrHz > 0) {
+            timestampMs += (uint32_t)((uint64_t)(sampleIndex - info.startSample) * 1000 / info.odrHz);
+        }
+        fillFirstSample = sampleIndex;
+        beginDataBlock(block, info.sessionId, sampleIndex, timestampMs);
+    }
+    putSample(block, fillCount, x, y, z);
+    fillCount++;
+    if (fillCount == SAMPLES_PER_BLOCK) {
+        return flushBlock();
+    }
+    return true;
+}
+
+bool FileWriter::appendBlock(const uint8_t* data) {
+    if (file == nullptr || failed || !flushBlock()) {
+        return false;
+    }
+    SessionInfo session;
+    BlockInfo blockInfo;
+    if (decodeBlock(data, &session, &blockInfo, nullptr) != 2) {
+        return false;
+    }
+    return writeBlock(data, blockInfo.firstSample, blockInfo.count);
+}
+
+bool FileWriter::close() {
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = flushBlock() && !failed;
+
+    // 稀疏索引 + 尾部
+    uint8_t entry[INDEX_ENTRY_SIZE];
+    for (size_t i = 0; ok && i < index.size(); i += 2) {
+        putU32(&entry[0], index[i]);
+        putU32(&entry[4], index[i + 1]);
+        ok = fwrite(entry, 1, INDEX_ENTRY_SIZE, file) == (size_t)INDEX_ENTRY_SIZE;
+    }
+    uint8_t trailer[TRAILER_SIZE];
+    putU32(&trailer[0], INDEX_MAGIC);
+    putU32(&trailer[4], offset);
+    putU32(&trailer[8], getBlockCount());
+    putU32(&trailer[12], sampleCount);
+    ok = ok && fwrite(trailer, 1, TRAILER_SIZE, file) == (size_t)TRAILER_SIZE;
+    file = nullptr;
+    return ok;
+}
+
+uint32_t FileWriter::getSampleCount() {
+    return sampleCount + fillCount;
+}
+
+uint32_t FileWriter::getBlockCount() {
+    return (uint32_t)(index.size() / 2);
+}
+
+FileView::FileView() {
+    base = nullptr;
+    memset(&info, 0, sizeof(info));
+    index = nullptr;
+    blockCount = 0;
+    sampleCount = 0;
+}
+
+bool FileView::open(const uint8_t* data, uint32_t length) {
+    base = nullptr;
+    if (length < (uint32_t)(BLOCK_SIZE + TRAILER_SIZE)) {
+        return false;
+    }
+    BlockInfo unused;
+    if (decodeBlock(data, &info, &unused, nullptr) != 1) {
+        return false;
+    }
+
+    const uint8_t* trailer = data + length - TRAILER_SIZE;
+    uint32_t indexOffset = getU32(&trailer[4]);
+    uint32_t blocks = getU32(&trailer[8]);
+    if (getU32(&trailer[0]) != INDEX_MAGIC || indexOffset != (uint32_t)BLOCK_SIZE * (blocks + 1)
+        || (uint64_t)indexOffset + (uint64_t)blocks * INDEX_ENTRY_SIZE + TRAILER_SIZE != length) {
+        return false;
+    }
+
+    // 只检查索引 (约为文件的 0.8%)，不读样本数据: 偏移在数据区内且对齐，样本序号递增
+    const uint8_t* entries = data + indexOffset;
+    for (uint32_t k = 0; k < blocks; k++) {
+        uint32_t blockOffset = getU32(&entries[k * INDEX_ENTRY_SIZE + 4]);
+        if (blockOffset < (uint32_t)BLOCK_SIZE || blockOffset >= indexOffset || blockOffset % BLOCK_SIZE != 0
+            || (k > 0 && getU32(&entries[k * INDEX_ENTRY_SIZE]) <= getU32(&entries[(k - 1) * INDEX_ENTRY_SIZE]))) {
+            return false;
+        }
+    }
+
+    uint32_t samples = getU32(&trailer[12]);
+    if (samples > blocks * (uint32_t)SAMPLES_PER_BLOCK) {
+        return false;
+    }
+
+    base = data;
+    index = entries;
+    blockCount = blocks;
+    sampleCount = samples;
+    return true;
+}
+
+const SessionInfo& FileView::getInfo() {
+    return info;
+}
+
+uint32_t FileView::getBlockCount() {
+    return blockCount;
+}
+
+uint32_t FileView::getSampleCount() {
+    return sampleCount;
+}
+
+const uint8_t* FileView::getBlock(uint32_t k) {
+    return base + getU32(&index[k * INDEX_ENTRY_SIZE + 4]);
+}
+
+uint32_t FileView::getBlockFirstSample(uint32_t k) {
+    return getU32(&index[k * INDEX_ENTRY_SIZE]);
+}
+
+int FileView::getBlockSamples(uint32_t k) {
+    // 损坏的样本数按空块处理，不会读出块外
+    int count = getU16(&getBlock(k)[16]);
+    return count <= SAMPLES_PER_BLOCK ? count : 0;
+}
+
+int32_t FileView::findBlock(uint32_t sampleIndex) {
+    // 最后一个 firstSample <= sampleIndex 的块
+    uint32_t low = 0;
+    uint32_t high = blockCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (getBlockFirstSample(mid) <= sampleIndex) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return -1;
+    }
+    uint32_t k = low - 1;
+    if (sampleIndex - getBlockFirstSample(k) >= (uint32_t)getBlockSamples(k)) {
+        return -1;
+    }
+    return (int32_t)k;
+}
+
+int FileView::readSamples(uint32_t firstSample, int count, int16_t* xyz) {
+    int32_t k = findBlock(firstSample);
+    if (k < 0) {
+        return 0;
+    }
+    // 窗口可能跨块: 后续块必须紧接上一块 (否则是缺口)
+    int done = 0;
+    int start = (int)(firstSample - getBlockFirstSample(k));
+    while (done < count && (uint32_t)k < blockCount) {
+        if (done > 0 && getBlockFirstSample(k) != firstSample + (uint32_t)done) {
+            break;
+        }
+        int available = getBlockSamples(k) - start;
+        int n = count - done < available ? count - done : available;
+        readColumns(getBlock(k), start, n, &xyz[3 * done]);
+        done += n;
+        start = 0;
+        k++;
+    }
+    return done;
+}
+
+uint32_t FileView::verify() {
+    uint32_t bad = 0;
+    for (uint32_t k = 0; k < blockCount; k++) {
+        SessionInfo session;
+        BlockInfo blockInfo;
+        if (decodeBlock(getBlock(k), &session, &blockInfo, nullptr) != 2
+            || blockInfo.firstSample != getBlockFirstSample(k)) {
+            bad++;
+        }
+    }
+    return bad;
+}
+
+int parseCsvSample(const char* line, uint32_t* sampleIndex, int16_t* xyz) {
+    long values[4];
+    int count = 0;
+    const char* cursor = line;
+    while (count < 4) {
+        char* end;
+        long value = strtol(cursor, &end, 10);
+        if (end == cursor) {
+            break;
+        }
+        values[count++] = value;
+        cursor = end;
+        while (*cursor == ',' || *cursor == ' ' || *cursor == '\t') {
+            cursor++;
+        }
+    }
+    if (count < 3) {
+        return 0;
+    }
+    const long* axes = values;
+    if (count == 4) {
+        *sampleIndex = (uint32_t)values[0];
+        axes = values + 1;
+    }
+    for (int a = 0; a < 3; a++) {
+        xyz[a] = (int16_t)axes[a];
+    }
+    return count;
+}
+
+}  // namespace sessionfile
@@ -0,0 +1,105 @@
+#include "session_format.h"
+#include <cstring>
+
+namespace sessionfile {
+
+uint16_t crc16(const uint8_t* data, int len) {
+    // CRC-16/CCITT-FALSE (多项式 0x1021，初值 0xFFFF)
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void encodeSessionHeader(const SessionInfo& info, uint8_t* block) {
+    memset(block, 0xFF, BLOCK_SIZE);
+    putU32(&block[0], SESSION_MAGIC);
+    block[4] = FORMAT_VERSION;
+    block[5] = info.sensorId;
+    putU16(&block[6], info.odrHz);
+    putU16(&block[8], info.fullScaleG);
+    putU16(&block[10], (uint16_t)BLOCK_SIZE);
+    putU32(&block[12], info.sessionId);
+    putU32(&block[16], info.startSample);
+    putU32(&block[20], info.startMs);
+    putU32(&block[24], info.startEpoch);
+    putU32(&block[28], 0);
+}
+
+void beginDataBlock(uint8_t* block, uint32_t sessionId, uint32_t firstSample, uint32_t timestampMs) {
+    putU32(&block[0], DATA_MAGIC);
+    putU32(&block[4], sessionId);
+    putU32(&block[8], firstSample);
+    putU32(&block[12], timestampMs);
+    // 列之后不足一个样本的尾部保持擦除状态，同样的样本总是编码成同样的块
+    memset(&block[DATA_HEADER_SIZE + 3 * COLUMN_BYTES], 0xFF, BLOCK_SIZE - DATA_HEADER_SIZE - 3 * COLUMN_BYTES);
+}
+
+void sealDataBlock(uint8_t* block, int count) {
+    // 未用的样本位置保持 0xFF (与擦除状态一致)
+    putU16(&block[16], (uint16_t)count);
+    if (count < SAMPLES_PER_BLOCK) {
+        for (int axis = 0; axis < 3; axis++) {
+            memset(&block[DATA_HEADER_SIZE + axis * COLUMN_BYTES + 2 * count], 0xFF,
+                   2 * (SAMPLES_PER_BLOCK - count));
+        }
+    }
+}
+
+void finishDataBlock(uint8_t* block) {
+    putU16(&block[18], crc16(&block[DATA_HEADER_SIZE], 3 * COLUMN_BYTES));
+}
+
+int decodeBlock(const uint8_t* block, SessionInfo* session, BlockInfo* info, int16_t* xyz) {
+    uint32_t magic = getU32(&block[0]);
+    if (magic == 0xFFFFFFFF) {
+        return 0;
+    }
+
+    if (magic == SESSION_MAGIC) {
+        // 块大小与本构建不同的会话无法按块读取
+        uint16_t blockSize = getU16(&block[10]);
+        if (block[4] != FORMAT_VERSION || (blockSize != 0 && blockSize != BLOCK_SIZE)) {
+            return -1;
+        }
+        session->sensorId = block[5];
+        session->odrHz = getU16(&block[6]);
+        session->fullScaleG = getU16(&block[8]);
+        session->sessionId = getU32(&block[12]);
+        session->startSample = getU32(&block[16]);
+        session->startMs = getU32(&block[20]);
+        session->startEpoch = getU32(&block[24]);
+        return 1;
+    }
+
+    if (magic != DATA_MAGIC) {
+        return -1;
+    }
+    info->sessionId = getU32(&block[4]);
+    info->firstSample = getU32(&block[8]);
+    info->timestampMs = getU32(&block[12]);
+    info->count = getU16(&block[16]);
+    if (info->count > SAMPLES_PER_BLOCK
+        || crc16(&block[DATA_HEADER_SIZE], 3 * COLUMN_BYTES) != getU16(&block[18])) {
+        return -1;
+    }
+    if (xyz != nullptr) {
+        readColumns(block, 0, info->count, xyz);
+    }
+    return 2;
+}
+
+void readColumns(const uint8_t* block, int start, int count, int16_t* xyz) {
+    for (int axis = 0; axis < 3; axis++) {
+        const uint8_t* column = &block[DATA_HEADER_SIZE + axis * COLUMN_BYTES + 2 * start];
+        for (int i = 0; i < count; i++) {
+            xyz[3 * i + axis] = (int16_t)getU16(&column[2 * i]);
+        }
+    }
+}
+
+}  // namespace sessionfile
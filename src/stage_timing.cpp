@@ -0,0 +1,172 @@
+#include "stage_timing.h"
+#include <atomic>
+#include <cstring>
+
+namespace timing {
+
+// 序列号为奇数表示正在写入; 读取端在写入前后序列号一致时才采用副本
+struct StageCounter {
+    std::atomic<uint32_t> sequence;
+    uint32_t epoch;             // 与 resetEpoch 不同时统计已被清零
+    StageStats stats;
+};
+
+static StageCounter counters[NUM_STAGES];
+static std::atomic<uint32_t> resetEpoch(0);
+
+static const char* const STAGE_NAMES[NUM_STAGES] = {
+    "capture", "convert", "fft", "detect", "report", "publish"
+};
+
+static void clearStats(StageStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->minUs = UINT32_MAX;
+}
+
+static void putU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void putU32(uint8_t* out, uint32_t value) {
+    putU16(out, (uint16_t)(value & 0xFFFF));
+    putU16(out + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return getU16(in) | ((uint32_t)getU16(in + 2) << 16);
+}
+
+int bucketOf(uint32_t us) {
+    if (us < 8) {
+        return 0;
+    }
+    int bucket = (31 - __builtin_clz(us)) - 2;
+    return bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+uint32_t bucketLowerUs(int bucket) {
+    return bucket <= 0 ? 0 : (1UL << (bucket + 2));
+}
+
+void record(Stage stage, uint32_t us) {
+    StageCounter& counter = counters[stage];
+    uint32_t sequence = counter.sequence.load(std::memory_order_relaxed);
+    counter.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t epoch = resetEpoch.load(std::memory_order_relaxed);
+    StageStats& stats = counter.stats;
+    if (counter.epoch != epoch || stats.count == 0) {
+        clearStats(&stats);
+        counter.epoch = epoch;
+    }
+    stats.count++;
+    stats.totalUs += us;
+    if (us < stats.minUs) {
+        stats.minUs = us;
+    }
+    if (us > stats.maxUs) {
+        stats.maxUs = us;
+    }
+    stats.histogram[bucketOf(us)]++;
+
+    counter.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool getStats(Stage stage, StageStats* stats) {
+    const StageCounter& counter = counters[stage];
+    for (int attempt = 0; attempt < 4; attempt++) {
+        uint32_t before = counter.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        uint32_t epoch = counter.epoch;
+        *stats = counter.stats;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (counter.sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        if (epoch != resetEpoch.load(std::memory_order_relaxed) || stats->count == 0) {
+            clearStats(stats);
+            stats->minUs = 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+void reset() {
+    resetEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+const char* stageName(Stage stage) {
+    if ((int)stage < 0 || (int)stage >= NUM_STAGES) {
+        return "?";
+    }
+    return STAGE_NAMES[stage];
+}
+
+uint32_t meanUs(const StageStats& stats) {
+    if (stats.count == 0) {
+        return 0;
+    }
+    return (uint32_t)((stats.totalUs + stats.count / 2) / stats.count);
+}
+
+int encodeStats(uint8_t* out) {
+    out[0] = STATS_VERSION;
+    out[1] = NUM_STAGES;
+    out[2] = HISTOGRAM_BUCKETS;
+    out[3] = 0;
+
+    for (int s = 0; s < NUM_STAGES; s++) {
+        uint8_t* p = out + HEADER_SIZE + s * STAGE_RECORD_SIZE;
+        StageStats stats;
+        if (!getStats((Stage)s, &stats)) {
+            // 读取期间持续被写入: 本次报告为空，下次刷新时补上
+            clearStats(&stats);
+            stats.minUs = 0;
+        }
+        putU32(p, stats.count);
+        putU32(p + 4, stats.minUs);
+        putU32(p + 8, meanUs(stats));
+        putU32(p + 12, stats.maxUs);
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            uint32_t hits = stats.histogram[b];
+            putU16(p + 16 + 2 * b, (uint16_t)(hits > 0xFFFF ? 0xFFFF : hits));
+        }
+    }
+    return ENCODED_SIZE;
+}
+
+int decodeStats(const uint8_t* in, int len, StageStats* stats, int maxStages) {
+    if (len < HEADER_SIZE || in[0] != STATS_VERSION || in[2] != HISTOGRAM_BUCKETS) {
+        return -1;
+    }
+    int stages = in[1];
+    if (len < HEADER_SIZE + stages * STAGE_RECORD_SIZE) {
+        return -1;
+    }
+    if (stages > maxStages) {
+        stages = maxStages;
+    }
+
+    for (int s = 0; s < stages; s++) {
+        const uint8_t* p = in + HEADER_SIZE + s * STAGE_RECORD_SIZE;
+        stats[s].count = getU32(p);
+        stats[s].minUs = getU32(p + 4);
+        stats[s].totalUs = (uint64_t)getU32(p + 8) * stats[s].count;
+        stats[s].maxUs = getU32(p + 12);
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            stats[s].histogram[b] = getU16(p + 16 + 2 * b);
+        }
+    }
+    return stages;
+}
+
+}  // namespace timing
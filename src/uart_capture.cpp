@@ -0,0 +1,132 @@
+#include "uart_capture.h"
+
+namespace capture {
+
+using namespace sessionfile;
+
+int cobsEncode(const uint8_t* in, int len, uint8_t* out) {
+    int codePos = 0;        // 当前段的长度字节位置
+    int outPos = 1;
+    uint8_t code = 1;
+    for (int i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codePos] = code;
+            codePos = outPos++;
+            code = 1;
+            continue;
+        }
+        out[outPos++] = in[i];
+        code++;
+        if (code == 0xFF) {
+            // 满 254 个非零字节: 结束本段 (不隐含 0)
+            out[codePos] = code;
+            codePos = outPos++;
+            code = 1;
+        }
+    }
+    out[codePos] = code;
+    return outPos;
+}
+
+int cobsDecode(const uint8_t* in, int len, uint8_t* out) {
+    int outPos = 0;
+    int i = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) {
+            return -1;
+        }
+        for (int k = 1; k < code; k++) {
+            if (in[i] == 0) {
+                return -1;
+            }
+            out[outPos++] = in[i++];
+        }
+        // 段后隐含一个 0 (满 254 字节的段和最后一段除外)
+        if (code != 0xFF && i < len) {
+            out[outPos++] = 0;
+        }
+    }
+    return outPos;
+}
+
+int encodePacket(uint8_t type, const uint8_t* payload, int len, uint8_t* out) {
+    if (len < 0 || len > MAX_PAYLOAD) {
+        return -1;
+    }
+    uint8_t packet[MAX_PACKET_SIZE];
+    packet[0] = type;
+    for (int i = 0; i < len; i++) {
+        packet[1 + i] = payload[i];
+    }
+    putU16(&packet[1 + len], crc16(packet, 1 + len));
+    int encodedLength = cobsEncode(packet, len + 3, out);
+    out[encodedLength++] = 0;
+    return encodedLength;
+}
+
+int encodeSession(const SessionInfo& info, uint8_t* out) {
+    out[0] = LINK_VERSION;
+    out[1] = info.sensorId;
+    putU16(&out[2], info.odrHz);
+    putU16(&out[4], info.fullScaleG);
+    putU32(&out[6], info.sessionId);
+    putU32(&out[10], info.startSample);
+    putU32(&out[14], info.startMs);
+    putU32(&out[18], info.startEpoch);
+    return SESSION_PAYLOAD_SIZE;
+}
+
+bool decodeSession(const uint8_t* in, int len, SessionInfo* info) {
+    if (len < SESSION_PAYLOAD_SIZE || in[0] != LINK_VERSION) {
+        return false;
+    }
+    info->sensorId = in[1];
+    info->odrHz = getU16(&in[2]);
+    info->fullScaleG = getU16(&in[4]);
+    info->sessionId = getU32(&in[6]);
+    info->startSample = getU32(&in[10]);
+    info->startMs = getU32(&in[14]);
+    info->startEpoch = getU32(&in[18]);
+    return true;
+}
+
+PacketReceiver::PacketReceiver() {
+    length = 0;
+    packetLength = 0;
+    overflow = false;
+    packets = 0;
+    badPackets = 0;
+    packet[0] = 0;
+}
+
+bool PacketReceiver::feed(uint8_t byte) {
+    if (byte != 0) {
+        if (length < MAX_ENCODED_SIZE) {
+            encoded[length++] = byte;
+        } else {
+            overflow = true;
+        }
+        return false;
+    }
+
+    // 包结束
+    int received = length;
+    bool tooLong = overflow;
+    length = 0;
+    overflow = false;
+    if (received == 0) {
+        return false;       // 连续的 0x00 (发送端复位或线路空闲)
+    }
+    int decoded = tooLong ? -1 : cobsDecode(encoded, received, packet);
+    if (decoded < 3 || decoded > MAX_PACKET_SIZE
+        || crc16(packet, decoded - 2) != getU16(&packet[decoded - 2])) {
+        badPackets++;
+        return false;
+    }
+    packetLength = decoded;
+    packets++;
+    return true;
+}
+
+}  // namespace capture
@@ -0,0 +1,81 @@
+#include "work_stealing_pool.h"
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(int workers) : steals(0) {
+    if (workers < 1) {
+        workers = 1;
+    }
+    for (int i = 0; i < workers; i++) {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    tasksRun.assign(workers, 0);
+    nextQueue = 0;
+}
+
+void WorkStealingPool::submit(Task task) {
+    WorkerQueue& queue = *queues[nextQueue];
+    nextQueue = (nextQueue + 1) % (int)queues.size();
+
+    std::lock_guard<std::mutex> guard(queue.lock);
+    queue.tasks.push_back(std::move(task));
+}
+
+bool WorkStealingPool::popLocal(int worker, Task* task) {
+    WorkerQueue& queue = *queues[worker];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    *task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int worker, Task* task) {
+    // 从下一个线程开始依次尝试，避免所有空闲线程都去抢同一个队列
+    int count = (int)queues.size();
+    for (int i = 1; i < count; i++) {
+        WorkerQueue& victim = *queues[(worker + i) % count];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+        *task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        steals++;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int worker) {
+    // 运行期间不会新增任务，本地和所有其他队列都为空时即可退出
+    Task task;
+    while (popLocal(worker, &task) || steal(worker, &task)) {
+        task(worker);
+        tasksRun[worker]++;
+    }
+}
+
+void WorkStealingPool::run() {
+    std::vector<std::thread> threads;
+    for (int i = 1; i < (int)queues.size(); i++) {
+        threads.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+    }
+    workerLoop(0);
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+int WorkStealingPool::getWorkerCount() {
+    return (int)queues.size();
+}
+
+uint32_t WorkStealingPool::getSteals() {
+    return steals;
+}
+
+uint32_t WorkStealingPool::getTasksRun(int worker) {
+    return tasksRun[worker];
+}